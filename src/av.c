@@ -23,6 +23,7 @@ void av_frame_init(av_frame_t *frame, int width, int height, uint32_t *framebuff
 	*frame = (av_frame_t) {
 		.width = width,
 		.height = height,
+		.format = AV_FRAME_RGB32,
 		.framebuffer = framebuffer,
 		.pixel_stride = pstride,
 		.line_stride = lstride,
@@ -297,7 +298,16 @@ void av_crop_frame(av_frame_t *frame, int x, int y, int width, int height)
 	if(x + width > frame->width) width = frame->width - x;
 	if(y + height > frame->height) height = frame->height - y;
 	
-	frame->framebuffer += y * frame->line_stride + x * frame->pixel_stride;
+	if(frame->format == AV_FRAME_YUV)
+	{
+		frame->plane_x += x;
+		frame->plane_y += y;
+	}
+	else
+	{
+		frame->framebuffer += y * frame->line_stride + x * frame->pixel_stride;
+	}
+	
 	frame->width = width;
 	frame->height = height;
 }
@@ -28,17 +28,42 @@
 #define AV_OUT_OF_MEMORY -2
 #define AV_EOF           -3
 
+/* Frame pixel formats */
+#define AV_FRAME_RGB32 0 /* 32-bit RGBx, in framebuffer */
+#define AV_FRAME_YUV   1 /* Planar 8-bit YUV, in planes */
+
+/* YUV colour matrices */
+#define AV_MATRIX_BT601  0
+#define AV_MATRIX_BT709  1
+#define AV_MATRIX_BT2020 2
+
 typedef struct {
 	
 	/* Dimensions */
 	int width;
 	int height;
 	
+	/* Pixel format */
+	int format;
+	
 	/* 32-bit RGBx framebuffer */
 	uint32_t *framebuffer;
 	int pixel_stride;
 	int line_stride;
 	
+	/* Planar YUV. The chroma planes are subsampled by
+	 * 1 << chroma_shift_x and 1 << chroma_shift_y. The
+	 * top left pixel of the frame is at plane_x, plane_y,
+	 * so that cropping keeps the chroma siting intact */
+	uint8_t *planes[3];
+	int plane_stride[3];
+	int chroma_shift_x;
+	int chroma_shift_y;
+	int plane_x;
+	int plane_y;
+	int colour_matrix;
+	int full_range;
+	
 	/* The pixel aspect ratio */
 	r64_t pixel_aspect_ratio;
 	
@@ -100,6 +125,17 @@ typedef struct {
 	r64_t max_display_aspect_ratio;
 	av_frame_t default_frame;
 	
+	/* Set when the renderer accepts AV_FRAME_YUV frames. Sources
+	 * may still return RGB32 frames when this is set */
+	int allow_yuv;
+	
+	/* Number of video frames a source may queue ahead
+	 * of the renderer, 0 for the source's default */
+	int video_buffers;
+	
+	/* Print buffer statistics when the source is closed */
+	int stats;
+	
 	/* Video state */
 	unsigned int frames;
 	
@@ -129,6 +165,8 @@ extern void av_set_display_aspect_ratio(av_frame_t *frame, r64_t display_aspect_
 
 extern r64_t av_calculate_frame_size(av_t *s, r64_t resolution, r64_t pixel_aspect_ratio);
 
+/* Flip and rotate only apply to RGB32 frames. YUV frames are
+ * not allowed when the frame orientation needs changing */
 extern void av_hflip_frame(av_frame_t *frame);
 extern void av_vflip_frame(av_frame_t *frame);
 extern void av_rotate_frame(av_frame_t *frame, int a);
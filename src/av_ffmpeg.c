@@ -26,7 +26,9 @@
  *                   the decoded video frames.
  * 
  * Video scaler    - Rescales decoded video frames to the correct
- *                   size and format required by hacktv.
+ *                   size and format required by hacktv. Where
+ *                   swscale supports it the frame is split into
+ *                   horizontal slices, scaled by a pool of threads.
  * 
  * Audio thread    - Reads from the audio packet queue and produces
  *                   the decoded.
@@ -50,6 +52,7 @@
 #include <libavutil/opt.h>
 #include <libavutil/time.h>
 #include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
 #include <libavfilter/avfilter.h>
 #include <libavfilter/buffersink.h>
 #include <libavfilter/buffersrc.h>
@@ -60,30 +63,36 @@
 #include <conio.h>
 #endif
 
-/* Maximum length of the packet queue */
-/* Taken from ffplay.c */
+/* Maximum length of the packet queues */
+/* Size taken from ffplay.c */
 #define MAX_QUEUE_SIZE (15 * 1024 * 1024)
+#define MAX_QUEUE_SECONDS 10
+#define MAX_QUEUE_PACKETS 4096 /* Must be a power of 2 */
 #define AVSEEK_FWD 60
 #define AVSEEK_RWD -60
 #define AVSEEK_SEEKING 1
 
-typedef struct __packet_queue_item_t {
+typedef struct {
 	
-	AVPacket pkt;
-	struct __packet_queue_item_t *next;
+	/* Ring of packets, written only by the input thread
+	 * and read only by the stream's decoder thread */
+	AVPacket *pkts;
+	unsigned int head;	/* Next slot to write */
+	unsigned int tail;	/* Next slot to read */
 	
-} _packet_queue_item_t;
-
-typedef struct {
+	size_t size;		/* Number of bytes used */
+	int64_t duration;	/* Length of the queued packets */
+	int64_t max_duration;	/* Limit in stream time base units, 0 for none */
 	
-	int length;	/* Number of packets */
-	int size;       /* Number of bytes used */
 	int eof;        /* End of stream / file flag */
 	int abort;      /* Abort flag */
+	int hungry;     /* Empty while the input waits on another queue */
 	
-	/* Pointers to the first and last packets in the queue */
-	_packet_queue_item_t *first;
-	_packet_queue_item_t *last;
+	/* Only used by a thread that needs to wait */
+	unsigned int seq;
+	int waiters;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
 	
 } _packet_queue_t;
 
@@ -102,6 +111,38 @@ typedef struct {
 	
 } _frame_dbuffer_t;
 
+/* Default number of frames queued for the renderer */
+#define VIDEO_RING_FRAMES 8
+
+typedef struct {
+	
+	/* Frame slots and the output frame number each is due */
+	AVFrame **frame;
+	int64_t *pts;
+	int size;
+	
+	int head;	/* Next slot to write */
+	int tail;	/* Next slot to read */
+	int count;	/* Number of frames waiting to be read */
+	int current;	/* Slot held by the renderer */
+	
+	int eof;	/* End of stream flag */
+	int abort;	/* Abort flag */
+	
+	/* Occupancy counters */
+	unsigned int frames;
+	unsigned int repeats;
+	unsigned int drops;
+	unsigned int waits;
+	int min_fill;
+	int max_fill;
+	
+	/* Thread locking and signaling */
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	
+} _frame_ring_t;
+
 typedef struct {
 	
 	/* Seek stuff */
@@ -129,7 +170,16 @@ typedef struct {
 	
 	/* Video scaling */
 	struct SwsContext *sws_ctx;
-	_frame_dbuffer_t out_video_buffer;
+	int sws_src_width;
+	int sws_src_height;
+	int sws_src_format;
+	int sws_dst_width;
+	int sws_dst_height;
+	int sws_dst_format;
+	_frame_ring_t out_video_ring;
+	int64_t video_next_pts;
+	int64_t video_pts;
+	int yuv;
 	
 	/* Audio decoder */
 	AVRational audio_time_base;
@@ -158,11 +208,9 @@ typedef struct {
 	pthread_t audio_decode_thread;
 	pthread_t audio_scaler_thread;
 	volatile int thread_abort;
-	int input_stall;
 	
-	/* Thread locking and signaling for input queues */
-	pthread_mutex_t mutex;
-	pthread_cond_t cond;
+	/* The queue the input thread is waiting on, or NULL */
+	_packet_queue_t *input_stall;
 	
 	/* Video filter buffers */
 	AVFilterContext *vbuffersink_ctx;
@@ -176,6 +224,10 @@ typedef struct {
 	/* Callbacks */
 	vid_config_t *vid_conf;
 	tt_t *vid_tt;
+	
+	/* Private copy of the video settings. Sources are opened
+	 * while another is playing, so vid->conf is left alone */
+	vid_config_t conf;
 
 	/* Subtitles */
 	av_subs_t *av_sub;
@@ -216,158 +268,214 @@ void _audio_offset(uint8_t const **dst, uint8_t const * const *src, int offset,
 	}
 }
 
-static int _packet_queue_init(av_ffmpeg_t *s, _packet_queue_t *q)
+static int _packet_queue_init(av_ffmpeg_t *s, _packet_queue_t *q, AVStream *stream)
 {
-	q->length = 0;
+	q->pkts = calloc(MAX_QUEUE_PACKETS, sizeof(AVPacket));
+	if(q->pkts == NULL)
+	{
+		return(-1);
+	}
+	
+	q->head = 0;
+	q->tail = 0;
 	q->size = 0;
+	q->duration = 0;
+	q->max_duration = 0;
 	q->eof = 0;
 	q->abort = 0;
+	q->hungry = 0;
+	q->seq = 0;
+	q->waiters = 0;
+	
+	if(stream != NULL)
+	{
+		q->max_duration = av_rescale_q(MAX_QUEUE_SECONDS, (AVRational) { 1, 1 }, stream->time_base);
+	}
+	
+	pthread_mutex_init(&q->mutex, NULL);
+	pthread_cond_init(&q->cond, NULL);
 	
 	return(0);
 }
 
-static int _packet_queue_flush(av_ffmpeg_t *s, _packet_queue_t *q)
+static void _packet_queue_wake(_packet_queue_t *q)
 {
-	_packet_queue_item_t *p;
-	
-	pthread_mutex_lock(&s->mutex);
+	/* Every change of state moves the sequence number on */
+	__atomic_add_fetch(&q->seq, 1, __ATOMIC_SEQ_CST);
 	
-	while(q->length--)
+	if(__atomic_load_n(&q->waiters, __ATOMIC_SEQ_CST) > 0)
 	{
-		/* Pop the first item off the list */
-		p = q->first;
-		q->first = p->next;
-		
-		av_packet_unref(&p->pkt);
-		free(p);
+		pthread_mutex_lock(&q->mutex);
+		pthread_cond_broadcast(&q->cond);
+		pthread_mutex_unlock(&q->mutex);
 	}
+}
+
+static void _packet_queue_sleep(_packet_queue_t *q, unsigned int seq)
+{
+	/* Wait for the state to change from when seq was read */
+	pthread_mutex_lock(&q->mutex);
+	__atomic_add_fetch(&q->waiters, 1, __ATOMIC_SEQ_CST);
 	
-	pthread_cond_signal(&s->cond);
-	pthread_mutex_unlock(&s->mutex);
+	while(__atomic_load_n(&q->seq, __ATOMIC_SEQ_CST) == seq)
+	{
+		pthread_cond_wait(&q->cond, &q->mutex);
+	}
 	
-	return(0);
+	__atomic_sub_fetch(&q->waiters, 1, __ATOMIC_SEQ_CST);
+	pthread_mutex_unlock(&q->mutex);
 }
 
 static void _packet_queue_free(av_ffmpeg_t *s, _packet_queue_t *q)
 {
-	_packet_queue_flush(s, q);
+	if(q->pkts == NULL) return;
+	
+	/* Release any packets still in the queue */
+	for(; q->tail != q->head; q->tail++)
+	{
+		av_packet_unref(&q->pkts[q->tail & (MAX_QUEUE_PACKETS - 1)]);
+	}
+	
+	free(q->pkts);
+	q->pkts = NULL;
+	
+	pthread_cond_destroy(&q->cond);
+	pthread_mutex_destroy(&q->mutex);
 }
 
 static void _packet_queue_abort(av_ffmpeg_t *s, _packet_queue_t *q)
 {
-	pthread_mutex_lock(&s->mutex);
+	__atomic_store_n(&q->abort, 1, __ATOMIC_SEQ_CST);
+	_packet_queue_wake(q);
+}
+
+static int _packet_queue_full(_packet_queue_t *q, AVPacket *pkt)
+{
+	unsigned int length = q->head - __atomic_load_n(&q->tail, __ATOMIC_SEQ_CST);
+	
+	/* No free slots, this limit is never exceeded */
+	if(length == MAX_QUEUE_PACKETS) return(2);
+	
+	/* Always accept a packet into an empty queue */
+	if(length == 0) return(0);
+	
+	if(__atomic_load_n(&q->size, __ATOMIC_SEQ_CST) + pkt->size > MAX_QUEUE_SIZE) return(1);
 	
-	q->abort = 1;
+	if(q->max_duration > 0 &&
+	   __atomic_load_n(&q->duration, __ATOMIC_SEQ_CST) >= q->max_duration) return(1);
 	
-	pthread_cond_signal(&s->cond);
-	pthread_mutex_unlock(&s->mutex);
+	return(0);
 }
 
-static int _packet_queue_write(av_ffmpeg_t *s, _packet_queue_t *q, AVPacket *pkt)
+static int _packet_queue_hungry(av_ffmpeg_t *s, _packet_queue_t *q)
 {
-	_packet_queue_item_t *p;
+	/* Test if the decoder of another stream has run out of packets */
+	if(q != &s->video_queue && __atomic_load_n(&s->video_queue.hungry, __ATOMIC_SEQ_CST)) return(1);
+	if(q != &s->audio_queue && __atomic_load_n(&s->audio_queue.hungry, __ATOMIC_SEQ_CST)) return(1);
 	
-	pthread_mutex_lock(&s->mutex);
+	return(0);
+}
+
+static int _packet_queue_write(av_ffmpeg_t *s, _packet_queue_t *q, AVPacket *pkt)
+{
+	unsigned int seq;
+	int r;
 	
 	/* A NULL packet signals the end of the stream / file */
 	if(pkt == NULL)
 	{
-		q->eof = 1;
+		__atomic_store_n(&q->eof, 1, __ATOMIC_SEQ_CST);
+		_packet_queue_wake(q);
+		
+		return(0);
 	}
-	else
+	
+	/* Limit the size of the queue. The limit can be exceeded if
+	 * the decoder of another stream has run out of packets, as
+	 * the input thread can't reach them until this one is queued */
+	while(1)
 	{
-		/* Limit the size of the queue */
-		while(q->abort == 0 && q->size + pkt->size + sizeof(_packet_queue_item_t) > MAX_QUEUE_SIZE)
-		{
-			s->input_stall = 1;
-			pthread_cond_signal(&s->cond);
-			pthread_cond_wait(&s->cond, &s->mutex);
-		}
+		seq = __atomic_load_n(&q->seq, __ATOMIC_SEQ_CST);
 		
-		s->input_stall = 0;
-		
-		if(q->abort == 1)
+		if(__atomic_load_n(&q->abort, __ATOMIC_SEQ_CST))
 		{
 			/* Abort was called while waiting for the queue size to drop */
+			__atomic_store_n(&s->input_stall, NULL, __ATOMIC_SEQ_CST);
 			av_packet_unref(pkt);
 			
-			pthread_cond_signal(&s->cond);
-			pthread_mutex_unlock(&s->mutex);
-			
 			return(-2);
 		}
 		
-		/* Allocate memory for queue item and copy packet */
-		p = malloc(sizeof(_packet_queue_item_t));
-		if(p == NULL)
-		{
-			/* Out of memory */
-			av_packet_unref(pkt);
-			
-			pthread_cond_signal(&s->cond);
-			pthread_mutex_unlock(&s->mutex);
-			
-			return(-1);
-		}
+		r = _packet_queue_full(q, pkt);
+		if(r == 0 || (r == 1 && _packet_queue_hungry(s, q))) break;
 		
-		p->pkt = *pkt;
-		p->next = NULL;
-		
-		/* Add the item to the end of the queue */
-		if(q->length == 0)
+		if(__atomic_exchange_n(&s->input_stall, q, __ATOMIC_SEQ_CST) != q)
 		{
-			q->first = p;
-		}
-		else
-		{
-			q->last->next = p;
+			/* Let the other decoders know the input has stalled */
+			if(q != &s->video_queue) _packet_queue_wake(&s->video_queue);
+			if(q != &s->audio_queue) _packet_queue_wake(&s->audio_queue);
 		}
 		
-		q->last = p;
-		q->length++;
-		q->size += pkt->size + sizeof(_packet_queue_item_t);
+		_packet_queue_sleep(q, seq);
 	}
 	
-	pthread_cond_signal(&s->cond);
-	pthread_mutex_unlock(&s->mutex);
+	__atomic_store_n(&s->input_stall, NULL, __ATOMIC_SEQ_CST);
+	
+	/* Copy the packet into the ring and publish it */
+	q->pkts[q->head & (MAX_QUEUE_PACKETS - 1)] = *pkt;
+	
+	__atomic_add_fetch(&q->size, pkt->size, __ATOMIC_SEQ_CST);
+	__atomic_add_fetch(&q->duration, pkt->duration, __ATOMIC_SEQ_CST);
+	__atomic_store_n(&q->head, q->head + 1, __ATOMIC_SEQ_CST);
+	
+	_packet_queue_wake(q);
 	
 	return(0);
 }
 
 static int _packet_queue_read(av_ffmpeg_t *s, _packet_queue_t *q, AVPacket *pkt)
 {
-	_packet_queue_item_t *p;
-	
-	pthread_mutex_lock(&s->mutex);
+	_packet_queue_t *stall;
+	unsigned int seq;
 	
-	while(q->length == 0)
+	while(1)
 	{
-		if(s->input_stall)
+		seq = __atomic_load_n(&q->seq, __ATOMIC_SEQ_CST);
+		
+		if(__atomic_load_n(&q->head, __ATOMIC_SEQ_CST) != q->tail) break;
+		
+		if(__atomic_load_n(&q->abort, __ATOMIC_SEQ_CST))
 		{
-			pthread_mutex_unlock(&s->mutex);
-			return(0);
+			return(-2);
+		}
+		
+		if(__atomic_load_n(&q->eof, __ATOMIC_SEQ_CST))
+		{
+			return(-1);
 		}
 		
-		if(q->abort == 1 || q->eof == 1)
+		stall = __atomic_load_n(&s->input_stall, __ATOMIC_SEQ_CST);
+		if(stall != NULL && stall != q && !q->hungry)
 		{
-			pthread_mutex_unlock(&s->mutex);
-			return(q->abort == 1 ? -2 : -1);
+			/* The input thread is waiting for space in another
+			 * queue, and can't reach this stream's packets */
+			__atomic_store_n(&q->hungry, 1, __ATOMIC_SEQ_CST);
+			_packet_queue_wake(stall);
 		}
 		
-		pthread_cond_wait(&s->cond, &s->mutex);
+		_packet_queue_sleep(q, seq);
 	}
 	
-	p = q->first;
+	__atomic_store_n(&q->hungry, 0, __ATOMIC_SEQ_CST);
 	
-	*pkt = p->pkt;
-	q->first = p->next;
-	q->length--;
-	q->size -= pkt->size + sizeof(_packet_queue_item_t);
+	*pkt = q->pkts[q->tail & (MAX_QUEUE_PACKETS - 1)];
 	
-	free(p);
+	__atomic_sub_fetch(&q->size, pkt->size, __ATOMIC_SEQ_CST);
+	__atomic_sub_fetch(&q->duration, pkt->duration, __ATOMIC_SEQ_CST);
+	__atomic_store_n(&q->tail, q->tail + 1, __ATOMIC_SEQ_CST);
 	
-	pthread_cond_signal(&s->cond);
-	pthread_mutex_unlock(&s->mutex);
+	/* Wake the input thread if it's waiting for space */
+	_packet_queue_wake(q);
 	
 	return(0);
 }
@@ -485,6 +593,216 @@ static AVFrame *_frame_dbuffer_flip(_frame_dbuffer_t *d)
 	return(frame);
 }
 
+static int _frame_ring_init(_frame_ring_t *r, int frames)
+{
+	int i;
+	
+	/* One extra slot holds the frame being shown */
+	r->size = frames + 1;
+	r->head = 0;
+	r->tail = 0;
+	r->count = 0;
+	r->current = r->size - 1;
+	r->eof = 0;
+	r->abort = 0;
+	
+	r->frames = 0;
+	r->repeats = 0;
+	r->drops = 0;
+	r->waits = 0;
+	r->min_fill = frames;
+	r->max_fill = 0;
+	
+	r->frame = calloc(r->size, sizeof(AVFrame *));
+	r->pts = calloc(r->size, sizeof(int64_t));
+	
+	if(r->frame == NULL || r->pts == NULL)
+	{
+		free(r->frame);
+		free(r->pts);
+		return(-1);
+	}
+	
+	for(i = 0; i < r->size; i++)
+	{
+		r->frame[i] = av_frame_alloc();
+		if(r->frame[i] == NULL) break;
+	}
+	
+	if(i < r->size)
+	{
+		while(i--) av_frame_free(&r->frame[i]);
+		free(r->frame);
+		free(r->pts);
+		return(-1);
+	}
+	
+	/* Anything shown before the first frame is due is blank */
+	r->pts[r->current] = -1;
+	
+	pthread_mutex_init(&r->mutex, NULL);
+	pthread_cond_init(&r->cond, NULL);
+	
+	return(0);
+}
+
+static void _frame_ring_free(_frame_ring_t *r)
+{
+	int i;
+	
+	pthread_cond_destroy(&r->cond);
+	pthread_mutex_destroy(&r->mutex);
+	
+	for(i = 0; i < r->size; i++)
+	{
+		av_frame_free(&r->frame[i]);
+	}
+	
+	free(r->frame);
+	free(r->pts);
+	
+	r->frame = NULL;
+	r->pts = NULL;
+	r->size = 0;
+}
+
+static void _frame_ring_abort(_frame_ring_t *r)
+{
+	pthread_mutex_lock(&r->mutex);
+	
+	r->abort = 1;
+	
+	pthread_cond_broadcast(&r->cond);
+	pthread_mutex_unlock(&r->mutex);
+}
+
+static void _frame_ring_eof(_frame_ring_t *r)
+{
+	pthread_mutex_lock(&r->mutex);
+	
+	r->eof = 1;
+	
+	pthread_cond_broadcast(&r->cond);
+	pthread_mutex_unlock(&r->mutex);
+}
+
+static AVFrame *_frame_ring_back_buffer(_frame_ring_t *r)
+{
+	AVFrame *frame = NULL;
+	
+	pthread_mutex_lock(&r->mutex);
+	
+	/* Wait for a free slot. The renderer's slot is never free */
+	while(r->count == r->size - 1 && r->abort == 0)
+	{
+		pthread_cond_wait(&r->cond, &r->mutex);
+	}
+	
+	if(r->abort == 0)
+	{
+		frame = r->frame[r->head];
+	}
+	
+	pthread_mutex_unlock(&r->mutex);
+	
+	return(frame);
+}
+
+static void _frame_ring_ready(_frame_ring_t *r, int64_t pts)
+{
+	pthread_mutex_lock(&r->mutex);
+	
+	r->pts[r->head] = pts;
+	r->head = (r->head + 1) % r->size;
+	r->count++;
+	
+	pthread_cond_broadcast(&r->cond);
+	pthread_mutex_unlock(&r->mutex);
+}
+
+static AVFrame *_frame_ring_read(_frame_ring_t *r, int64_t pts)
+{
+	AVFrame *frame;
+	int next;
+	
+	pthread_mutex_lock(&r->mutex);
+	
+	if(r->count == 0 && r->eof == 0 && r->abort == 0)
+	{
+		/* The scaler has fallen behind */
+		r->waits++;
+		
+		while(r->count == 0 && r->eof == 0 && r->abort == 0)
+		{
+			pthread_cond_wait(&r->cond, &r->mutex);
+		}
+	}
+	
+	/* Die if it was the abort flag, or the end of the stream */
+	if(r->abort != 0 || r->count == 0)
+	{
+		pthread_mutex_unlock(&r->mutex);
+		return(NULL);
+	}
+	
+	if(r->count < r->min_fill) r->min_fill = r->count;
+	if(r->count > r->max_fill) r->max_fill = r->count;
+	
+	/* Skip frames that are late, if the one after is also due */
+	while(r->count > 1)
+	{
+		next = (r->tail + 1) % r->size;
+		if(r->pts[next] > pts) break;
+		
+		r->tail = next;
+		r->count--;
+		r->drops++;
+	}
+	
+	if(r->pts[r->tail] > pts)
+	{
+		/* The next frame isn't due yet. Repeat the current one */
+		r->repeats++;
+	}
+	else
+	{
+		/* Release the current frame and take the next */
+		r->current = r->tail;
+		r->tail = (r->tail + 1) % r->size;
+		r->count--;
+		r->frames++;
+		
+		pthread_cond_broadcast(&r->cond);
+	}
+	
+	frame = r->frame[r->current];
+	
+	pthread_mutex_unlock(&r->mutex);
+	
+	return(frame);
+}
+
+static AVFrame *_frame_ring_current(_frame_ring_t *r)
+{
+	return(r->frame[r->current]);
+}
+
+static void _frame_ring_print_stats(const char *name, _frame_ring_t *r)
+{
+	fprintf(stderr, "  %-14s ring: %d frames, %u shown, %u repeated, %u dropped, waited %u times\n",
+		name,
+		r->size - 1,
+		r->frames,
+		r->repeats,
+		r->drops,
+		r->waits
+	);
+	
+	if(r->frames == 0) return;
+	
+	fprintf(stderr, "  %-14s   fill: lowest %d, highest %d\n", "", r->min_fill, r->max_fill);
+}
+
 static void *_input_thread(void *arg)
 {
 	av_ffmpeg_t *s = (av_ffmpeg_t *) arg;
@@ -663,10 +981,180 @@ static void *_video_decode_thread(void *arg)
 	return(NULL);
 }
 
+static enum AVPixelFormat _output_format(av_ffmpeg_t *s, enum AVPixelFormat format)
+{
+	if(s->yuv)
+	{
+		/* Planar 8-bit YUV formats are passed through as they are */
+		switch(format)
+		{
+		case AV_PIX_FMT_YUV420P:
+		case AV_PIX_FMT_YUVJ420P:
+		case AV_PIX_FMT_YUV422P:
+		case AV_PIX_FMT_YUVJ422P:
+		case AV_PIX_FMT_YUV444P:
+		case AV_PIX_FMT_YUVJ444P:
+			return(format);
+		default:
+			break;
+		}
+	}
+	
+	return(AV_PIX_FMT_RGB32);
+}
+
+static int _alloc_video_frame(AVFrame *frame, int format, int width, int height)
+{
+	int i, r;
+	
+	/* Output frames are reference counted, as swscale requires */
+	av_frame_unref(frame);
+	
+	frame->format = format;
+	frame->width = width;
+	frame->height = height;
+	
+	r = av_frame_get_buffer(frame, 0);
+	if(r < 0)
+	{
+		return(r);
+	}
+	
+	if(format == AV_PIX_FMT_RGB32)
+	{
+		memset(frame->data[0], 0, frame->linesize[0] * frame->height);
+	}
+	else
+	{
+		ptrdiff_t linesize[4];
+		int full_range;
+		
+		/* Black in YUV is not all zeros, fill each plane */
+		for(i = 0; i < 4; i++)
+		{
+			linesize[i] = frame->linesize[i];
+		}
+		
+		full_range = format == AV_PIX_FMT_YUVJ420P ||
+		             format == AV_PIX_FMT_YUVJ422P ||
+		             format == AV_PIX_FMT_YUVJ444P;
+		
+		r = av_image_fill_black(
+			frame->data, linesize, format,
+			full_range ? AVCOL_RANGE_JPEG : AVCOL_RANGE_MPEG,
+			width, height
+		);
+		if(r < 0)
+		{
+			return(r);
+		}
+	}
+	
+	return(0);
+}
+
+static int _scaler_context(av_ffmpeg_t *s, AVFrame *src, AVFrame *dst)
+{
+	if(s->sws_ctx != NULL &&
+	   s->sws_src_width == src->width &&
+	   s->sws_src_height == src->height &&
+	   s->sws_src_format == src->format &&
+	   s->sws_dst_width == dst->width &&
+	   s->sws_dst_height == dst->height &&
+	   s->sws_dst_format == dst->format)
+	{
+		/* The current context is still valid */
+		return(0);
+	}
+	
+	sws_freeContext(s->sws_ctx);
+	
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+	/* Scale in slices across several threads */
+	s->sws_ctx = sws_alloc_context();
+	if(!s->sws_ctx)
+	{
+		return(-1);
+	}
+	
+	av_opt_set_int(s->sws_ctx, "srcw", src->width, 0);
+	av_opt_set_int(s->sws_ctx, "srch", src->height, 0);
+	av_opt_set_int(s->sws_ctx, "src_format", src->format, 0);
+	av_opt_set_int(s->sws_ctx, "dstw", dst->width, 0);
+	av_opt_set_int(s->sws_ctx, "dsth", dst->height, 0);
+	av_opt_set_int(s->sws_ctx, "dst_format", dst->format, 0);
+	av_opt_set_int(s->sws_ctx, "sws_flags", SWS_BICUBIC, 0);
+	av_opt_set_int(s->sws_ctx, "threads", 0, 0); /* Let ffmpeg decide number of threads */
+	
+	if(sws_init_context(s->sws_ctx, NULL, NULL) < 0)
+	{
+		sws_freeContext(s->sws_ctx);
+		s->sws_ctx = NULL;
+		return(-1);
+	}
+#else
+	s->sws_ctx = sws_getContext(
+		src->width,
+		src->height,
+		src->format,
+		dst->width,
+		dst->height,
+		dst->format,
+		SWS_BICUBIC,
+		NULL,
+		NULL,
+		NULL
+	);
+	
+	if(!s->sws_ctx)
+	{
+		return(-1);
+	}
+#endif
+	
+	s->sws_src_width = src->width;
+	s->sws_src_height = src->height;
+	s->sws_src_format = src->format;
+	s->sws_dst_width = dst->width;
+	s->sws_dst_height = dst->height;
+	s->sws_dst_format = dst->format;
+	
+	return(0);
+}
+
+static AVRational _sample_aspect_ratio(av_ffmpeg_t *s, AVFrame *frame)
+{
+	AVRational ratio;
+	
+	ratio = av_guess_sample_aspect_ratio(s->format_ctx, s->video_stream, frame);
+	
+	if(ratio.num == 0 || ratio.den == 0)
+	{
+		/* Default to square pixels if the ratio looks odd */
+		ratio = (AVRational) { 1, 1 };
+	}
+	
+	return(ratio);
+}
+
+static r64_t _output_frame_size(av_ffmpeg_t *s, int width, int height, AVRational ratio)
+{
+	/* Size of the frame after scaling */
+	return(av_calculate_frame_size(
+		s->av,
+		(r64_t) { width, height },
+		r64_mul(
+			(r64_t) { ratio.num, ratio.den },
+			(r64_t) { width, height }
+		)
+	));
+}
+
 static void *_video_scaler_thread(void *arg)
 {
 	av_ffmpeg_t *s = (av_ffmpeg_t *) arg;
 	AVFrame *frame, *oframe;
+	enum AVPixelFormat format;
 	AVRational ratio;
 	r64_t r;
 	int64_t pts;
@@ -696,88 +1184,65 @@ static void *_video_scaler_thread(void *arg)
 		
 		if(pts != AV_NOPTS_VALUE)
 		{
+			/* Convert to an output frame number */
 			pts  = av_rescale_q(pts, s->video_stream->time_base, s->video_time_base);
 			pts -= s->video_start_time;
 			
-			if(pts < 0)
+			if(pts < s->video_next_pts)
 			{
 				/* This frame is in the past. Skip it */
 				av_frame_unref(frame);
 				continue;
 			}
 			
-			while(pts > 0)
-			{
-				/* This frame is in the future. Repeat the previous one */
-				_frame_dbuffer_ready(&s->out_video_buffer, 1);
-				s->video_start_time++;
-				pts--;
-			}
+			/* Frames in the future are held in the ring
+			 * and the renderer repeats the previous one */
+		}
+		else
+		{
+			pts = s->video_next_pts;
 		}
 		
-		oframe = _frame_dbuffer_back_buffer(&s->out_video_buffer);
-		
-		ratio = av_guess_sample_aspect_ratio(s->format_ctx, s->video_stream, frame);
-		
-		if(ratio.num == 0 || ratio.den == 0)
+		oframe = _frame_ring_back_buffer(&s->out_video_ring);
+		if(oframe == NULL)
 		{
-			/* Default to square pixels if the ratio looks odd */
-			ratio = (AVRational) { 1, 1 };
+			av_frame_unref(frame);
+			break;
 		}
 		
-		r = av_calculate_frame_size(
-			s->av,
-			(r64_t) { frame->width, frame->height },
-			r64_mul(
-				(r64_t) { ratio.num, ratio.den },
-				(r64_t) { frame->width, frame->height }
-			)
-		);
+		ratio = _sample_aspect_ratio(s, frame);
+		r = _output_frame_size(s, frame->width, frame->height, ratio);
+		
+		/* YUV sources skip the conversion to RGB */
+		format = _output_format(s, frame->format);
 		
 		if(r.num != oframe->width ||
-		   r.den != oframe->height)
+		   r.den != oframe->height ||
+		   format != oframe->format)
 		{
-			av_freep(&oframe->data[0]);
-			
-			oframe->format = AV_PIX_FMT_RGB32;
-			oframe->width = r.num;
-			oframe->height = r.den;
-			
-			int i = av_image_alloc(
-				oframe->data,
-				oframe->linesize,
-				oframe->width, oframe->height,
-				AV_PIX_FMT_RGB32, av_cpu_max_align()
-			);
-			memset(oframe->data[0], 0, i);
+			if(_alloc_video_frame(oframe, format, r.num, r.den) != 0) break;
 		}
 		
-		/* Initialise / re-initialise software scaler */
-		s->sws_ctx = sws_getCachedContext(
-			s->sws_ctx,
-			frame->width,
-			frame->height,
-			frame->format,
-			oframe->width,
-			oframe->height,
-			AV_PIX_FMT_RGB32,
-			SWS_BICUBIC,
-			NULL,
-			NULL,
-			NULL
-		);
+		/* The scaler doesn't change the colour matrix or range */
+		oframe->colorspace = frame->colorspace;
+		oframe->color_range = frame->color_range;
 		
-		if(!s->sws_ctx) break;
+		/* Initialise / re-initialise software scaler */
+		if(_scaler_context(s, frame, oframe) != 0) break;
 		
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+		sws_scale_frame(s->sws_ctx, oframe, frame);
+#else
 		sws_scale(
 			s->sws_ctx,
 			(uint8_t const * const *) frame->data,
 			frame->linesize,
 			0,
-			s->video_codec_ctx->height,
+			frame->height,
 			oframe->data,
 			oframe->linesize
 		);
+#endif
 		
 		/* Adjust the pixel ratio for the scaled image */
 		av_reduce(
@@ -839,9 +1304,10 @@ static void *_video_scaler_thread(void *arg)
 			}
 			else
 			{
-				int w, h, sindex;
-				sindex = get_bitmap_subtitle(s->av_sub, frame->best_effort_timestamp, &w, &h);				
-				if(w > 0) display_bitmap_subtitle(s->font[TEXT_SUBTITLE], (uint32_t *) oframe->data[0], oframe->linesize[0] / sizeof(uint32_t), w, h, s->av_sub[sindex].bitmap);
+				uint32_t *bitmap;
+				int w, h;
+				bitmap = get_bitmap_subtitle(s->av_sub, frame->best_effort_timestamp, &w, &h);
+				if(bitmap) display_bitmap_subtitle(s->font[TEXT_SUBTITLE], (uint32_t *) oframe->data[0], oframe->linesize[0] / sizeof(uint32_t), w, h, bitmap);
 			}
 		}
 
@@ -856,11 +1322,11 @@ static void *_video_scaler_thread(void *arg)
 		/* Done with the frame */
 		av_frame_unref(frame);
 		
-		_frame_dbuffer_ready(&s->out_video_buffer, 0);
-		s->video_start_time++;
+		_frame_ring_ready(&s->out_video_ring, pts);
+		s->video_next_pts = pts + 1;
 	}
 	
-	_frame_dbuffer_abort(&s->out_video_buffer);
+	_frame_ring_eof(&s->out_video_ring);
 	
 	// fprintf(stderr, "_video_scaler_thread(): Ending\n");
 	
@@ -871,6 +1337,7 @@ static int _ffmpeg_read_video(void *ctx, av_frame_t *frame)
 {
 	av_ffmpeg_t *s = ctx;
 	AVFrame *avframe;
+	int i;
 		
 	// int nav;
 	// nav = 0;
@@ -934,16 +1401,21 @@ static int _ffmpeg_read_video(void *ctx, av_frame_t *frame)
 */	
 	if(s->paused) 
 	{
-		avframe = s->out_video_buffer.frame[0];
+		avframe = _frame_ring_current(&s->out_video_ring);
+		
+		/* The media icons are only drawn on RGB frames */
+		if(avframe->format == AV_PIX_FMT_RGB32)
+		{
+			overlay_image((uint32_t *) avframe->data[0], s->media_icons[1], avframe->width, avframe->linesize[0] / sizeof(uint32_t), avframe->height, IMG_POS_MIDDLE);
+		}
 		
-		overlay_image((uint32_t *) avframe->data[0], s->media_icons[1], avframe->width, avframe->linesize[0] / sizeof(uint32_t), avframe->height, IMG_POS_MIDDLE);
 		s->last_paused = time(0);
 	}
 	else
 	{
-		avframe = _frame_dbuffer_flip(&s->out_video_buffer);
+		avframe = _frame_ring_read(&s->out_video_ring, s->video_pts++);
 		/* Show 'play' icon for 5 seconds after resuming play */
-		if(time(0) - s->last_paused < 5)
+		if(avframe && avframe->format == AV_PIX_FMT_RGB32 && time(0) - s->last_paused < 5)
 		{
 			overlay_image((uint32_t *) avframe->data[0], s->media_icons[0], avframe->width, avframe->linesize[0] / sizeof(uint32_t), avframe->height, IMG_POS_MIDDLE);
 		}
@@ -982,9 +1454,55 @@ static int _ffmpeg_read_video(void *ctx, av_frame_t *frame)
 	/* Return CC608 code */
 	cc608_fifo_read(&s->ccfifo, frame->cc608, 2);
 	
-	/* Set the pointer to the framebuffer */
 	frame->width = avframe->width;
 	frame->height = avframe->height;
+	
+	if(avframe->format != AV_PIX_FMT_RGB32)
+	{
+		const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(avframe->format);
+		
+		/* Set the pointers to the YUV planes */
+		frame->format = AV_FRAME_YUV;
+		
+		for(i = 0; i < 3; i++)
+		{
+			frame->planes[i] = avframe->data[i];
+			frame->plane_stride[i] = avframe->linesize[i];
+		}
+		
+		frame->chroma_shift_x = desc->log2_chroma_w;
+		frame->chroma_shift_y = desc->log2_chroma_h;
+		
+		switch(avframe->colorspace)
+		{
+		case AVCOL_SPC_BT709:
+			frame->colour_matrix = AV_MATRIX_BT709;
+			break;
+		
+		case AVCOL_SPC_BT2020_NCL:
+		case AVCOL_SPC_BT2020_CL:
+			frame->colour_matrix = AV_MATRIX_BT2020;
+			break;
+		
+		case AVCOL_SPC_UNSPECIFIED:
+			/* Guess from the source resolution */
+			frame->colour_matrix = s->video_codec_ctx->height >= 720 ? AV_MATRIX_BT709 : AV_MATRIX_BT601;
+			break;
+		
+		default:
+			frame->colour_matrix = AV_MATRIX_BT601;
+			break;
+		}
+		
+		frame->full_range = avframe->color_range == AVCOL_RANGE_JPEG ||
+			avframe->format == AV_PIX_FMT_YUVJ420P ||
+			avframe->format == AV_PIX_FMT_YUVJ422P ||
+			avframe->format == AV_PIX_FMT_YUVJ444P;
+		
+		return(AV_OK);
+	}
+	
+	/* Set the pointer to the framebuffer */
 	frame->framebuffer = (uint32_t *) avframe->data[0];
 	frame->pixel_stride = 1;
 	frame->line_stride = avframe->linesize[0] / sizeof(uint32_t);
@@ -1196,17 +1714,19 @@ static int _ffmpeg_close(void *ctx)
 	if(s->video_stream != NULL)
 	{
 		_frame_dbuffer_abort(&s->in_video_buffer);
-		_frame_dbuffer_abort(&s->out_video_buffer);
+		_frame_ring_abort(&s->out_video_ring);
 		
 		pthread_join(s->video_decode_thread, NULL);
 		pthread_join(s->video_scaler_thread, NULL);
 		
-		_packet_queue_free(s, &s->video_queue);
 		_frame_dbuffer_free(&s->in_video_buffer);
 		
-		av_freep(&s->out_video_buffer.frame[0]->data[0]);
-		av_freep(&s->out_video_buffer.frame[1]->data[0]);
-		_frame_dbuffer_free(&s->out_video_buffer);
+		if(s->av->stats)
+		{
+			_frame_ring_print_stats("video", &s->out_video_ring);
+		}
+		
+		_frame_ring_free(&s->out_video_ring);
 		
 		avcodec_free_context(&s->video_codec_ctx);
 		sws_freeContext(s->sws_ctx);
@@ -1220,7 +1740,6 @@ static int _ffmpeg_close(void *ctx)
 		pthread_join(s->audio_decode_thread, NULL);
 		pthread_join(s->audio_scaler_thread, NULL);
 		
-		_packet_queue_free(s, &s->audio_queue);
 		_frame_dbuffer_free(&s->in_audio_buffer);
 		
 		//av_freep(&s->out_audio_buffer.frame[0]->data[0]);
@@ -1231,10 +1750,14 @@ static int _ffmpeg_close(void *ctx)
 		swr_free(&s->swr_ctx);
 	}
 	
-	avformat_close_input(&s->format_ctx);
+	_packet_queue_free(s, &s->video_queue);
+	_packet_queue_free(s, &s->audio_queue);
+	
+	font_free(s->font[TEXT_TIMESTAMP]);
+	font_free(s->font[TEXT_SUBTITLE]);
+	subs_free(s->av_sub);
 	
-	pthread_cond_destroy(&s->cond);
-	pthread_mutex_destroy(&s->mutex);
+	avformat_close_input(&s->format_ctx);
 	
 	cc608_fifo_free(&s->ccfifo);
 	
@@ -1243,11 +1766,10 @@ static int _ffmpeg_close(void *ctx)
 	return(AV_OK);
 }
 
-int av_ffmpeg_open(vid_t *vid, void *ctx, char *input_url, char *format, char *options)
+int av_ffmpeg_open(vid_t *vid, av_t *av, char *input_url, char *format, char *options)
 {
 	av_ffmpeg_t *s;
-	vid_config_t *conf = ctx;
-	av_t *av = &vid->av;
+	vid_config_t *conf;
 
 	const AVInputFormat *fmt = NULL;
 	const AVCodec *codec;
@@ -1274,9 +1796,14 @@ int av_ffmpeg_open(vid_t *vid, void *ctx, char *input_url, char *format, char *o
 
 	s->paused = 0;
 	
-	s->av = av;
+	/* Subtitle, timestamp and logo settings are cleared
+	 * below if they fail. Only this source sees that */
+	s->conf = vid->conf;
+	conf = &s->conf;
 	
-	s->av = av;
+	/* The source may be opened into a temporary av_t and moved
+	 * to vid->av later. The settings are the same in both */
+	s->av = &vid->av;
 	
 	/* Use 'pipe:' for stdin */
 	if(strcmp(input_url, "-") == 0)
@@ -1502,24 +2029,8 @@ int av_ffmpeg_open(vid_t *vid, void *ctx, char *input_url, char *format, char *o
 		
 		/* Video filter ends here */
 		
-		/* Initialise SWS context for software scaling */
-		s->sws_ctx = sws_getContext(
-			s->video_codec_ctx->width,
-			s->video_codec_ctx->height,
-			s->video_codec_ctx->pix_fmt,
-			av->width,
-			av->height,
-			AV_PIX_FMT_RGB32,
-			SWS_BICUBIC,
-			NULL,
-			NULL,
-			NULL
-		);
-		
-		if(!s->sws_ctx)
-		{
-			return(AV_OUT_OF_MEMORY);
-		}
+		/* The scaler is created by the scaler thread once
+		 * the format of the decoded frames is known */
 		
 		s->video_eof = 0;
 	}
@@ -1811,12 +2322,16 @@ int av_ffmpeg_open(vid_t *vid, void *ctx, char *input_url, char *format, char *o
 	{
 		conf->timestamp = time(0);
 		
+		/* av->av_font still points at any earlier font if this
+		 * fails, so only take it once the init has succeeded */
 		if(font_init(av, 40, source_ratio, conf) != VID_OK)
 		{
 			conf->timestamp = 0;
-		};
-		
-		s->font[TEXT_TIMESTAMP] = av->av_font;
+		}
+		else
+		{
+			s->font[TEXT_TIMESTAMP] = av->av_font;
+		}
 	}
 	
 	/* Calculate ratio */
@@ -1843,6 +2358,13 @@ int av_ffmpeg_open(vid_t *vid, void *ctx, char *input_url, char *format, char *o
 		return(HACKTV_ERROR);
 	}
 		
+	/* Frames can be passed to the renderer as YUV
+	 * if nothing needs to be drawn over them */
+	s->yuv = av->allow_yuv &&
+		s->font[TEXT_TIMESTAMP] == NULL &&
+		s->font[TEXT_SUBTITLE] == NULL &&
+		s->av_logo == NULL;
+	
 	/* Allocate cc608 fifo */
 	if(cc608_fifo_init(&s->ccfifo) != 0)
 	{
@@ -1850,7 +2372,7 @@ int av_ffmpeg_open(vid_t *vid, void *ctx, char *input_url, char *format, char *o
 	}
 	
 	/* Register the callback functions */
-	s->vid_conf = &vid->conf;
+	s->vid_conf = &s->conf;
 	s->vid_tt = &vid->tt;
 	s->width = av->width;
 	s->height = av->height;
@@ -1862,28 +2384,54 @@ int av_ffmpeg_open(vid_t *vid, void *ctx, char *input_url, char *format, char *o
 	
 	/* Start the threads */
 	s->thread_abort = 0;
-	pthread_mutex_init(&s->mutex, NULL);
-	pthread_cond_init(&s->cond, NULL);
-	_packet_queue_init(s, &s->video_queue);
-	_packet_queue_init(s, &s->audio_queue);
+	s->input_stall = NULL;
+	
+	if(_packet_queue_init(s, &s->video_queue, s->video_stream) != 0 ||
+	   _packet_queue_init(s, &s->audio_queue, s->audio_stream) != 0)
+	{
+		_packet_queue_free(s, &s->video_queue);
+		_packet_queue_free(s, &s->audio_queue);
+		return(AV_OUT_OF_MEMORY);
+	}
 	
 	if(s->video_stream != NULL)
 	{
+		enum AVPixelFormat format;
+		r64_t size;
+		
 		_frame_dbuffer_init(&s->in_video_buffer);
-		_frame_dbuffer_init(&s->out_video_buffer);
 		
-		/* Allocate memory for the output frame buffers */
-		for(i = 0; i < 2; i++)
+		if(_frame_ring_init(&s->out_video_ring, av->video_buffers > 0 ? av->video_buffers : VIDEO_RING_FRAMES) != 0)
 		{
-			s->out_video_buffer.frame[i]->width = av->width;
-			s->out_video_buffer.frame[i]->height = av->height;
-			
-			r = av_image_alloc(
-				s->out_video_buffer.frame[i]->data,
-				s->out_video_buffer.frame[i]->linesize,
-				av->width, av->height,
-				AV_PIX_FMT_RGB32, av_cpu_max_align()
-			);
+			_packet_queue_free(s, &s->video_queue);
+			_packet_queue_free(s, &s->audio_queue);
+			return(AV_OUT_OF_MEMORY);
+		}
+		
+		s->video_next_pts = 0;
+		s->video_pts = 0;
+		
+		/* Preallocate the output frames at the size the
+		 * scaler will produce for the filter's output */
+		size = _output_frame_size(
+			s,
+			av_buffersink_get_w(s->vbuffersink_ctx),
+			av_buffersink_get_h(s->vbuffersink_ctx),
+			_sample_aspect_ratio(s, NULL)
+		);
+		
+		format = _output_format(s, av_buffersink_get_format(s->vbuffersink_ctx));
+		
+		for(i = 0; i < s->out_video_ring.size; i++)
+		{
+			r = _alloc_video_frame(s->out_video_ring.frame[i], format, size.num, size.den);
+			if(r != 0)
+			{
+				_frame_ring_free(&s->out_video_ring);
+				_packet_queue_free(s, &s->video_queue);
+				_packet_queue_free(s, &s->audio_queue);
+				return(AV_OUT_OF_MEMORY);
+			}
 		}
 		
 		r = pthread_create(&s->video_decode_thread, NULL, &_video_decode_thread, (void *) s);
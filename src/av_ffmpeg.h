@@ -18,7 +18,7 @@
 #ifndef _FFMPEG_H
 #define _FFMPEG_H
 
-extern int av_ffmpeg_open(vid_t *av, void *conf, char *input_url, char *format, char *options);
+extern int av_ffmpeg_open(vid_t *vid, av_t *av, char *input_url, char *format, char *options);
 extern void av_ffmpeg_init(void);
 extern void av_ffmpeg_deinit(void);
 
@@ -44,22 +44,23 @@ static int _test_read_video(void *ctx, av_frame_t *frame)
 	/* Get current time */
 	time_t secs = time(0);
 	struct tm *time = localtime(&secs);
-	s->font[TEXT_TIMESTAMP]->text = malloc(16 * sizeof(char));
-	sprintf(s->font[TEXT_TIMESTAMP]->text, "%02d:%02d:%02d", time->tm_hour, time->tm_min, time->tm_sec);
 
 	/* Print clock */
 	if(s->font[TEXT_TIMESTAMP])
 	{
+		s->font[TEXT_TIMESTAMP]->text = malloc(16 * sizeof(char));
+		sprintf(s->font[TEXT_TIMESTAMP]->text, "%02d:%02d:%02d", time->tm_hour, time->tm_min, time->tm_sec);
+		
 		print_generic_text(	s->font[TEXT_TIMESTAMP],
 							s->video,
 							s->width,
 							s->font[TEXT_TIMESTAMP]->text,
 							s->font[TEXT_TIMESTAMP]->x_loc, s->font[TEXT_TIMESTAMP]->y_loc, NO_TEXT_SHADOW, TEXT_BOX, 0, 1);
+		
+		/* Free memory */
+		free(s->font[TEXT_TIMESTAMP]->text);
 	}
 	
-	/* Free memory */
-	free(s->font[TEXT_TIMESTAMP]->text);
-	
 	return(AV_OK);
 }
 
@@ -76,10 +77,29 @@ static int _test_close(void *ctx)
 	av_test_t *s = ctx;
 	if(s->video) free(s->video);
 	if(s->audio) free(s->audio);
+	font_free(s->font[TEXT_TIMESTAMP]);
+	font_free(s->font[TEXT_GENERIC]);
 	free(s);
 	return(AV_OK);
 }
 
+static av_font_t *_test_font(av_t *av, int size, float ratio, void *conf, float x_loc, float y_loc)
+{
+	av_font_t *font;
+	
+	/* av->av_font is left unchanged if the init fails */
+	if(font_init(av, size, ratio, conf) != HACKTV_OK)
+	{
+		return(NULL);
+	}
+	
+	font = av->av_font;
+	font->x_loc = x_loc;
+	font->y_loc = y_loc;
+	
+	return(font);
+}
+
 static uint8_t _hamming_bars(int x, int sr, int frequency)
 {
 	double sample, y;
@@ -174,16 +194,10 @@ int av_test_open(av_t *av, char *test_screen, void *ctx)
 	/* Initialise default fonts */
 	
 	/* Clock */
-	font_init(av, 56, img_ratio, conf);
-	t->font[TEXT_TIMESTAMP] = av->av_font;
-	t->font[TEXT_TIMESTAMP]->x_loc = 50;
-	t->font[TEXT_TIMESTAMP]->y_loc = 50;
+	t->font[TEXT_TIMESTAMP] = _test_font(av, 56, img_ratio, conf, 50, 50);
 	
 	/* HACKTV text*/
-	font_init(av, 72, img_ratio, conf);
-	t->font[TEXT_GENERIC] = av->av_font;
-	t->font[TEXT_GENERIC]->x_loc = 50;
-	t->font[TEXT_GENERIC]->y_loc = 25;
+	t->font[TEXT_GENERIC] = _test_font(av, 72, img_ratio, conf, 50, 25);
 	
 	int sr = 20250.0 * (t->width / 1052.0);
 	
@@ -196,7 +210,7 @@ int av_test_open(av_t *av, char *test_screen, void *ctx)
 			
 			if(strcmp(test_screen, "pm5544") == 0)
 			{
-				t->font[TEXT_TIMESTAMP]->y_loc = 82.3;
+				if(t->font[TEXT_TIMESTAMP]) t->font[TEXT_TIMESTAMP]->y_loc = 82.3;
 
 				y_start = t->height - 270;
 				y_end = t->height - 180;
@@ -229,7 +243,7 @@ int av_test_open(av_t *av, char *test_screen, void *ctx)
 			}
 			else if(strcmp(test_screen, "pm5644") == 0)
 			{
-				t->font[TEXT_TIMESTAMP]->y_loc = 82;
+				if(t->font[TEXT_TIMESTAMP]) t->font[TEXT_TIMESTAMP]->y_loc = 82;
 
 				y_start = t->height - 271;
 				y_end = t->height - 181;
@@ -279,26 +293,31 @@ int av_test_open(av_t *av, char *test_screen, void *ctx)
 			else if(strcmp(test_screen, "fubk") == 0)
 			{
 				/* Reinit font with new size */
-				font_init(av, 44, img_ratio, conf);
-				t->font[TEXT_TIMESTAMP] = av->av_font;
-				t->font[TEXT_TIMESTAMP]->x_loc = 52;
-				t->font[TEXT_TIMESTAMP]->y_loc = 55.5;
+				font_free(t->font[TEXT_TIMESTAMP]);
+				t->font[TEXT_TIMESTAMP] = _test_font(av, 44, img_ratio, conf, 52, 55.5);
 			}
 			else if(strcmp(test_screen, "ueitm") == 0)
 			{
 				/* Don't display clock */
+				font_free(t->font[TEXT_TIMESTAMP]);
 				t->font[TEXT_TIMESTAMP] = NULL;
 			}
 			
 		}
 		else
 		{
-			print_generic_text(	t->font[TEXT_GENERIC], t->video, t->width, "HACKTV", t->font[TEXT_GENERIC]->x_loc, t->font[TEXT_GENERIC]->y_loc, NO_TEXT_SHADOW, TEXT_BOX, 0, 1);
+			if(t->font[TEXT_GENERIC])
+			{
+				print_generic_text(t->font[TEXT_GENERIC], t->video, t->width, "HACKTV", t->font[TEXT_GENERIC]->x_loc, t->font[TEXT_GENERIC]->y_loc, NO_TEXT_SHADOW, TEXT_BOX, 0, 1);
+			}
 		}
 	}
 	else
 	{
-		print_generic_text(	t->font[TEXT_GENERIC], t->video, t->width, "HACKTV", t->font[TEXT_GENERIC]->x_loc, t->font[TEXT_GENERIC]->y_loc, NO_TEXT_SHADOW, TEXT_BOX, 0, 1);
+		if(t->font[TEXT_GENERIC])
+		{
+			print_generic_text(t->font[TEXT_GENERIC], t->video, t->width, "HACKTV", t->font[TEXT_GENERIC]->x_loc, t->font[TEXT_GENERIC]->y_loc, NO_TEXT_SHADOW, TEXT_BOX, 0, 1);
+		}
 	}
 	
 	/* Print logo, if enabled */
@@ -308,10 +327,6 @@ int av_test_open(av_t *av, char *test_screen, void *ctx)
 		{
 			overlay_image(t->video, t->logo, t->width, t->width, t->height, t->logo->position);
 		}
-		else
-		{
-			conf->logo = NULL;
-		}
 	}
 	
 	/* Generate the 1khz test tones (BBC 1 style) */
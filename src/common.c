@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <ctype.h>
+#include <time.h>
 #include "common.h"
 
 int64_t gcd(int64_t a, int64_t b)
@@ -282,6 +283,16 @@ double rrc(double x, double b, double t)
 	return(r);
 }
 
+int64_t time_ns(void)
+{
+	struct timespec ts;
+	
+	/* Monotonic time in nanoseconds, for measuring intervals */
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	
+	return((int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
 #if !defined(_POSIX_BARRIERS) || _POSIX_BARRIERS <= 0
 
 int pthread_barrier_destroy(pthread_barrier_t *barrier)
@@ -54,6 +54,7 @@ extern r64_t r64_parse(const char *str, const char **endptr);
 extern cint16_t *sin_cint16(unsigned int length, unsigned int cycles, double level);
 extern double rc_window(double t, double left, double width, double rise);
 extern double rrc(double x, double b, double t);
+extern int64_t time_ns(void);
 
 static inline void cint16_mul(cint16_t *r, const cint16_t *a, const cint16_t *b)
 {
@@ -0,0 +1,317 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+/* -=== DES block cipher ===-
+ * 
+ * The DES core shared by the Eurocrypt, Syster and Discret 14 access
+ * control modules. The S-boxes are merged with the P permutation into
+ * SP tables and the remaining permutations are applied a byte at a
+ * time from lookup tables, all built once on first use.
+*/
+
+#include <stdint.h>
+#include <pthread.h>
+#include "des.h"
+
+/* Initial permutation */
+static const uint8_t _ip[] = {
+	58, 50, 42, 34, 26, 18, 10, 2,
+	60, 52, 44, 36, 28, 20, 12, 4,
+	62, 54, 46, 38, 30, 22, 14, 6,
+	64, 56, 48, 40, 32, 24, 16, 8,
+	57, 49, 41, 33, 25, 17,  9, 1,
+	59, 51, 43, 35, 27, 19, 11, 3,
+	61, 53, 45, 37, 29, 21, 13, 5,
+	63, 55, 47, 39, 31, 23, 15, 7,
+};
+
+/* Inverse/final permutation */
+static const uint8_t _fp[] = {
+	40, 8, 48, 16, 56, 24, 64, 32,
+	39, 7, 47, 15, 55, 23, 63, 31,
+	38, 6, 46, 14, 54, 22, 62, 30,
+	37, 5, 45, 13, 53, 21, 61, 29,
+	36, 4, 44, 12, 52, 20, 60, 28,
+	35, 3, 43, 11, 51, 19, 59, 27,
+	34, 2, 42, 10, 50, 18, 58, 26,
+	33, 1, 41,  9, 49, 17, 57, 25,
+};
+
+static const uint8_t _perm[] = {
+	16,  7, 20, 21,
+	29, 12, 28, 17,
+	 1, 15, 23, 26,
+	 5, 18, 31, 10,
+	 2,  8, 24, 14,
+	32, 27,  3,  9,
+	19, 13, 30,  6,
+	22, 11,  4, 25
+};
+
+static const uint8_t _pc1[] = {
+	57, 49, 41, 33, 25, 17,  9,
+	 1, 58, 50, 42, 34, 26, 18,
+	10,  2, 59, 51, 43, 35, 27,
+	19, 11,  3, 60, 52, 44, 36,
+	63, 55, 47, 39, 31, 23, 15,
+	 7, 62, 54, 46, 38, 30, 22,
+	14,  6, 61, 53, 45, 37, 29,
+	21, 13,  5, 28, 20, 12,  4
+};
+
+/* Inverse PC1 table. The eight parity bits are taken from bits 57-64 */
+static const uint8_t _ipc1[] = {
+	8, 16, 24, 56, 52, 44, 36, 57, 
+	7, 15, 23, 55, 51, 43, 35, 58, 
+	6, 14, 22, 54, 50, 42, 34, 59, 
+	5, 13, 21, 53, 49, 41, 33, 60, 
+	4, 12, 20, 28, 48, 40, 32, 61, 
+	3, 11, 19, 27, 47, 39, 31, 62, 
+	2, 10, 18, 26, 46, 38, 30, 63, 
+	1,  9, 17, 25, 45, 37, 29, 64
+};
+
+static const uint8_t _pc2[] = {
+	14, 17, 11, 24,  1,  5,
+	 3, 28, 15,  6, 21, 10,
+	23, 19, 12,  4, 26,  8,
+	16,  7, 27, 20, 13,  2,
+	41, 52, 31, 37, 47, 55,
+	30, 40, 51, 45, 33, 48,
+	44, 49, 39, 56, 34, 53,
+	46, 42, 50, 36, 29, 32
+};
+
+static const uint8_t _lshift[] = {
+	1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1
+};
+
+/* The S-boxes, in row/column order */
+static const uint8_t _sb[8][64] = {
+	{ 14,  4, 13,  1,  2, 15, 11,  8,  3, 10,  6, 12,  5,  9,  0,  7,
+	   0, 15,  7,  4, 14,  2, 13,  1, 10,  6, 12, 11,  9,  5,  3,  8,
+	   4,  1, 14,  8, 13,  6,  2, 11, 15, 12,  9,  7,  3, 10,  5,  0,
+	  15, 12,  8,  2,  4,  9,  1,  7,  5, 11,  3, 14, 10,  0,  6, 13 },
+	{ 15,  1,  8, 14,  6, 11,  3,  4,  9,  7,  2, 13, 12,  0,  5, 10,
+	   3, 13,  4,  7, 15,  2,  8, 14, 12,  0,  1, 10,  6,  9, 11,  5,
+	   0, 14,  7, 11, 10,  4, 13,  1,  5,  8, 12,  6,  9,  3,  2, 15,
+	  13,  8, 10,  1,  3, 15,  4,  2, 11,  6,  7, 12,  0,  5, 14,  9 },
+	{ 10,  0,  9, 14,  6,  3, 15,  5,  1, 13, 12,  7, 11,  4,  2,  8,
+	  13,  7,  0,  9,  3,  4,  6, 10,  2,  8,  5, 14, 12, 11, 15,  1,
+	  13,  6,  4,  9,  8, 15,  3,  0, 11,  1,  2, 12,  5, 10, 14,  7,
+	   1, 10, 13,  0,  6,  9,  8,  7,  4, 15, 14,  3, 11,  5,  2, 12 },
+	{  7, 13, 14,  3,  0,  6,  9, 10,  1,  2,  8,  5, 11, 12,  4, 15,
+	  13,  8, 11,  5,  6, 15,  0,  3,  4,  7,  2, 12,  1, 10, 14,  9,
+	  10,  6,  9,  0, 12, 11,  7, 13, 15,  1,  3, 14,  5,  2,  8,  4,
+	   3, 15,  0,  6, 10,  1, 13,  8,  9,  4,  5, 11, 12,  7,  2, 14 },
+	{  2, 12,  4,  1,  7, 10, 11,  6,  8,  5,  3, 15, 13,  0, 14,  9,
+	  14, 11,  2, 12,  4,  7, 13,  1,  5,  0, 15, 10,  3,  9,  8,  6,
+	   4,  2,  1, 11, 10, 13,  7,  8, 15,  9, 12,  5,  6,  3,  0, 14,
+	  11,  8, 12,  7,  1, 14,  2, 13,  6, 15,  0,  9, 10,  4,  5,  3 },
+	{ 12,  1, 10, 15,  9,  2,  6,  8,  0, 13,  3,  4, 14,  7,  5, 11,
+	  10, 15,  4,  2,  7, 12,  9,  5,  6,  1, 13, 14,  0, 11,  3,  8,
+	   9, 14, 15,  5,  2,  8, 12,  3,  7,  0,  4, 10,  1, 13, 11,  6,
+	   4,  3,  2, 12,  9,  5, 15, 10, 11, 14,  1,  7,  6,  0,  8, 13 },
+	{  4, 11,  2, 14, 15,  0,  8, 13,  3, 12,  9,  7,  5, 10,  6,  1,
+	  13,  0, 11,  7,  4,  9,  1, 10, 14,  3,  5, 12,  2, 15,  8,  6,
+	   1,  4, 11, 13, 12,  3,  7, 14, 10, 15,  6,  8,  0,  5,  9,  2,
+	   6, 11, 13,  8,  1,  4, 10,  7,  9,  5,  0, 15, 14,  2,  3, 12 },
+	{ 13,  2,  8,  4,  6, 15, 11,  1, 10,  9,  3, 14,  5,  0, 12,  7,
+	   1, 15, 13,  8, 10,  3,  7,  4, 12,  5,  6, 11,  0, 14,  9,  2,
+	   7, 11,  4,  1,  9, 12, 14,  2,  0,  6, 10, 13, 15,  3,  5,  8,
+	   2,  1, 14,  7,  4, 10,  8, 13, 15, 12,  9,  0,  3,  5,  6, 11 }
+};
+
+/* Lookup tables, built once by _init_tables() */
+static uint32_t _sp[8][64];
+static uint64_t _ip_tab[8][256];
+static uint64_t _fp_tab[8][256];
+static uint64_t _pc1_tab[8][256];
+static uint64_t _ipc1_tab[8][256];
+static uint64_t _pc2_tab[7][256];
+static pthread_once_t _tables_once = PTHREAD_ONCE_INIT;
+
+static void _init_perm(uint64_t tab[][256], int bytes, const uint8_t *p, int n)
+{
+	int i, b, v;
+	
+	/* Entry [b][v] is the output for byte b (counting from the LSB)
+	 * of the input having the value v, and all other bytes zero */
+	for(b = 0; b < bytes; b++)
+	{
+		for(v = 0; v < 256; v++)
+		{
+			uint64_t o = 0;
+			
+			for(i = 0; i < n; i++)
+			{
+				/* Table entries count from 1 at the input MSB */
+				int s = bytes * 8 - p[i];
+				
+				if((s >> 3) == b && (v >> (s & 7) & 1))
+				{
+					o |= (uint64_t) 1 << (n - 1 - i);
+				}
+			}
+			
+			tab[b][v] = o;
+		}
+	}
+}
+
+static void _init_tables(void)
+{
+	int i, j, v;
+	
+	/* Merge each S-box with the P permutation of its output */
+	for(i = 0; i < 8; i++)
+	{
+		for(v = 0; v < 64; v++)
+		{
+			uint32_t s, o;
+			
+			/* The outer two bits of v select the row */
+			s = _sb[i][(v & 0x20) | (v & 1) << 4 | (v >> 1 & 0x0F)];
+			s <<= 28 - 4 * i;
+			
+			for(o = j = 0; j < 32; j++)
+			{
+				o |= (s >> (32 - _perm[j]) & 1) << (31 - j);
+			}
+			
+			_sp[i][v] = o;
+		}
+	}
+	
+	_init_perm(_ip_tab, 8, _ip, 64);
+	_init_perm(_fp_tab, 8, _fp, 64);
+	_init_perm(_pc1_tab, 8, _pc1, 56);
+	_init_perm(_ipc1_tab, 8, _ipc1, 64);
+	_init_perm(_pc2_tab, 7, _pc2, 48);
+}
+
+static uint64_t _permute(uint64_t tab[][256], int bytes, uint64_t x)
+{
+	uint64_t o;
+	int b;
+	
+	for(o = b = 0; b < bytes; b++, x >>= 8)
+	{
+		o |= tab[b][x & 0xFF];
+	}
+	
+	return(o);
+}
+
+void des_key(des_key_t *ks, uint64_t key)
+{
+	pthread_once(&_tables_once, _init_tables);
+	
+	/* PC1 drops the parity bits and splits the key into two halves */
+	key = _permute(_pc1_tab, 8, key);
+	
+	des_key_cd(ks, key >> 28, key & 0x0FFFFFFF);
+}
+
+void des_key_cd(des_key_t *ks, uint32_t c, uint32_t d)
+{
+	uint64_t k;
+	int i, j;
+	
+	pthread_once(&_tables_once, _init_tables);
+	
+	for(i = 0; i < 16; i++)
+	{
+		/* Rotate each 28-bit half left */
+		c = (c << _lshift[i] | c >> (28 - _lshift[i])) & 0x0FFFFFFF;
+		d = (d << _lshift[i] | d >> (28 - _lshift[i])) & 0x0FFFFFFF;
+		
+		/* PC2 selects the 48-bit round key */
+		k = _permute(_pc2_tab, 7, (uint64_t) c << 28 | d);
+		
+		for(j = 0; j < 8; j++)
+		{
+			ks->k[i][j] = k >> (42 - 6 * j) & 0x3F;
+		}
+	}
+}
+
+uint64_t des_pc1_inverse(uint64_t cd)
+{
+	pthread_once(&_tables_once, _init_tables);
+	
+	return(_permute(_ipc1_tab, 8, cd));
+}
+
+/* The functions below expect the tables to have been built by
+ * creating a key schedule with des_key() or des_key_cd() first */
+
+uint64_t des_ip(uint64_t x)
+{
+	return(_permute(_ip_tab, 8, x));
+}
+
+uint64_t des_fp(uint64_t x)
+{
+	return(_permute(_fp_tab, 8, x));
+}
+
+uint32_t des_f(uint32_t r, const uint8_t k[8])
+{
+	/* The expansion E is eight overlapping 6-bit windows onto R,
+	 * the first and last wrapping around bits 32 and 1 */
+	return(_sp[0][((r >> 27 | r << 5) & 0x3F) ^ k[0]]
+	     | _sp[1][((r >> 23) & 0x3F) ^ k[1]]
+	     | _sp[2][((r >> 19) & 0x3F) ^ k[2]]
+	     | _sp[3][((r >> 15) & 0x3F) ^ k[3]]
+	     | _sp[4][((r >> 11) & 0x3F) ^ k[4]]
+	     | _sp[5][((r >>  7) & 0x3F) ^ k[5]]
+	     | _sp[6][((r >>  3) & 0x3F) ^ k[6]]
+	     | _sp[7][((r << 1 | r >> 31) & 0x3F) ^ k[7]]);
+}
+
+uint64_t des_crypt(const des_key_t *ks, uint64_t x, int mode)
+{
+	uint32_t l, r, t;
+	int i;
+	
+	x = des_ip(x);
+	l = x >> 32;
+	r = x & 0xFFFFFFFF;
+	
+	/* Decryption uses the round keys in reverse order */
+	for(i = 0; i < 16; i++)
+	{
+		t = l ^ des_f(r, ks->k[mode == DES_DECRYPT ? 15 - i : i]);
+		l = r;
+		r = t;
+	}
+	
+	return(des_fp((uint64_t) r << 32 | l));
+}
+
+uint64_t des3_crypt(const des_key_t *k1, const des_key_t *k2, uint64_t x, int mode)
+{
+	int inv = mode == DES_DECRYPT ? DES_ENCRYPT : DES_DECRYPT;
+	
+	/* Two-key EDE (or DED to decrypt) */
+	x = des_crypt(k1, x, mode);
+	x = des_crypt(k2, x, inv);
+	
+	return(des_crypt(k1, x, mode));
+}
+
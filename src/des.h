@@ -0,0 +1,46 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _DES_H
+#define _DES_H
+
+#include <stdint.h>
+
+#define DES_ENCRYPT 0
+#define DES_DECRYPT 1
+
+/* Expanded DES key schedule. Each round key is held as eight
+ * 6-bit values, one per S-box, ready to XOR with the expanded R */
+typedef struct {
+	uint8_t k[16][8];
+} des_key_t;
+
+/* Blocks and keys are 64-bit integers, with bit 1 of the FIPS 46
+ * tables in the MSB (i.e. the first byte is the most significant) */
+extern void des_key(des_key_t *ks, uint64_t key);
+extern void des_key_cd(des_key_t *ks, uint32_t c, uint32_t d);
+extern uint64_t des_pc1_inverse(uint64_t cd);
+
+extern uint64_t des_ip(uint64_t x);
+extern uint64_t des_fp(uint64_t x);
+extern uint32_t des_f(uint32_t r, const uint8_t k[8]);
+
+extern uint64_t des_crypt(const des_key_t *ks, uint64_t x, int mode);
+extern uint64_t des3_crypt(const des_key_t *k1, const des_key_t *k2, uint64_t x, int mode);
+
+#endif
+
@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include "des.h"
 #include "discret14-ca.h"
 
 static const uint8_t kEepromBroadcastKey[8] =
@@ -51,90 +52,6 @@ static const uint8_t kEepromAsicKey[8] =
     0x41, 0x42, 0x43, 0x4C, 0x49, 0x52, 0x4F, 0x59
 };
 
-static const int IP[64] =
-{
-    58,50,42,34,26,18,10, 2, 60,52,44,36,28,20,12, 4,
-    62,54,46,38,30,22,14, 6, 64,56,48,40,32,24,16, 8,
-    57,49,41,33,25,17, 9, 1, 59,51,43,35,27,19,11, 3,
-    61,53,45,37,29,21,13, 5, 63,55,47,39,31,23,15, 7
-};
-
-static const int FP[64] =
-{
-    40, 8,48,16,56,24,64,32, 39, 7,47,15,55,23,63,31,
-    38, 6,46,14,54,22,62,30, 37, 5,45,13,53,21,61,29,
-    36, 4,44,12,52,20,60,28, 35, 3,43,11,51,19,59,27,
-    34, 2,42,10,50,18,58,26, 33, 1,41, 9,49,17,57,25
-};
-
-static const int E_TBL[48] =
-{
-    32, 1, 2, 3, 4, 5,  4, 5, 6, 7, 8, 9,
-     8, 9,10,11,12,13, 12,13,14,15,16,17,
-    16,17,18,19,20,21, 20,21,22,23,24,25,
-    24,25,26,27,28,29, 28,29,30,31,32, 1
-};
-
-static const int P_TBL[32] =
-{
-    16, 7,20,21, 29,12,28,17,  1,15,23,26,  5,18,31,10,
-     2, 8,24,14, 32,27, 3, 9, 19,13,30, 6, 22,11, 4,25
-};
-
-static const int PC1[56] =
-{
-    57,49,41,33,25,17, 9,  1,58,50,42,34,26,18,
-    10, 2,59,51,43,35,27, 19,11, 3,60,52,44,36,
-    63,55,47,39,31,23,15,  7,62,54,46,38,30,22,
-    14, 6,61,53,45,37,29, 21,13, 5,28,20,12, 4
-};
-
-static const int PC2[48] =
-{
-    14,17,11,24, 1, 5,  3,28,15, 6,21,10,
-    23,19,12, 4,26, 8, 16, 7,27,20,13, 2,
-    41,52,31,37,47,55, 30,40,51,45,33,48,
-    44,49,39,56,34,53, 46,42,50,36,29,32
-};
-
-static const int SHIFTS[16] = { 1,1,2,2,2,2,2,2,1,2,2,2,2,2,2,1 };
-
-static const uint8_t SBOX[8][64] =
-{
-    { 14,4,13,1,2,15,11,8,3,10,6,12,5,9,0,7,
-      0,15,7,4,14,2,13,1,10,6,12,11,9,5,3,8,
-      4,1,14,8,13,6,2,11,15,12,9,7,3,10,5,0,
-      15,12,8,2,4,9,1,7,5,11,3,14,10,0,6,13 },
-    { 15,1,8,14,6,11,3,4,9,7,2,13,12,0,5,10,
-      3,13,4,7,15,2,8,14,12,0,1,10,6,9,11,5,
-      0,14,7,11,10,4,13,1,5,8,12,6,9,3,2,15,
-      13,8,10,1,3,15,4,2,11,6,7,12,0,5,14,9 },
-    { 10,0,9,14,6,3,15,5,1,13,12,7,11,4,2,8,
-      13,7,0,9,3,4,6,10,2,8,5,14,12,11,15,1,
-      13,6,4,9,8,15,3,0,11,1,2,12,5,10,14,7,
-      1,10,13,0,6,9,8,7,4,15,14,3,11,5,2,12 },
-    { 7,13,14,3,0,6,9,10,1,2,8,5,11,12,4,15,
-      13,8,11,5,6,15,0,3,4,7,2,12,1,10,14,9,
-      10,6,9,0,12,11,7,13,15,1,3,14,5,2,8,4,
-      3,15,0,6,10,1,13,8,9,4,5,11,12,7,2,14 },
-    { 2,12,4,1,7,10,11,6,8,5,3,15,13,0,14,9,
-      14,11,2,12,4,7,13,1,5,0,15,10,3,9,8,6,
-      4,2,1,11,10,13,7,8,15,9,12,5,6,3,0,14,
-      11,8,12,7,1,14,2,13,6,15,0,9,10,4,5,3 },
-    { 12,1,10,15,9,2,6,8,0,13,3,4,14,7,5,11,
-      10,15,4,2,7,12,9,5,6,1,13,14,0,11,3,8,
-      9,14,15,5,2,8,12,3,7,0,4,10,1,13,11,6,
-      4,3,2,12,9,5,15,10,11,14,1,7,6,0,8,13 },
-    { 4,11,2,14,15,0,8,13,3,12,9,7,5,10,6,1,
-      13,0,11,7,4,9,1,10,14,3,5,12,2,15,8,6,
-      1,4,11,13,12,3,7,14,10,15,6,8,0,5,9,2,
-      6,11,13,8,1,4,10,7,9,5,0,15,14,2,3,12 },
-    { 13,2,8,4,6,15,11,1,10,9,3,14,5,0,12,7,
-      1,15,13,8,10,3,7,4,12,5,6,11,0,14,9,2,
-      7,11,4,1,9,12,14,2,0,6,10,13,15,3,5,8,
-      2,1,14,7,4,10,8,13,15,12,9,0,3,5,6,11 }
-};
-
 static uint64_t bytes_to_u64(const uint8_t in[8])
 {
     uint64_t x = 0;
@@ -154,92 +71,26 @@ static void u64_to_bytes(uint64_t x, uint8_t out[8])
     }
 }
 
-static uint64_t permute_bits(uint64_t in, const int *table, int n, int w)
-{
-    uint64_t out = 0;
-    int i;
-    for (i = 0; i < n; i++)
-    {
-        out <<= 1;
-        out |= (in >> (w - table[i])) & 1ULL;
-    }
-    return out;
-}
-
-static uint32_t rol28(uint32_t x, int s)
-{
-    x &= 0x0FFFFFFF;
-    return ((x << s) | (x >> (28 - s))) & 0x0FFFFFFF;
-}
-
-static void des_make_subkeys(const uint8_t key[8], uint64_t sk[16])
-{
-    uint64_t pc1 = permute_bits(bytes_to_u64(key), PC1, 56, 64);
-    uint32_t c = (uint32_t)((pc1 >> 28) & 0x0FFFFFFF);
-    uint32_t d = (uint32_t)(pc1 & 0x0FFFFFFF);
-    int r;
-
-    for (r = 0; r < 16; r++)
-    {
-        c = rol28(c, SHIFTS[r]);
-        d = rol28(d, SHIFTS[r]);
-        sk[r] = permute_bits(((uint64_t)c << 28) | d, PC2, 48, 56);
-    }
-}
-
-static uint32_t des_f(uint32_t r, uint64_t sk)
-{
-    uint64_t x = permute_bits((uint64_t)r, E_TBL, 48, 32) ^ sk;
-    uint32_t s_out = 0;
-    int i;
-
-    for (i = 0; i < 8; i++)
-    {
-        uint8_t ch = (uint8_t)((x >> (42 - 6 * i)) & 0x3F);
-        s_out = (s_out << 4) |
-                SBOX[i][(((ch & 0x20) >> 4) | (ch & 1)) * 16 + ((ch >> 1) & 0xF)];
-    }
-    return (uint32_t)permute_bits((uint64_t)s_out, P_TBL, 32, 32);
-}
-
-static void des_crypt_block(const uint8_t in[8], const uint8_t key[8],
+static void des_crypt_block(const uint8_t in[8], const des_key_t *ks,
                             uint8_t out[8], int decrypt)
 {
-    uint64_t sk[16], ip;
-    uint32_t l, r, tmp;
-    int rnd;
-
-    des_make_subkeys(key, sk);
-    ip = permute_bits(bytes_to_u64(in), IP, 64, 64);
-    l = (uint32_t)(ip >> 32);
-    r = (uint32_t)(ip & 0xFFFFFFFFUL);
-
-    for (rnd = 0; rnd < 16; rnd++)
-    {
-        tmp = r;
-        r = l ^ des_f(r, decrypt ? sk[15 - rnd] : sk[rnd]);
-        l = tmp;
-    }
-
-    u64_to_bytes(permute_bits(((uint64_t)r << 32) | l, FP, 64, 64), out);
+    u64_to_bytes(des_crypt(ks, bytes_to_u64(in),
+                           decrypt ? DES_DECRYPT : DES_ENCRYPT), out);
 }
 
 static void des_decrypt_block(const uint8_t in[8], const uint8_t key[8],
                               uint8_t out[8])
 {
-    des_crypt_block(in, key, out, 1);
-}
+    des_key_t ks;
 
-static void des_encrypt_block(const uint8_t in[8], const uint8_t key[8],
-                              uint8_t out[8])
-{
-    des_crypt_block(in, key, out, 0);
+    des_key(&ks, bytes_to_u64(key));
+    des_crypt_block(in, &ks, out, 1);
 }
 
-
 static void compute_asic_seeds(discret14_ca_t *ca)
 {
     uint8_t akey[8], val[8];
+    des_key_t ks;
     int i, all_zero = 1;
 
     memcpy(val, &ca->superframe[8], 8);
@@ -268,8 +119,10 @@ static void compute_asic_seeds(discret14_ca_t *ca)
         memcpy(akey, kEepromAsicKey, 8);
     }
 
-    des_encrypt_block(val, akey, &ca->asic_seed[0]);
-    des_encrypt_block(&ca->asic_seed[0], akey, &ca->asic_seed[8]);
+    /* Both seeds use the same key, expand it once */
+    des_key(&ks, bytes_to_u64(akey));
+    des_crypt_block(val, &ks, &ca->asic_seed[0], 0);
+    des_crypt_block(&ca->asic_seed[0], &ks, &ca->asic_seed[8], 0);
 }
 
 static void print_hex(const char *label, const uint8_t *d, int n)
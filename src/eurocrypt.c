@@ -23,17 +23,6 @@
 #include "video.h"
 #include <time.h>
 
-#define ECM  0
-#define HASH 1
-
-#define EC_M    0x20
-#define EC_S    0x01
-#define EC_S2   0x30
-#define EC_3DES 0x31
-
-#define ENCRYPT  1
-#define DECRYPT 2
-
 enum {
 	THEME_ARTS = 0x01,
 	THEME_CHILDREN,
@@ -101,116 +90,6 @@ const static em_mode_t _em_modes[] = {
 	{ NULL } 
 };
 
-/* Initial permutation for Eurocrypt-S2/3DES */
-static const uint8_t _ip[] = {
-	58, 50, 42, 34, 26, 18, 10, 2,
-	60, 52, 44, 36, 28, 20, 12, 4,
-	62, 54, 46, 38, 30, 22, 14, 6,
-	64, 56, 48, 40, 32, 24, 16, 8,
-	57, 49, 41, 33, 25, 17,  9, 1,
-	59, 51, 43, 35, 27, 19, 11, 3,
-	61, 53, 45, 37, 29, 21, 13, 5,
-	63, 55, 47, 39, 31, 23, 15, 7,
-};
-
-/* Inverse/final permutation for Eurocrypt-S2/3DES */
-static const uint8_t _ipp[] = {
-	40, 8, 48, 16, 56, 24, 64, 32,
-	39, 7, 47, 15, 55, 23, 63, 31,
-	38, 6, 46, 14, 54, 22, 62, 30,
-	37, 5, 45, 13, 53, 21, 61, 29,
-	36, 4, 44, 12, 52, 20, 60, 28,
-	35, 3, 43, 11, 51, 19, 59, 27,
-	34, 2, 42, 10, 50, 18, 58, 26,
-	33, 1, 41,  9, 49, 17, 57, 25,
-};
-
-static const uint8_t _exp[] = {
-	32,  1,  2,  3,  4,  5,
-	 4,  5,  6,  7,  8,  9,
-	 8,  9, 10, 11, 12, 13,
-	12, 13, 14, 15, 16, 17,
-	16, 17, 18, 19, 20, 21,
-	20, 21, 22, 23, 24, 25,
-	24, 25, 26, 27, 28, 29,
-	28, 29, 30, 31, 32,  1
-};
-
-static const uint8_t _sb[][64] = {
-	{ 0xE, 0x0, 0x4, 0xF, 0xD, 0x7, 0x1, 0x4,
-	  0x2, 0xE, 0xF, 0x2, 0xB, 0xD, 0x8, 0x1,
-	  0x3, 0xA, 0xA, 0x6, 0x6, 0xC, 0xC, 0xB,
-	  0x5, 0x9, 0x9, 0x5, 0x0, 0x3, 0x7, 0x8,
-	  0x4, 0xF, 0x1, 0xC, 0xE, 0x8, 0x8, 0x2,
-	  0xD, 0x4, 0x6, 0x9, 0x2, 0x1, 0xB, 0x7,
-	  0xF, 0x5, 0xC, 0xB, 0x9, 0x3, 0x7, 0xE,
-	  0x3, 0xA, 0xA, 0x0, 0x5, 0x6, 0x0, 0xD
-	},
-	{ 0xF, 0x3, 0x1, 0xD, 0x8, 0x4, 0xE, 0x7,
-	  0x6, 0xF, 0xB, 0x2, 0x3, 0x8, 0x4, 0xE,
-	  0x9, 0xC, 0x7, 0x0, 0x2, 0x1, 0xD, 0xA,
-	  0xC, 0x6, 0x0, 0x9, 0x5, 0xB, 0xA, 0x5,
-	  0x0, 0xD, 0xE, 0x8, 0x7, 0xA, 0xB, 0x1,
-	  0xA, 0x3, 0x4, 0xF, 0xD, 0x4, 0x1, 0x2,
-	  0x5, 0xB, 0x8, 0x6, 0xC, 0x7, 0x6, 0xC,
-	  0x9, 0x0, 0x3, 0x5, 0x2, 0xE, 0xF, 0x9
-	},
-	{ 0xA, 0xD, 0x0, 0x7, 0x9, 0x0, 0xE, 0x9,
-	  0x6, 0x3, 0x3, 0x4, 0xF, 0x6, 0x5, 0xA,
-	  0x1, 0x2, 0xD, 0x8, 0xC, 0x5, 0x7, 0xE,
-	  0xB, 0xC, 0x4, 0xB, 0x2, 0xF, 0x8, 0x1,
-	  0xD, 0x1, 0x6, 0xA, 0x4, 0xD, 0x9, 0x0,
-	  0x8, 0x6, 0xF, 0x9, 0x3, 0x8, 0x0, 0x7,
-	  0xB, 0x4, 0x1, 0xF, 0x2, 0xE, 0xC, 0x3,
-	  0x5, 0xB, 0xA, 0x5, 0xE, 0x2, 0x7, 0xC
-	},
-	{ 0x7, 0xD, 0xD, 0x8, 0xE, 0xB, 0x3, 0x5,
-	  0x0, 0x6, 0x6, 0xF, 0x9, 0x0, 0xA, 0x3,
-	  0x1, 0x4, 0x2, 0x7, 0x8, 0x2, 0x5, 0xC,
-	  0xB, 0x1, 0xC, 0xA, 0x4, 0xE, 0xF, 0x9,
-	  0xA, 0x3, 0x6, 0xF, 0x9, 0x0, 0x0, 0x6,
-	  0xC, 0xA, 0xB, 0x1, 0x7, 0xD, 0xD, 0x8,
-	  0xF, 0x9, 0x1, 0x4, 0x3, 0x5, 0xE, 0xB,
-	  0x5, 0xC, 0x2, 0x7, 0x8, 0x2, 0x4, 0xE
-	},
-	{ 0x2, 0xE, 0xC, 0xB, 0x4, 0x2, 0x1, 0xC,
-	  0x7, 0x4, 0xA, 0x7, 0xB, 0xD, 0x6, 0x1,
-	  0x8, 0x5, 0x5, 0x0, 0x3, 0xF, 0xF, 0xA,
-	  0xD, 0x3, 0x0, 0x9, 0xE, 0x8, 0x9, 0x6,
-	  0x4, 0xB, 0x2, 0x8, 0x1, 0xC, 0xB, 0x7,
-	  0xA, 0x1, 0xD, 0xE, 0x7, 0x2, 0x8, 0xD,
-	  0xF, 0x6, 0x9, 0xF, 0xC, 0x0, 0x5, 0x9,
-	  0x6, 0xA, 0x3, 0x4, 0x0, 0x5, 0xE, 0x3
-	},
-	{ 0xC, 0xA, 0x1, 0xF, 0xA, 0x4, 0xF, 0x2,
-	  0x9, 0x7, 0x2, 0xC, 0x6, 0x9, 0x8, 0x5,
-	  0x0, 0x6, 0xD, 0x1, 0x3, 0xD, 0x4, 0xE,
-	  0xE, 0x0, 0x7, 0xB, 0x5, 0x3, 0xB, 0x8,
-	  0x9, 0x4, 0xE, 0x3, 0xF, 0x2, 0x5, 0xC,
-	  0x2, 0x9, 0x8, 0x5, 0xC, 0xF, 0x3, 0xA,
-	  0x7, 0xB, 0x0, 0xE, 0x4, 0x1, 0xA, 0x7,
-	  0x1, 0x6, 0xD, 0x0, 0xB, 0x8, 0x6, 0xD
-	},
-	{ 0x4, 0xD, 0xB, 0x0, 0x2, 0xB, 0xE, 0x7,
-	  0xF, 0x4, 0x0, 0x9, 0x8, 0x1, 0xD, 0xA,
-	  0x3, 0xE, 0xC, 0x3, 0x9, 0x5, 0x7, 0xC,
-	  0x5, 0x2, 0xA, 0xF, 0x6, 0x8, 0x1, 0x6,
-	  0x1, 0x6, 0x4, 0xB, 0xB, 0xD, 0xD, 0x8,
-	  0xC, 0x1, 0x3, 0x4, 0x7, 0xA, 0xE, 0x7,
-	  0xA, 0x9, 0xF, 0x5, 0x6, 0x0, 0x8, 0xF,
-	  0x0, 0xE, 0x5, 0x2, 0x9, 0x3, 0x2, 0xC
-	},
-	{ 0xD, 0x1, 0x2, 0xF, 0x8, 0xD, 0x4, 0x8,
-	  0x6, 0xA, 0xF, 0x3, 0xB, 0x7, 0x1, 0x4,
-	  0xA, 0xC, 0x9, 0x5, 0x3, 0x6, 0xE, 0xB,
-	  0x5, 0x0, 0x0, 0xE, 0xC, 0x9, 0x7, 0x2,
-	  0x7, 0x2, 0xB, 0x1, 0x4, 0xE, 0x1, 0x7,
-	  0x9, 0x4, 0xC, 0xA, 0xE, 0x8, 0x2, 0xD,
-	  0x0, 0xF, 0x6, 0xC, 0xA, 0x9, 0xD, 0x0,
-	  0xF, 0x3, 0x3, 0x5, 0x5, 0x6, 0x8, 0xB
-	}
-};
-
 /* System S seems to use a different S-box table */
 static const uint8_t _ss_sb[] = {
 	0xEC,0x16,0x6E,0x46,0x3B,0x96,0x70,0x32,0x54,0x20,0x4F,0x78,0x5A,0x4D,0x01,0xC1,
@@ -235,40 +114,6 @@ static const uint8_t _ss_data[] = {
 	0x89, 0xAB, 0xCD, 0xEF, 0xFE, 0xDC, 0xBA, 0x98
 };
 
-static const uint8_t _perm[] = {
-	16,  7, 20, 21,
-	29, 12, 28, 17,
-	 1, 15, 23, 26,
-	 5, 18, 31, 10,
-	 2,  8, 24, 14,
-	32, 27,  3,  9,
-	19, 13, 30,  6,
-	22, 11,  4, 25
-};
-
-/* Inverse PC1 table */
-static const uint8_t _ipc1[] = {
-	8, 16, 24, 56, 52, 44, 36, 57, 
-	7, 15, 23, 55, 51, 43, 35, 58, 
-	6, 14, 22, 54, 50, 42, 34, 59, 
-	5, 13, 21, 53, 49, 41, 33, 60, 
-	4, 12, 20, 28, 48, 40, 32, 61, 
-	3, 11, 19, 27, 47, 39, 31, 62, 
-	2, 10, 18, 26, 46, 38, 30, 63, 
-	1,  9, 17, 25, 45, 37, 29, 64
-};
-
-static const uint8_t _pc2[] = {
-	14, 17, 11, 24,  1,  5,
-	 3, 28, 15,  6, 21, 10,
-	23, 19, 12,  4, 26,  8,
-	16,  7, 27, 20, 13,  2,
-	41, 52, 31, 37, 47, 55,
-	30, 40, 51, 45, 33, 48,
-	44, 49, 39, 56, 34, 53,
-	46, 42, 50, 36, 29, 32
-};
-
 /* Triple DES key map table */
 static const uint8_t _tdesmap[4][2] = {
 	{ 0x00, 0x01 }, /* Index C */
@@ -277,33 +122,8 @@ static const uint8_t _tdesmap[4][2] = {
 	{ 0x03, 0x00 }  /* Index F */
 };
 
-static const uint8_t _lshift[] = {
-	1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1
-};
-
 static uint8_t flag = 0;
 
-static void _permute_ec(uint8_t *data, const uint8_t *pr, int n)
-{
-	uint8_t pin[8];
-	int i, j, k, t;
-	
-	for(i = 0, k = 0; k < n; i++)
-	{
-		int p = 0;
-		
-		for(j = 7; j >= 0; j--, k++)
-		{
-			t = pr[k] - 1;
-			p = (p << 1) + ((data[t >> 3]) >> (7 - (t & 7)) & 1);
-		}
-		
-		pin[i] = p;
-	}
-	
-	memcpy(data, pin, 8);
-}
-
 uint16_t _get_ec_date(const char *dtm, int mode)
 {
 	int day, mon, year;
@@ -352,87 +172,6 @@ uint16_t _get_ec_date(const char *dtm, int mode)
 	return (date);
 }
 
-static uint64_t _ec_des_f(uint64_t r, uint8_t *k2)
-{
-	int i, k;
-	uint64_t s = 0, result = 0;
-	
-	for(i = 0, k = 0; i < 8; i++)
-	{
-		int j;
-		uint8_t v = 0;
-		
-		/* The expansion E (R1) */
-		for(j = 0; j < 6; j++, k++)
-		{
-			v |= (r >> (32 - _exp[k]) & 1) << (5 - j);
-		}
-		
-		/* Create R2 */
-		v ^= k2[i];
-		
-		/* The S-boxes */
-		s |= (uint64_t) _sb[i][v] << (28 - 4 * i);
-	}
-	
-	/* The permutation P (R3) */
-	for(i = 0; i < 32; i++)
-	{
-		result |= (s >> (32 - _perm[i]) & 1) << (31 - i);
-	}
-	
-	return(result);
-}
-
-static void _key_rotate_ec(uint64_t *c, uint64_t *d, int dir, int iter)
-{
-	int i;
-	
-	/* Rotate left (decryption) */
-	if(dir == ENCRYPT)
-	{
-		for(i = 0; i < _lshift[iter]; i++)
-		{
-			*c = ((*c << 1) ^ (*c >> 27)) & 0xFFFFFFFL;
-			*d = ((*d << 1) ^ (*d >> 27)) & 0xFFFFFFFL;
-		}
-	}
-	/* Rotate right (encryption) */
-	else
-	{
-		for(i = 0; i < _lshift[15 - iter]; i++)
-		{
-			*c = ((*c >> 1) ^ (*c << 27)) & 0xFFFFFFFL;
-			*d = ((*d >> 1) ^ (*d << 27)) & 0xFFFFFFFL;
-		}
-	}
-}
-
-static void _key_exp(uint64_t *c, uint64_t *d, uint8_t *k2)
-{
-	int j, k;
-	
-	/* Key expansion */
-	for(j = 0, k = 0; j < 8; j++)
-	{
-		int t;
-		
-		k2[j] = 0;
-		
-		for(t = 0; t < 6; t++, k++)
-		{
-			if(_pc2[k] < 29)
-			{
-				k2[j] |= (*c >> (28 - _pc2[k]) & 1) << (5 - t);
-			}
-			else
-			{
-				k2[j] |= (*d >> (56 - _pc2[k]) & 1) << (5 - t);
-			}
-		}
-	}
-}
-
 static void _eurocrypt_system_s(uint8_t *in, const uint8_t *k)
 {
 	int d, i, round, pl_byte, y;
@@ -521,135 +260,105 @@ static void _eurocrypt_system_s(uint8_t *in, const uint8_t *k)
 	memcpy(in, data, 39);
 }
 
-static void _eurocrypt(uint8_t *data, const uint8_t *key, int desmode, int des_algo, int rnd)
+void eurocrypt_key(des_key_t *ks, const uint8_t *key)
 {
-	int i;
-	uint64_t r, l, c, d, s;
+	uint32_t c, d;
 	
-	/* Key preparation. Split key into two halves */
-	c = ((uint64_t) key[0] << 20)
-	  ^ ((uint64_t) key[1] << 12)
-	  ^ ((uint64_t) key[2] << 4)
-	  ^ ((uint64_t) key[3] >> 4);
+	/* Keys are stored already permuted by PC1. Split key into two halves */
+	c = ((uint32_t) key[0] << 20)
+	  ^ ((uint32_t) key[1] << 12)
+	  ^ ((uint32_t) key[2] << 4)
+	  ^ ((uint32_t) key[3] >> 4);
 	
-	d = ((uint64_t) (key[3] & 0x0F) << 24)
-	  ^ ((uint64_t) key[4] << 16)
-	  ^ ((uint64_t) key[5] << 8)
-	  ^ ((uint64_t) key[6] << 0);
+	d = ((uint32_t) (key[3] & 0x0F) << 24)
+	  ^ ((uint32_t) key[4] << 16)
+	  ^ ((uint32_t) key[5] << 8)
+	  ^ ((uint32_t) key[6] << 0);
 	
-	/* Initial permutation for Eurocrypt S2/3DES  - always do this */
-	if(des_algo != EC_M)
-	{
-		_permute_ec(data, _ip, 64);
-	}
+	des_key_cd(ks, c, d);
+}
+
+void eurocrypt_crypt(uint8_t *data, const des_key_t *ks, int desmode, int des_algo)
+{
+	int i, dir;
+	uint64_t x;
+	uint32_t r, l, s;
 	
-	/* Control word preparation. Split CW into two halves. */
-	for(i = 3, l = 0, r = 0; i >= 0; i--)
+	for(x = i = 0; i < 8; i++)
 	{
-		l ^= (uint64_t) data[3 - i] << (8 * i);
-		r ^= (uint64_t) data[7 - i] << (8 * i);
+		x = (x << 8) | data[i];
 	}
 	
-	/* 16 iterations */
-	for(i = 0; i < 16; i++)
+	switch(des_algo)
 	{
-		uint64_t r3;
-		uint8_t k2[8];
-		switch (des_algo) {
-			/* If mode is not valid, abort -- this is a bug! */
-			default:
-				fprintf(stderr, "_eurocrypt: BUG: invalid encryption mode!!!\n");
-				assert(0);
-				break;
-
-			/* EC-M */
-			case EC_M:
-			case EC_S:
-				{
-					if(desmode == HASH)
-					{
-						_key_rotate_ec(&c, &d, ENCRYPT, i);
-					}
-					
-					/* Key expansion */
-					_key_exp(&c, &d, k2);
-					
-					/* One DES round */
-					s = _ec_des_f(r, k2);
-					
-					if(desmode != HASH)
-					{
-						_key_rotate_ec(&c, &d, DECRYPT, i);
-					}
-					
-					/* Swap first two bytes if it's a hash routine */
-					if(desmode == HASH)
-					{
-						s = ((s >> 8) & 0xFF0000L) | ((s << 8) & 0xFF000000L) | (s & 0x0000FFFFL);
-					}
-				}
-				break;
-
-			/* EC-S2 */
-			case EC_S2:
-				{
-					/* Key rotation */
-					_key_rotate_ec(&c, &d, ENCRYPT, i);
-					
-					/* Key expansion */
-					_key_exp(&c, &d, k2);
-					
-					/* One DES round */
-					s = _ec_des_f(r, k2);
-				}
-				break;
-
-			/* EC-3DES */
-			case EC_3DES:
+		/* If mode is not valid, abort -- this is a bug! */
+		default:
+			fprintf(stderr, "eurocrypt_crypt: BUG: invalid encryption mode!!!\n");
+			assert(0);
+			return;
+		
+		/* EC-3DES: two key EDE, the second key is used on the second round */
+		case EC_3DES:
+			x = des3_crypt(&ks[0], &ks[1], x, DES_ENCRYPT);
+			break;
+		
+		/* EC-S2 */
+		case EC_S2:
+			x = des_crypt(&ks[0], x, DES_ENCRYPT);
+			break;
+		
+		/* EC-M and EC-S: Hashes encrypt, CWs decrypt */
+		case EC_M:
+		case EC_S:
+			dir = desmode == HASH ? DES_ENCRYPT : DES_DECRYPT;
+			
+			/* EC-M has no initial permutation */
+			if(des_algo != EC_M)
+			{
+				x = des_ip(x);
+			}
+			
+			l = x >> 32;
+			r = x & 0xFFFFFFFF;
+			
+			/* 16 iterations */
+			for(i = 0; i < 16; i++)
+			{
+				/* One DES round */
+				s = des_f(r, ks->k[dir == DES_ENCRYPT ? i : 15 - i]);
+				
+				/* Swap first two bytes if it's a hash routine */
+				if(desmode == HASH)
 				{
-					/* Key rotation */
-					if(rnd != 2)
-					{
-						_key_rotate_ec(&c, &d, ENCRYPT, i);
-					}
-					
-					/* Key expansion */
-					_key_exp(&c, &d, k2);
-					
-					/* One DES round */
-					s = _ec_des_f(r, k2);
-					
-					if(rnd == 2)
-					{
-						_key_rotate_ec(&c, &d, DECRYPT, i);
-					}
+					s = ((s >> 8) & 0xFF0000) | ((s << 8) & 0xFF000000) | (s & 0x0000FFFF);
 				}
-				break;
-		}
-		
-		/* Rotate halves around */
-		r3 = l ^ s;
-		l = r;
-		r = r3;
-	}
-	
-	/* Put everything together */
-	for(i = 3; i >= 0; i--)
-	{
-		data[3 - i] = r >> (8 * i);
-		data[7 - i] = l >> (8 * i);
+				
+				/* Rotate halves around */
+				s ^= l;
+				l = r;
+				r = s;
+			}
+			
+			/* Put everything together */
+			x = (uint64_t) r << 32 | l;
+			
+			if(des_algo != EC_M)
+			{
+				x = des_fp(x);
+			}
+			
+			break;
 	}
 	
-	/* Final permutation for Eurocrypt S2/3DES */
-	if(des_algo != EC_M)
+	for(i = 7; i >= 0; i--, x >>= 8)
 	{
-		_permute_ec(data, _ipp, 64);
+		data[i] = x & 0xFF;
 	}
 }
 
-static void _calc_ec_hash(uint8_t *hash, uint8_t *msg, int mode, int msglen, const uint8_t *key)
+static void _calc_ec_hash(uint8_t *hash, uint8_t *msg, int mode, int msglen, const des_key_t *ks)
 {
-	int i, r;
+	int i;
 	
 	/* Iterate through data */
 	for(i = 0; i < msglen; i++)
@@ -658,19 +367,14 @@ static void _calc_ec_hash(uint8_t *hash, uint8_t *msg, int mode, int msglen, con
 		
 		if(i % 8 == 7)
 		{
-			/* Three rounds for 3DES mode, one round for others */
-			for(r = 0; r < (mode != EC_3DES ? 1 : 3); r++) 
-			{
-				/* Use second key on second round in 3DES */
-				_eurocrypt(hash, key + (r != 1 ? 0 : 8), HASH, mode, r + 1);
-			}
+			eurocrypt_crypt(hash, ks, HASH, mode);
 		}
 	}
 	
 	/* Final interation - EC-M only */
 	if(mode == EC_M)
 	{
-		_eurocrypt(hash, key, HASH, mode, 1);
+		eurocrypt_crypt(hash, ks, HASH, mode);
 	}
 }
 
@@ -711,7 +415,7 @@ static void _build_ecm_hash_data(uint8_t *hash, const eurocrypt_t *e, int x)
 	}
 	
 	/* Calculate hash */
-	_calc_ec_hash(hash, msg, e->mode->des_algo, msglen, e->mode->key);
+	_calc_ec_hash(hash, msg, e->mode->des_algo, msglen, e->ks);
 }
 
 static void _build_emmg_hash_data(uint8_t *hash, eurocrypt_t *e, int x)
@@ -727,7 +431,7 @@ static void _build_emmg_hash_data(uint8_t *hash, eurocrypt_t *e, int x)
 	
 	/* Copy entitlements into data buffer */
 	memcpy(msg, e->emmg_pkt + 8, x); msglen += x - 10;
-	_calc_ec_hash(hash, msg, e->mode->des_algo, msglen, e->emmode->key);
+	_calc_ec_hash(hash, msg, e->mode->des_algo, msglen, e->emks);
 }
 
 static void _build_emms_hash_data(uint8_t *hash, eurocrypt_t *e)
@@ -749,7 +453,7 @@ static void _build_emms_hash_data(uint8_t *hash, eurocrypt_t *e)
 		hash[7] = e->emmode->sa[0];
 		
 		/* Do the initial hashing of the buffer */
-		_eurocrypt(hash, e->emmode->key, HASH, e->mode->des_algo, 1);
+		eurocrypt_crypt(hash, e->emks, HASH, e->mode->des_algo);
 		
 		/* Copy ADF into data buffer */
 		msg[msglen++] = 0x9e;
@@ -757,7 +461,7 @@ static void _build_emms_hash_data(uint8_t *hash, eurocrypt_t *e)
 		memcpy(msg + msglen, e->emms_pkt + 6, 32); msglen += 32;
 		
 		/* Hash it */
-		_calc_ec_hash(hash, msg, e->mode->des_algo, msglen, e->emmode->key);
+		_calc_ec_hash(hash, msg, e->mode->des_algo, msglen, e->emks);
 		
 		msglen = 0;
 		
@@ -772,7 +476,7 @@ static void _build_emms_hash_data(uint8_t *hash, eurocrypt_t *e)
 	}
 	
 	/* Final hash */
-	_calc_ec_hash(hash, msg, e->emmode->des_algo, msglen, e->emmode->key);
+	_calc_ec_hash(hash, msg, e->emmode->des_algo, msglen, e->emks);
 }
 
 char *_get_sub_date(int b, const char *date)
@@ -819,8 +523,9 @@ char *_get_sub_date(int b, const char *date)
 
 static void _encrypt_opkey(uint8_t *data, eurocrypt_t *e, int t)
 {
-	int r;
+	int i;
 	uint8_t emm[sizeof(e->mode->key)];
+	uint64_t k;
 	
 	/* Pick the right key */
 	if(e->mode->des_algo == EC_3DES)
@@ -835,32 +540,29 @@ static void _encrypt_opkey(uint8_t *data, eurocrypt_t *e, int t)
 	/* Do inverse permuted choice permutation for EC-S2/3DES keys */
 	if(e->emmode->des_algo != EC_M) 
 	{
-		_permute_ec(emm, _ipc1, 64);
+		for(k = i = 0; i < 8; i++)
+		{
+			k = (k << 8) | emm[i];
+		}
+		
+		k = des_pc1_inverse(k);
+		
+		for(i = 7; i >= 0; i--, k >>= 8)
+		{
+			emm[i] = k & 0xFF;
+		}
 	}
-
 	
-	/* Three rounds for 3DES mode, one round for others */
-	for(r = 0; r < (e->emmode->des_algo != EC_3DES ? 1 : 3); r++)
-	{
-		/* Use second key on second round in 3DES */
-		_eurocrypt(emm, e->emmode->key + (r != 1 ? 0 : 8), ECM, e->emmode->des_algo, r + 1);
-	}
+	eurocrypt_crypt(emm, e->emks, ECM, e->emmode->des_algo);
 	
 	memcpy(data, emm, 8);
 }
 
 static void _encrypt_date(uint8_t *outdata, eurocrypt_t *e, uint8_t indata[8])
 {
-	int r;
-
 	if(e->emmode->des_algo == EC_3DES)
 	{
-		/* Three rounds for 3DES mode, one round for others */
-		for(r = 0; r < (e->emmode->des_algo != EC_3DES ? 1 : 3); r++)
-		{
-			/* Use second key on second round in 3DES */
-			_eurocrypt(indata, e->emmode->key + (r != 1 ? 0 : 8), ECM, e->emmode->des_algo, r + 1);
-		}
+		eurocrypt_crypt(indata, e->emks, ECM, e->emmode->des_algo);
 	}
 	
 	memcpy(outdata, indata, 8);
@@ -1055,7 +757,7 @@ static void _build_emmu_hash_data(uint8_t *hash, eurocrypt_t *e, int x)
 	memcpy(msg + msglen, e->emmu_pkt + 28, 0x06); msglen += 0x06;
 	memcpy(msg + msglen, e->emmu_pkt + 38, 0x02); msglen += 0x02;
 	
-	_calc_ec_hash(hash, msg, e->emmode->des_algo, msglen, e->emmode->key);
+	_calc_ec_hash(hash, msg, e->emmode->des_algo, msglen, e->emks);
 }
 
 static uint8_t _update_emmu_packet_system_s(eurocrypt_t *e, int t)
@@ -1508,7 +1210,7 @@ static uint8_t _update_emmgs_packet(eurocrypt_t *e, int t)
 static uint64_t _update_cw(eurocrypt_t *e, int t)
 {
 	uint64_t cw;
-	int i, r;
+	int i;
 	
 	/* Fetch the next active CW */
 	for(cw = i = 0; i < 8; i++)
@@ -1527,12 +1229,7 @@ static uint64_t _update_cw(eurocrypt_t *e, int t)
 	/* EC-S uses a home-brew encryption */
 	if(e->mode->des_algo != EC_S)
 	{
-		/* Three rounds for 3DES mode, one round for others */
-		for(r = 0; r < (e->mode->des_algo != EC_3DES ? 1 : 3); r++)
-		{
-			/* Use second key on second round in 3DES */
-			_eurocrypt(e->ecw[t], e->mode->key + (r != 1 ? 0 : 8), ECM, e->mode->des_algo, r + 1);
-		}
+		eurocrypt_crypt(e->ecw[t], e->ks, ECM, e->mode->des_algo);
 	}
 		
 	return(cw);
@@ -1786,6 +1483,12 @@ int eurocrypt_init(vid_t *vid, const char *mode)
 		fprintf(stderr, "Cannot find a matching EMM mode.\n");
 	}
 	
+	/* Expand the ECM and EMM keys. The second key is only used by 3DES */
+	eurocrypt_key(&e->ks[0], e->mode->key);
+	eurocrypt_key(&e->ks[1], e->mode->key + 8);
+	eurocrypt_key(&e->emks[0], e->emmode->key);
+	eurocrypt_key(&e->emks[1], e->emmode->key + 8);
+	
 	/* ECM/EMM address */
 	e->ecm_addr = 346;
 	e->emm_addr = 347;
@@ -25,6 +25,16 @@
 #define EMMC 0xC7
 #define EMMG 0x3F
 
+/* Cipher modes */
+#define ECM  0
+#define HASH 1
+
+/* Eurocrypt algorithms */
+#define EC_M    0x20
+#define EC_S    0x01
+#define EC_S2   0x30
+#define EC_3DES 0x31
+
 typedef struct {
 	const char *id;   /* Mode id */
 	int des_algo;     /* Eurocrypt M or S2 algo */
@@ -52,6 +62,10 @@ typedef struct {
 	const ec_mode_t *mode;
 	const em_mode_t *emmode;
 	
+	/* Expanded ECM and EMM key schedules */
+	des_key_t ks[2];
+	des_key_t emks[2];
+	
 	/* Encrypted even and odd control words */
 	uint8_t ecw[2][8];
 	
@@ -82,5 +96,10 @@ typedef struct {
 extern int eurocrypt_init(vid_t *s, const char *mode);
 extern void eurocrypt_next_frame(vid_t *s, int frame);
 
+/* The Eurocrypt block cipher, for 8 bytes of data. ks holds the two
+ * key schedules from eurocrypt_key(), the second only used by 3DES */
+extern void eurocrypt_key(des_key_t *ks, const uint8_t *key);
+extern void eurocrypt_crypt(uint8_t *data, const des_key_t *ks, int desmode, int des_algo);
+
 #endif
 
@@ -15,12 +15,146 @@
 /* You should have received a copy of the GNU General Public License     */
 /* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
 
+#include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <pthread.h>
+#include "common.h"
 #include "fifo.h"
 
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+static void _block_wake(fifo_block_t *block)
+{
+	__atomic_add_fetch(&block->seq, 1, __ATOMIC_SEQ_CST);
+	
+	/* Skip the system call if nobody is waiting */
+	if(__atomic_load_n(&block->waiters, __ATOMIC_SEQ_CST) == 0)
+	{
+		return;
+	}
+	
+#ifdef __linux__
+	syscall(SYS_futex, &block->seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+	pthread_mutex_lock(&block->mutex);
+	pthread_cond_broadcast(&block->cond);
+	pthread_mutex_unlock(&block->mutex);
+#endif
+}
+
+static void _block_sleep(fifo_block_t *block, uint32_t seq)
+{
+	/* Returns early if the block has changed since seq was read */
+#ifdef __linux__
+	syscall(SYS_futex, &block->seq, FUTEX_WAIT_PRIVATE, seq, NULL, NULL, 0);
+#else
+	pthread_mutex_lock(&block->mutex);
+	
+	while(__atomic_load_n(&block->seq, __ATOMIC_SEQ_CST) == seq)
+	{
+		pthread_cond_wait(&block->cond, &block->mutex);
+	}
+	
+	pthread_mutex_unlock(&block->mutex);
+#endif
+}
+
+/* Block has been written to, or marks the end of the stream */
+static int _block_readable(fifo_block_t *block)
+{
+	return(__atomic_load_n(&block->writing, __ATOMIC_SEQ_CST) == 0 ||
+	       __atomic_load_n(&block->length, __ATOMIC_SEQ_CST) == 0);
+}
+
+/* Block has no readers and can be written to */
+static int _block_writable(fifo_block_t *block)
+{
+	return(__atomic_load_n(&block->readers, __ATOMIC_SEQ_CST) == 0);
+}
+
+static void _block_wait(fifo_block_t *block, int (*ready)(fifo_block_t *), fifo_stats_t *stats)
+{
+	int64_t t;
+	uint32_t seq;
+	
+	if(ready(block)) return;
+	
+	/* Only timed when actually waiting */
+	t = time_ns();
+	
+	/* The waiter count is raised before the state is checked again,
+	 * so a thread changing the state will always see it and wake
+	 * us, or we will see the new state */
+	__atomic_add_fetch(&block->waiters, 1, __ATOMIC_SEQ_CST);
+	
+	while(1)
+	{
+		seq = __atomic_load_n(&block->seq, __ATOMIC_SEQ_CST);
+		if(ready(block)) break;
+		_block_sleep(block, seq);
+	}
+	
+	__atomic_sub_fetch(&block->waiters, 1, __ATOMIC_SEQ_CST);
+	
+	stats->waits++;
+	stats->wait_time += time_ns() - t;
+}
+
+static void _block_set(int *v, int value, fifo_block_t *block)
+{
+	__atomic_store_n(v, value, __ATOMIC_SEQ_CST);
+	_block_wake(block);
+}
+
+static int _span_add(fifo_span_t *spans, int *n, void *base, size_t length)
+{
+	/* The blocks are allocated together, so neighbouring
+	 * blocks can be merged into one span */
+	if(*n > 0 && (uint8_t *) spans[*n - 1].base + spans[*n - 1].length == base)
+	{
+		spans[*n - 1].length += length;
+		return(1);
+	}
+	
+	if(*n == 2) return(0);
+	
+	spans[*n].base = base;
+	spans[*n].length = length;
+	(*n)++;
+	
+	return(1);
+}
+
+static void _reader_update_stats(fifo_reader_t *reader, fifo_block_t *block)
+{
+	fifo_t *fifo = reader->fifo;
+	fifo_block_t *writer = __atomic_load_n(&fifo->block, __ATOMIC_RELAXED);
+	size_t fill, bin;
+	
+	/* Complete blocks queued behind this one. The writer may not
+	 * have moved on yet from the block it just released */
+	fill = ((writer - fifo->blocks) - (block - fifo->blocks) + fifo->count) % fifo->count;
+	if(fill > 0) fill--;
+	
+	bin = fill * FIFO_STATS_BINS / fifo->count;
+	if(bin >= FIFO_STATS_BINS) bin = FIFO_STATS_BINS - 1;
+	
+	reader->stats.fill[bin]++;
+	reader->stats.blocks++;
+	
+	if(fill < reader->stats.min_fill)
+	{
+		reader->stats.min_fill = fill;
+	}
+}
+
 int fifo_init(fifo_t *fifo, size_t count, size_t length)
 {
 	int i;
@@ -45,8 +179,12 @@ int fifo_init(fifo_t *fifo, size_t count, size_t length)
 	
 	for(i = 0; i < count; i++)
 	{
+#ifndef __linux__
 		pthread_mutex_init(&fifo->blocks[i].mutex, NULL);
 		pthread_cond_init(&fifo->blocks[i].cond, NULL);
+#endif
+		fifo->blocks[i].seq = 0;
+		fifo->blocks[i].waiters = 0;
 		fifo->blocks[i].readers = 0;
 		fifo->blocks[i].writing = 1;
 		fifo->blocks[i].data = (uint8_t *) fifo->blocks->data + (length * i);
@@ -60,18 +198,24 @@ int fifo_init(fifo_t *fifo, size_t count, size_t length)
 	fifo->block->writing = 1;
 	fifo->offset = 0;
 	
+	memset(&fifo->stats, 0, sizeof(fifo_stats_t));
+	
 	return(0);
 }
 
 void fifo_reader_init(fifo_reader_t *reader, fifo_t *fifo, int prefill)
 {
 	/* Readers start on the last (empty) block, waiting for the writer */
+	reader->fifo = fifo;
 	reader->block = fifo->block->prev;
-	reader->block->readers++;
+	__atomic_add_fetch(&reader->block->readers, 1, __ATOMIC_SEQ_CST);
 	reader->offset = reader->block->length;
 	reader->eof = 0;
 	reader->prefill = NULL;
 	
+	memset(&reader->stats, 0, sizeof(fifo_stats_t));
+	reader->stats.min_fill = fifo->count;
+	
 	if(prefill != 0)
 	{
 		/* The prefill block cannot be either of the last two blocks */
@@ -87,10 +231,8 @@ void fifo_reader_close(fifo_reader_t *reader)
 	
 	if(reader->block != NULL && reader->eof == 0)
 	{
-		pthread_mutex_lock(&block->mutex);
-		block->readers--;
-		pthread_cond_signal(&block->cond);
-		pthread_mutex_unlock(&block->mutex);
+		__atomic_sub_fetch(&block->readers, 1, __ATOMIC_SEQ_CST);
+		_block_wake(block);
 		
 		reader->block = NULL;
 		reader->eof = 1;
@@ -103,33 +245,24 @@ void fifo_close(fifo_t *fifo)
 	
 	if(block == NULL) return;
 	
-	block->length = fifo->offset;
+	__atomic_store_n(&block->length, fifo->offset, __ATOMIC_SEQ_CST);
 	
 	if(block->length > 0)
 	{
 		fifo_block_t *next = block->next;
 		
-		pthread_mutex_lock(&next->mutex);
-		
 		/* Wait for the next block to be read */
-		while(next->readers > 0)
-		{
-			pthread_cond_wait(&next->cond, &next->mutex);
-		}
+		_block_wait(next, _block_writable, &fifo->stats);
 		
-		next->writing = 0;
-		next->length = 0;
-		
-		pthread_mutex_unlock(&next->mutex);
+		/* Mark it as the end of the stream */
+		__atomic_store_n(&next->length, 0, __ATOMIC_SEQ_CST);
+		_block_set(&next->writing, 0, next);
 	}
 	
 	/* Mark current block as ready */
-	pthread_mutex_lock(&block->mutex);
-	block->writing = 0;
-	pthread_cond_signal(&block->cond);
-	pthread_mutex_unlock(&block->mutex);
+	_block_set(&block->writing, 0, block);
 	
-	fifo->block = (block->length == 0 ? block : block->next);
+	__atomic_store_n(&fifo->block, block->length == 0 ? block : block->next, __ATOMIC_RELAXED);
 	fifo->offset = 0;
 }
 
@@ -147,27 +280,22 @@ void fifo_free(fifo_t *fifo)
 	/* TODO: Wait for all readers to end */
 	while(block->length > 0)
 	{
-		pthread_mutex_lock(&block->mutex);
-		
-		while(block->readers > 0)
-		{
-			pthread_cond_wait(&block->cond, &block->mutex);
-		}
+		_block_wait(block, _block_writable, &fifo->stats);
 		
-		block->writing = 0;
-		block->length = 0;
-		
-		pthread_mutex_unlock(&block->mutex);
+		__atomic_store_n(&block->length, 0, __ATOMIC_SEQ_CST);
+		_block_set(&block->writing, 0, block);
 		
 		block = block->next;
 	}
 	
 	/* Tear down the FIFO */
+#ifndef __linux__
 	for(int i = 0; i < fifo->count; i++)
 	{
 		pthread_cond_destroy(&fifo->blocks[i].cond);
 		pthread_mutex_destroy(&fifo->blocks[i].mutex);
 	}
+#endif
 	
 	free(fifo->blocks->data);
 	free(fifo->blocks);
@@ -187,25 +315,17 @@ size_t fifo_read(fifo_reader_t *reader, void **ptr, size_t length, int wait)
 	
 	if(reader->prefill)
 	{
-		pthread_mutex_lock(&reader->prefill->mutex);
-		
 		if(wait)
 		{
-			/* Wait until the next block is written to */
-			while(reader->prefill->writing == 1 && reader->prefill->length != 0)
-			{
-				pthread_cond_wait(&reader->prefill->cond, &reader->prefill->mutex);
-			}
+			/* Wait until the prefill block is written to */
+			_block_wait(reader->prefill, _block_readable, &reader->stats);
 		}
-		else if(reader->prefill->writing == 1 && reader->prefill->length != 0)
+		else if(!_block_readable(reader->prefill))
 		{
 			/* Non-blocking */
-			pthread_mutex_unlock(&reader->prefill->mutex);
 			return(0);
 		}
 		
-		pthread_mutex_unlock(&reader->prefill->mutex);
-		
 		reader->prefill = NULL;
 	}
 	
@@ -213,39 +333,34 @@ size_t fifo_read(fifo_reader_t *reader, void **ptr, size_t length, int wait)
 	{
 		fifo_block_t *next = block->next;
 		
-		pthread_mutex_lock(&next->mutex);
-		
 		if(wait)
 		{
 			/* Wait until the next block is written to */
-			while(next->writing == 1 && next->length != 0)
-			{
-				pthread_cond_wait(&next->cond, &next->mutex);
-			}
+			_block_wait(next, _block_readable, &reader->stats);
 		}
-		else if(next->writing == 1 && next->length != 0)
+		else if(!_block_readable(next))
 		{
 			/* Non-blocking */
-			pthread_mutex_unlock(&next->mutex);
+			reader->stats.empty++;
 			return(0);
 		}
 		
-		if(next->length == 0)
+		if(__atomic_load_n(&next->length, __ATOMIC_SEQ_CST) == 0)
 		{
 			/* End of stream */
 			reader->eof = 1;
 		}
 		else
 		{
-			next->readers++;
+			/* The writer cannot reach this block until the
+			 * count on the current block has been released */
+			__atomic_add_fetch(&next->readers, 1, __ATOMIC_SEQ_CST);
+			
+			_reader_update_stats(reader, next);
 		}
 		
-		pthread_mutex_unlock(&next->mutex);
-		
-		pthread_mutex_lock(&block->mutex);
-		block->readers--;
-		pthread_cond_signal(&block->cond);
-		pthread_mutex_unlock(&block->mutex);
+		__atomic_sub_fetch(&block->readers, 1, __ATOMIC_SEQ_CST);
+		_block_wake(block);
 		
 		/* Move to the next block */
 		reader->block = block = next;
@@ -279,34 +394,28 @@ size_t fifo_write_ptr(fifo_t *fifo, void **ptr, int wait)
 	{
 		fifo_block_t *next = block->next;
 		
-		pthread_mutex_lock(&next->mutex);
-		
 		if(wait)
 		{
 			/* Wait for the next block to be read */
-			while(next->readers > 0)
-			{
-				pthread_cond_wait(&next->cond, &next->mutex);
-			}
+			_block_wait(next, _block_writable, &fifo->stats);
 		}
-		else if(next->readers > 0)
+		else if(!_block_writable(next))
 		{
-			pthread_mutex_unlock(&next->mutex);
 			return(0);
 		}
 		
-		next->writing = 1;
-		
-		pthread_mutex_unlock(&next->mutex);
+		/* Claim the next block before releasing the current
+		 * one, so readers never see it as ready early */
+		__atomic_store_n(&next->writing, 1, __ATOMIC_SEQ_CST);
 		
 		/* Mark current block as ready */
-		pthread_mutex_lock(&block->mutex);
-		block->writing = 0;
-		pthread_cond_signal(&block->cond);
-		pthread_mutex_unlock(&block->mutex);
+		_block_set(&block->writing, 0, block);
 		
-		fifo->block = block = next;
+		/* Readers look at the writer's position for their stats */
+		__atomic_store_n(&fifo->block, next, __ATOMIC_RELAXED);
+		block = next;
 		fifo->offset = 0;
+		fifo->stats.blocks++;
 	}
 	
 	*ptr = (uint8_t *) block->data + fifo->offset;
@@ -319,3 +428,167 @@ void fifo_write(fifo_t *fifo, size_t length)
 	fifo->offset += length;
 }
 
+size_t fifo_read_span(fifo_reader_t *reader, fifo_span_t spans[2], size_t length, int wait)
+{
+	fifo_block_t *block;
+	size_t offset, total, l;
+	void *ptr;
+	int n = 0;
+	
+	spans[0] = spans[1] = (fifo_span_t) { NULL, 0 };
+	
+	/* Let fifo_read() handle the prefill and step onto
+	 * the next block, reading nothing */
+	l = fifo_read(reader, &ptr, 0, wait);
+	if(l == -1) return(-1);
+	
+	block = reader->block;
+	offset = reader->offset;
+	
+	if(offset == block->length)
+	{
+		/* Nothing ready */
+		return(0);
+	}
+	
+	for(total = 0; total < length; total += l, offset += l)
+	{
+		if(offset == block->length)
+		{
+			fifo_block_t *next = block->next;
+			
+			/* Continue into blocks that are already complete. The
+			 * count held on the reader's own block stops the writer
+			 * reaching any of them */
+			if(!_block_readable(next) || next->length == 0) break;
+			
+			block = next;
+			offset = 0;
+		}
+		
+		l = block->length - offset;
+		if(l > length - total) l = length - total;
+		
+		if(!_span_add(spans, &n, (uint8_t *) block->data + offset, l)) break;
+	}
+	
+	return(total);
+}
+
+void fifo_read_commit(fifo_reader_t *reader, size_t length)
+{
+	void *ptr;
+	size_t l;
+	
+	/* The blocks are known to be ready, so this never waits */
+	while(length > 0)
+	{
+		l = fifo_read(reader, &ptr, length, 0);
+		if(l == 0 || l == -1) break;
+		
+		length -= l;
+	}
+}
+
+size_t fifo_write_span(fifo_t *fifo, fifo_span_t spans[2], size_t length, int wait)
+{
+	fifo_block_t *block;
+	size_t offset, total, l;
+	void *ptr;
+	int n = 0;
+	
+	spans[0] = spans[1] = (fifo_span_t) { NULL, 0 };
+	
+	/* Let fifo_write_ptr() move onto the next block if needed */
+	l = fifo_write_ptr(fifo, &ptr, wait);
+	if(l == -1 || l == 0) return(l);
+	
+	block = fifo->block;
+	offset = fifo->offset;
+	
+	for(total = 0; total < length; total += l, offset += l)
+	{
+		if(offset == block->length)
+		{
+			fifo_block_t *next = block->next;
+			
+			/* Continue into blocks no reader is on. Readers
+			 * can only reach them through the writer's block */
+			if(next == fifo->block || !_block_writable(next)) break;
+			
+			block = next;
+			offset = 0;
+		}
+		
+		l = block->length - offset;
+		if(l > length - total) l = length - total;
+		
+		if(!_span_add(spans, &n, (uint8_t *) block->data + offset, l)) break;
+	}
+	
+	return(total);
+}
+
+void fifo_write_commit(fifo_t *fifo, size_t length)
+{
+	void *ptr;
+	size_t l;
+	
+	/* The blocks are known to be free, so this never waits */
+	while(length > 0)
+	{
+		l = fifo_write_ptr(fifo, &ptr, 0);
+		if(l == 0 || l == -1) break;
+		
+		if(l > length) l = length;
+		
+		fifo_write(fifo, l);
+		length -= l;
+	}
+}
+
+void fifo_print_stats(const char *name, fifo_t *fifo)
+{
+	fifo_stats_t *st = &fifo->stats;
+	
+	fprintf(stderr, "  %-14s writer: %llu blocks, waited %llu times for %.3f s\n",
+		name,
+		(unsigned long long) st->blocks,
+		(unsigned long long) st->waits,
+		st->wait_time / 1e9
+	);
+}
+
+void fifo_reader_print_stats(const char *name, fifo_reader_t *reader, double block_time)
+{
+	fifo_stats_t *st = &reader->stats;
+	int i;
+	
+	fprintf(stderr, "  %-14s reader: %llu blocks, %llu empty, waited %llu times for %.3f s\n",
+		name,
+		(unsigned long long) st->blocks,
+		(unsigned long long) st->empty,
+		(unsigned long long) st->waits,
+		st->wait_time / 1e9
+	);
+	
+	if(st->blocks == 0) return;
+	
+	fprintf(stderr, "  %-14s   lowest fill: %zu of %zu blocks", "", st->min_fill, reader->fifo->count);
+	
+	if(block_time > 0)
+	{
+		/* The time left before an underrun at the worst moment */
+		fprintf(stderr, " (%.1f ms)", st->min_fill * block_time * 1000);
+	}
+	
+	fprintf(stderr, "\n  %-14s   fill:", "");
+	
+	for(i = 0; i < FIFO_STATS_BINS; i++)
+	{
+		fprintf(stderr, " %d%%:%.1f%%", i * 100 / FIFO_STATS_BINS, 100.0 * st->fill[i] / st->blocks);
+	}
+	
+	fprintf(stderr, "\n");
+}
+
@@ -18,12 +18,26 @@
 #ifndef _FIFO_H
 #define _FIFO_H
 
-/* Single writer / multi reader FIFO */
+#include <stdint.h>
+#include <pthread.h>
+
+/* Single writer / multi reader FIFO
+ *
+ * The block states are updated with atomic operations. A thread
+ * only sleeps when the block it needs is not ready, on a futex
+ * where available or a condition variable otherwise. */
 
 typedef struct _fifo_block_t {
 	
+	/* Incremented on every state change, and used
+	 * as the futex word by threads waiting on it */
+	uint32_t seq;
+	int waiters;
+	
+#ifndef __linux__
 	pthread_mutex_t mutex;
 	pthread_cond_t cond;
+#endif
 	
 	int readers;
 	int writing;
@@ -35,6 +49,31 @@ typedef struct _fifo_block_t {
 	
 } fifo_block_t;
 
+/* Number of bins in the fill level histogram */
+#define FIFO_STATS_BINS 10
+
+/* Statistics kept for the writer and for each reader */
+typedef struct {
+	
+	/* Number of blocks passed */
+	uint64_t blocks;
+	
+	/* Number of times, and total time in ns, spent waiting on a block */
+	uint64_t waits;
+	int64_t wait_time;
+	
+	/* Readers only. Non-blocking reads that found no data once any
+	 * prefill was complete. For SDR callbacks these are underruns */
+	uint64_t empty;
+	
+	/* Readers only. The number of complete blocks queued behind the
+	 * one being started, sampled on each new block, as a histogram
+	 * of the FIFO length */
+	uint64_t fill[FIFO_STATS_BINS];
+	size_t min_fill;
+	
+} fifo_stats_t;
+
 typedef struct {
 	
 	size_t count;
@@ -43,18 +82,32 @@ typedef struct {
 	fifo_block_t *block;
 	size_t offset;
 	
+	fifo_stats_t stats;
+	
 } fifo_t;
 
 typedef struct {
 	
+	fifo_t *fifo;
 	fifo_block_t *block;
 	size_t offset;
 	
 	int eof;
 	fifo_block_t *prefill;
 	
+	fifo_stats_t stats;
+	
 } fifo_reader_t;
 
+/* A contiguous region of the FIFO. Spans can cover several
+ * blocks, and are split in two where the FIFO wraps */
+typedef struct {
+	
+	void *base;
+	size_t length;
+	
+} fifo_span_t;
+
 /* Initalise and allocate memory for a FIFO.
  *
  * fifo: Pointer to uninitalised FIFO
@@ -104,6 +157,31 @@ extern size_t fifo_write_ptr(fifo_t *fifo, void **ptr, int wait);
 */
 extern void fifo_write(fifo_t *fifo, size_t length);
 
+/* Get pointers to free space in the FIFO, so the data
+ * can be produced in place. Unlike fifo_write_ptr()
+ * this can return space in several blocks at once.
+ *
+ * fifo: Pointer to initalised FIFO
+ * spans: Array of two spans to fill in
+ * length: Maximum number of bytes to return
+ * wait: Set to 1 to wait on a free block
+ *
+ * Returns the total length of the spans, 0 if no
+ * blocks are free and wait == 0, or -1 if the FIFO
+ * is closed.
+ *
+ * Data written is submitted with fifo_write_commit().
+*/
+extern size_t fifo_write_span(fifo_t *fifo, fifo_span_t spans[2], size_t length, int wait);
+
+/* Submit data written to spans returned by fifo_write_span().
+ *
+ * fifo: Pointer to initalised FIFO
+ * length: Number of bytes written, no greater than
+ *         the value returned by fifo_write_span()
+*/
+extern void fifo_write_commit(fifo_t *fifo, size_t length);
+
 /* Initalise a FIFO reader.
  *
  * reader: Pointer to an uninitalised FIFO reader
@@ -137,5 +215,43 @@ extern void fifo_reader_close(fifo_reader_t *reader);
 */
 extern size_t fifo_read(fifo_reader_t *reader, void **ptr, size_t length, int wait);
 
+/* Get pointers to the data available to a reader, without
+ * consuming it. Unlike fifo_read() this can return data
+ * from several blocks at once.
+ *
+ * reader: Pointer to an initalised FIFO reader
+ * spans: Array of two spans to fill in
+ * length: Maximum number of bytes to return
+ * wait: Set to 1 to wait on data being available
+ *
+ * Returns the total length of the spans, which are
+ * filled in order. The second span has a length of 0
+ * if it isn't needed. Returns 0 if wait == 0 and no
+ * data was ready, or -1 if the FIFO reader is closed.
+ *
+ * Data must be consumed with fifo_read_commit().
+*/
+extern size_t fifo_read_span(fifo_reader_t *reader, fifo_span_t spans[2], size_t length, int wait);
+
+/* Consume data returned by fifo_read_span().
+ *
+ * reader: Pointer to an initalised FIFO reader
+ * length: Number of bytes to consume, no greater
+ *         than the value returned by fifo_read_span()
+*/
+extern void fifo_read_commit(fifo_reader_t *reader, size_t length);
+
+/* Print the statistics for the writer or a reader to stderr.
+ *
+ * name: Name to print
+ * block_time: Duration of one block in seconds, used to show
+ *             the lowest fill level as time. 0 to disable.
+ *
+ * Statistics are not synchronised. They should only be
+ * printed once the writer and reader have stopped.
+*/
+extern void fifo_print_stats(const char *name, fifo_t *fifo);
+extern void fifo_reader_print_stats(const char *name, fifo_reader_t *reader, double block_time);
+
 #endif
 
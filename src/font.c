@@ -88,63 +88,326 @@ int font_init(av_t *av, int size, float ratio, void *ctx)
 	return(HACKTV_OK);
 }
 
-static uint32_t _make_transparent(uint32_t a, uint32_t b, float t)
+void font_free(av_font_t *font)
 {
-	int vr, vg, vb;
+	font_glyph_t *g;
+	int i;
+	
+	if(font == NULL) return;
+	
+	for(i = 0; i < FONT_CACHE_SIZE; i++)
+	{
+		free(font->cache[i].text);
+		free(font->cache[i].overlay.pixels);
+	}
+	
+	for(i = 0; i < FONT_GLYPH_BUCKETS; i++)
+	{
+		while((g = font->glyphs[i]) != NULL)
+		{
+			font->glyphs[i] = g->next;
+			free(g->buffer);
+			free(g);
+		}
+	}
+	
+	free(font->canvas);
+	FT_Done_Face(font->fontface);
+	free(font);
+}
+
+static uint32_t _over(uint32_t d, uint32_t colour, int a)
+{
+	uint32_t t, r, g, b;
+	
+	/* Draw colour with coverage a over a premultiplied pixel */
+	t = ((d >> 24)         * (255 - a) + 127) / 255 + a;
+	r = (((d >> 16) & 0xFF) * (255 - a) + ((colour >> 16) & 0xFF) * a + 127) / 255;
+	g = (((d >>  8) & 0xFF) * (255 - a) + ((colour >>  8) & 0xFF) * a + 127) / 255;
+	b = (((d >>  0) & 0xFF) * (255 - a) + ((colour >>  0) & 0xFF) * a + 127) / 255;
+	
+	return(t << 24 | r << 16 | g << 8 | b << 0);
+}
+
+static void _touch(av_font_t *font, int x0, int y0, int x1, int y1)
+{
+	/* Grow the area drawn on the canvas */
+	if(x0 < font->x0) font->x0 = x0;
+	if(y0 < font->y0) font->y0 = y0;
+	if(x1 > font->x1) font->x1 = x1;
+	if(y1 > font->y1) font->y1 = y1;
+}
+
+static font_overlay_t *_cache_find(av_font_t *font, const font_overlay_t *key)
+{
+	font_overlay_t *e;
+	int i;
+	
+	for(i = 0; i < FONT_CACHE_SIZE; i++)
+	{
+		e = &font->cache[i];
+		
+		if(e->text == NULL ||
+		   e->type != key->type ||
+		   e->bitmap != key->bitmap ||
+		   e->pos_x != key->pos_x ||
+		   e->pos_y != key->pos_y ||
+		   e->shadow != key->shadow ||
+		   e->box != key->box ||
+		   e->colour != key->colour ||
+		   e->transparency != key->transparency ||
+		   e->linesize != key->linesize ||
+		   strcmp(e->text, key->text) != 0)
+		{
+			continue;
+		}
+		
+		e->used = ++font->cache_tick;
+		
+		return(e);
+	}
+	
+	return(NULL);
+}
+
+static int _cache_begin(av_font_t *font, int linesize)
+{
+	size_t size = (size_t) linesize * font->video_height;
 	
-	vr = ((b >> 16) & 0xFF) * t + ((a >> 16) & 0xFF) * (1 - t);
-	vg = ((b >> 8)  & 0xFF) * t + ((a >> 8)  & 0xFF) * (1 - t);
-	vb = ((b >> 0)  & 0xFF) * t + ((a >> 0)  & 0xFF) * (1 - t);
+	if(font->canvas_size < size)
+	{
+		free(font->canvas);
+		font->canvas_size = 0;
+		
+		font->canvas = calloc(size, sizeof(uint32_t));
+		if(font->canvas == NULL)
+		{
+			return(HACKTV_OUT_OF_MEMORY);
+		}
+		
+		font->canvas_size = size;
+	}
+	
+	/* Draw onto the empty canvas */
+	font->video = font->canvas;
+	font->video_width = linesize;
 	
-	return (vr << 16 | vg << 8 | vb << 0);	
+	font->x0 = linesize;
+	font->y0 = font->video_height;
+	font->x1 = 0;
+	font->y1 = 0;
+	
+	return(HACKTV_OK);
+}
+
+static font_overlay_t *_cache_end(av_font_t *font, const font_overlay_t *key)
+{
+	font_overlay_t *e;
+	uint32_t *pixels;
+	int i, w, h;
+	
+	/* Replace the least recently used entry */
+	e = &font->cache[0];
+	
+	for(i = 1; i < FONT_CACHE_SIZE; i++)
+	{
+		if(font->cache[i].used < e->used) e = &font->cache[i];
+	}
+	
+	free(e->text);
+	pixels = e->overlay.pixels;
+	
+	*e = *key;
+	e->text = strdup(key->text);
+	e->used = ++font->cache_tick;
+	
+	w = font->x1 - font->x0;
+	h = font->y1 - font->y0;
+	
+	if(w <= 0 || h <= 0)
+	{
+		/* Nothing was drawn */
+		w = h = 0;
+	}
+	
+	e->overlay.pixels = NULL;
+	e->overlay.width = 0;
+	e->overlay.height = 0;
+	e->overlay.x = font->x0;
+	e->overlay.y = font->y0;
+	
+	if(w > 0)
+	{
+		pixels = realloc(pixels, w * h * sizeof(uint32_t));
+		
+		if(pixels != NULL)
+		{
+			e->overlay.pixels = pixels;
+			e->overlay.width = w;
+			e->overlay.height = h;
+			pixels = NULL;
+		}
+	}
+	
+	free(pixels);
+	
+	/* Move the drawn area off the canvas, leaving it empty */
+	for(i = 0; i < h; i++)
+	{
+		uint32_t *row = &font->canvas[(font->y0 + i) * font->video_width + font->x0];
+		
+		if(e->overlay.pixels != NULL)
+		{
+			memcpy(&e->overlay.pixels[i * w], row, w * sizeof(uint32_t));
+		}
+		
+		memset(row, 0, w * sizeof(uint32_t));
+	}
+	
+	return(e);
 }
 
 static int draw_box(av_font_t *font, int x_start, int y_start, int x_end, int y_end, uint32_t colour, float transparency)
 {
-	int i, j;
+	int i, j, a;
 	uint32_t *dp;
 	
+	if(x_start < 0) x_start = 0;
+	if(y_start < 0) y_start = 0;
+	if(x_end > font->video_width) x_end = font->video_width;
+	if(y_end > font->video_height) y_end = font->video_height;
+	if(x_start >= x_end || y_start >= y_end) return(0);
+	
+	a = transparency * 255 + 0.5;
+	
 	for(i = x_start; i < x_end; i++)
 	{
 		for(j = y_start; j < y_end; j++)
 		{
 			dp = &font->video[j * font->video_width + i];
-			*dp = _make_transparent(*dp, colour, transparency);
+			*dp = _over(*dp, colour, a);
 		}
 	}
 	
+	_touch(font, x_start, y_start, x_end, y_end);
+	
 	return(0);
 }
 
 int display_bitmap_subtitle(av_font_t *font, uint32_t *vid, int linesize, int w, int h, uint32_t *bitmap)
 {
-	uint32_t c, *dp;
+	font_overlay_t key = {
+		.type = 2,
+		.text = "",
+		.bitmap = bitmap,
+		.linesize = linesize,
+	};
+	font_overlay_t *e;
+	uint32_t c;
 	int i, j, x_start, y_start, x, y;
-
-	font->video = vid;
-	font->video_width = linesize;
 	
-	x_start = (font->video_width / 2) - (w / 2);
-	y_start = (font->video_height) * 0.8;
+	/* Bitmaps are only drawn again when the subtitle changes */
+	e = _cache_find(font, &key);
 	
-	for (y = 0, i = y_start; y < h; y++, i++) 
+	if(e == NULL)
 	{
-		for(x = 0, j = x_start; x < w; x++, j++)
+		if(_cache_begin(font, linesize) != HACKTV_OK)
+		{
+			return(HACKTV_OUT_OF_MEMORY);
+		}
+		
+		x_start = (font->video_width / 2) - (w / 2);
+		y_start = (font->video_height) * 0.8;
+		
+		for (y = 0, i = y_start; y < h; y++, i++) 
 		{
-			dp = &font->video[i * font->video_width + j];
-			c = bitmap[y * w + x];
-			*dp = c > 0 ? c : *dp;
+			if(i < 0 || i >= font->video_height) continue;
+			
+			for(x = 0, j = x_start; x < w; x++, j++)
+			{
+				if(j < 0 || j >= font->video_width) continue;
+				
+				/* Any non-zero pixel replaces the video */
+				c = bitmap[y * w + x];
+				font->video[i * font->video_width + j] = c > 0 ? 0xFF000000 | c : 0;
+			}
 		}
+		
+		_touch(font,
+			x_start < 0 ? 0 : x_start,
+			y_start < 0 ? 0 : y_start,
+			x_start + w > font->video_width ? font->video_width : x_start + w,
+			y_start + h > font->video_height ? font->video_height : y_start + h
+		);
+		
+		e = _cache_end(font, &key);
 	}
 	
+	overlay_blend(vid, linesize, linesize, font->video_height, &e->overlay);
+	
 	return (0);
 }
 
-static int _printchar(av_font_t *font, FT_Bitmap *bitmap, FT_Int x, FT_Int y, uint32_t colour)
+static font_glyph_t *_get_glyph(av_font_t *font, uint32_t u)
+{
+	font_glyph_t *g;
+	FT_GlyphSlot slot;
+	int i;
+	
+	/* Return the glyph if it's already been rendered */
+	for(g = font->glyphs[u % FONT_GLYPH_BUCKETS]; g != NULL; g = g->next)
+	{
+		if(g->code == u) return(g);
+	}
+	
+	g = calloc(1, sizeof(font_glyph_t));
+	if(g == NULL)
+	{
+		return(NULL);
+	}
+	
+	g->code = u;
+	g->index = FT_Get_Char_Index(font->fontface, u);
+	
+	if(FT_Load_Glyph(font->fontface, g->index, FT_LOAD_RENDER) == 0)
+	{
+		slot = font->fontface->glyph;
+		
+		g->width = slot->bitmap.width;
+		g->rows = slot->bitmap.rows;
+		g->buffer = malloc(g->width * g->rows);
+		
+		if(g->buffer == NULL && g->width * g->rows > 0)
+		{
+			free(g);
+			return(NULL);
+		}
+		
+		/* Copy the bitmap without any row padding */
+		for(i = 0; i < g->rows; i++)
+		{
+			memcpy(&g->buffer[i * g->width], &slot->bitmap.buffer[i * slot->bitmap.pitch], g->width);
+		}
+		
+		g->left = slot->bitmap_left;
+		g->top = slot->bitmap_top;
+		g->advance_x = slot->advance.x;
+		g->advance_y = slot->advance.y;
+		g->height = slot->metrics.height;
+		g->loaded = 1;
+	}
+	
+	g->next = font->glyphs[u % FONT_GLYPH_BUCKETS];
+	font->glyphs[u % FONT_GLYPH_BUCKETS] = g;
+	
+	return(g);
+}
+
+static int _printchar(av_font_t *font, font_glyph_t *glyph, FT_Int x, FT_Int y, uint32_t colour)
 {
 	FT_Int i, j, p, q;
-	FT_Int x_max = x + bitmap->width;
-	FT_Int y_max = y + bitmap->rows;
+	FT_Int x_max = x + glyph->width;
+	FT_Int y_max = y + glyph->rows;
 
 	
 	for(i = x, p = 0; i < x_max; i++, p++)
@@ -152,23 +415,25 @@ static int _printchar(av_font_t *font, FT_Bitmap *bitmap, FT_Int x, FT_Int y, ui
 		for(j = y, q = 0; j < y_max; j++, q++)
 		{
 			uint32_t *dp;
-			uint8_t r, g, b;
 			int c;
 			
 			if(i < 0 || j < 0) continue;
 			if(i >= font->video_width || j >= font->video_height) continue;
 			
 			dp = &font->video[j * font->video_width +i];
-			c = bitmap->buffer[q * bitmap->width + p];
+			c = glyph->buffer[q * glyph->width + p];
 			
-			r = (((*dp >> 16) & 0xFF) * (255 - c) + ((colour >> 16) & 0xFF) * c) / 256;
-			g = (((*dp >>  8) & 0xFF) * (255 - c) + ((colour >>  8) & 0xFF) * c) / 256;
-			b = (((*dp >>  0) & 0xFF) * (255 - c) + ((colour >>  0) & 0xFF) * c) / 256;
-			
-			*dp = (r << 16) | (g << 8) | (b << 0);
+			*dp = _over(*dp, colour, c);
 		}
 	}
 	
+	_touch(font,
+		x < 0 ? 0 : x,
+		y < 0 ? 0 : y,
+		x_max > font->video_width ? font->video_width : x_max,
+		y_max > font->video_height ? font->video_height : y_max
+	);
+	
 	return(0);
 }
 
@@ -206,11 +471,10 @@ const uint32_t _utf8_to_utf32(char *str, char **next)
 
 int _printf(av_font_t *font, int32_t x, int32_t y, uint32_t colour, char *fmt)
 {
-	FT_GlyphSlot slot;
+	font_glyph_t *g;
 	FT_F26Dot6 pen_x, pen_y;
 	FT_Bool use_kerning;
 	FT_UInt previous;
-	int i;
 	char *s;
 	uint32_t u;
 	
@@ -222,7 +486,6 @@ int _printf(av_font_t *font, int32_t x, int32_t y, uint32_t colour, char *fmt)
 	
 	/* Todo: Process formatted text */
 	
-	slot = font->fontface->glyph;
 	pen_x = x << 6;
 	pen_y = y << 6;
 	
@@ -235,28 +498,27 @@ int _printf(av_font_t *font, int32_t x, int32_t y, uint32_t colour, char *fmt)
 		/* Ignore CR in Windows files */
 		if(u != '\r')
 		{
-			FT_UInt glyph_index;
-			glyph_index = FT_Get_Char_Index(font->fontface, u);
+			g = _get_glyph(font, u);
+			if(g == NULL) continue;
 			
-			if(use_kerning && previous && glyph_index)
+			if(use_kerning && previous && g->index)
 			{
 				FT_Vector delta;
-				FT_Get_Kerning(font->fontface, previous, glyph_index, ft_kerning_default, &delta);
+				FT_Get_Kerning(font->fontface, previous, g->index, ft_kerning_default, &delta);
 				pen_x += delta.x;
 			}
 			
-			i = FT_Load_Glyph(font->fontface, glyph_index, FT_LOAD_RENDER);
-			if(i) continue;
+			if(!g->loaded) continue;
 			
-			_printchar(font, &slot->bitmap,
-				(pen_x >> 6) + slot->bitmap_left,
-				(pen_y >> 6) - slot->bitmap_top,
+			_printchar(font, g,
+				(pen_x >> 6) + g->left,
+				(pen_y >> 6) - g->top,
 				colour);
 			
-			pen_x += slot->advance.x;
-			pen_y += slot->advance.y;
+			pen_x += g->advance_x;
+			pen_y += g->advance_y;
 			
-			previous = glyph_index;
+			previous = g->index;
 		}
 	}
 	
@@ -265,11 +527,10 @@ int _printf(av_font_t *font, int32_t x, int32_t y, uint32_t colour, char *fmt)
 
 static int _get_line_size(av_font_t *font, char *fmt, int *line_width, int *line_height)
 {
-	FT_GlyphSlot slot;
+	font_glyph_t *g;
 	FT_F26Dot6 pen_x;
 	FT_Bool use_kerning;
 	FT_UInt previous;
-	int i;
 	int32_t x = 0;
 	char *s;
 	uint32_t u;
@@ -283,7 +544,6 @@ static int _get_line_size(av_font_t *font, char *fmt, int *line_width, int *line
 		return(HACKTV_ERROR);
 	}
 	
-	slot = font->fontface->glyph;
 	pen_x = x << 6;
 	
 	use_kerning = FT_HAS_KERNING(font->fontface);
@@ -296,23 +556,22 @@ static int _get_line_size(av_font_t *font, char *fmt, int *line_width, int *line
 		/* Ignore CR in Windows files */
 		if(u != '\r')
 		{
-			FT_UInt glyph_index;
-			glyph_index = FT_Get_Char_Index(font->fontface, u);
+			g = _get_glyph(font, u);
+			if(g == NULL) continue;
 			
-			if(use_kerning && previous && glyph_index)
+			if(use_kerning && previous && g->index)
 			{
 				FT_Vector delta;
-				FT_Get_Kerning(font->fontface, previous, glyph_index, ft_kerning_default, &delta);
+				FT_Get_Kerning(font->fontface, previous, g->index, ft_kerning_default, &delta);
 				pen_x += delta.x;
 			}
 			
-			i = FT_Load_Glyph(font->fontface, glyph_index, FT_LOAD_RENDER);
-			if(i) continue;
+			if(!g->loaded) continue;
 			
-			pen_x += slot->advance.x;
-			previous = glyph_index;
+			pen_x += g->advance_x;
+			previous = g->index;
 			
-			*line_height = slot->metrics.height >> 6 > *line_height ? slot->metrics.height >> 6 : *line_height;
+			*line_height = g->height >> 6 > *line_height ? g->height >> 6 : *line_height;
 		}
 	}
 	
@@ -337,14 +596,22 @@ static void _print_line(av_font_t *font, int line_width, int line_height, int po
 
 void print_subtitle(av_font_t *font, uint32_t *vid, int linesize, char *fmt)
 {
-	if(strcmp(fmt, "") != 0) 
+	font_overlay_t key = {
+		.type = 1,
+		.text = fmt,
+		.linesize = linesize,
+	};
+	font_overlay_t *e;
+	
+	if(strcmp(fmt, "") == 0) return;
+	
+	/* The text is only drawn again when it changes */
+	e = _cache_find(font, &key);
+	
+	if(e == NULL && _cache_begin(font, linesize) == HACKTV_OK)
 	{
 		int i, p, x, y;
 		int spacing = 32;
-		
-		font->video = vid;
-		font->video_width = linesize;
-
 		int lines = 1;
 		char text[128];
 		
@@ -396,24 +663,53 @@ void print_subtitle(av_font_t *font, uint32_t *vid, int linesize, char *fmt)
 		x = font->video_width / 2 -  line_width / 2;
 		
 		_print_line(font, line_width, line_height, x, y + ((lines - 1) * spacing), text, 1, 1, 0x3A3A3A, 0.75, 1);
+		
+		e = _cache_end(font, &key);
+	}
+	
+	if(e != NULL)
+	{
+		overlay_blend(vid, linesize, linesize, font->video_height, &e->overlay);
 	}
 }
 
 void print_generic_text(av_font_t *font, uint32_t *vid, int linesize, char *fmt, float pos_x, float pos_y, int shadow, int box, int colour, float transparency)
 {
-	if(strcmp(fmt, "") != 0)
+	font_overlay_t key = {
+		.type = 0,
+		.text = fmt,
+		.pos_x = pos_x,
+		.pos_y = pos_y,
+		.shadow = shadow,
+		.box = box,
+		.colour = colour,
+		.transparency = transparency,
+		.linesize = linesize,
+	};
+	font_overlay_t *e;
+	
+	if(strcmp(fmt, "") == 0) return;
+	
+	/* The text is only drawn again when it changes */
+	e = _cache_find(font, &key);
+	
+	if(e == NULL && _cache_begin(font, linesize) == HACKTV_OK)
 	{
 		int line_width;
 		int line_height;
 		
-		font->video = vid;
-		font->video_width = linesize;
-		
 		_get_line_size(font, fmt, &line_width, &line_height);
 		
 		/* Centre if 50% */
 		pos_x = font->video_width * (pos_x / 100.00) - (pos_x != 50 ? 0 : line_width * (pos_x / 100.00));
 		pos_y = pos_y / 100.00 * font->video_height;
 		_print_line(font, line_width, line_height, (int) pos_x, (int) pos_y, fmt, shadow, box, colour, transparency, 0);
+		
+		e = _cache_end(font, &key);
+	}
+	
+	if(e != NULL)
+	{
+		overlay_blend(vid, linesize, linesize, font->video_height, &e->overlay);
 	}
 }
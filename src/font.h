@@ -22,6 +22,7 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include "video.h"
+#include "graphics.h"
 
 #define TEXT_POS_CENTRE 0
 #define TEXT_POS_LEFT 1
@@ -34,6 +35,53 @@
 #define TEXT_SUBTITLE 1
 #define TEXT_GENERIC 1
 
+/* Number of rendered overlays kept per font */
+#define FONT_CACHE_SIZE 4
+
+/* Number of hash buckets for rendered glyphs */
+#define FONT_GLYPH_BUCKETS 256
+
+typedef struct font_glyph_t {
+	
+	uint32_t code;		/* Unicode codepoint */
+	FT_UInt index;		/* Glyph index in the face */
+	int loaded;		/* 0 if FreeType couldn't load it */
+	
+	/* Rendered coverage bitmap, one byte per pixel */
+	uint8_t *buffer;
+	int width;
+	int rows;
+	int left;
+	int top;
+	
+	/* 26.6 fixed point metrics */
+	FT_Pos advance_x;
+	FT_Pos advance_y;
+	FT_Pos height;
+	
+	struct font_glyph_t *next;
+	
+} font_glyph_t;
+
+typedef struct {
+	
+	/* What was drawn. text is NULL if the entry is unused */
+	int type;
+	char *text;
+	const void *bitmap;
+	float pos_x;
+	float pos_y;
+	int shadow;
+	int box;
+	int colour;
+	float transparency;
+	int linesize;
+	
+	unsigned int used;
+	overlay_t overlay;
+	
+} font_overlay_t;
+
 typedef struct {
 	uint32_t *video;
 	int video_width;
@@ -45,10 +93,22 @@ typedef struct {
 	float x_loc;
 	float y_loc;
 	char *text;
+	
+	/* Text is drawn once into a premultiplied canvas, and the
+	 * area touched (x0, y0)-(x1, y1) is kept for reuse */
+	uint32_t *canvas;
+	size_t canvas_size;
+	int x0, y0, x1, y1;
+	font_overlay_t cache[FONT_CACHE_SIZE];
+	unsigned int cache_tick;
+	
+	/* Glyphs rendered so far at this font's size */
+	font_glyph_t *glyphs[FONT_GLYPH_BUCKETS];
 } av_font_t;
 
 
 extern int font_init(av_t *av, int size, float ratio, void *conf);
+extern void font_free(av_font_t *font);
 extern void print_subtitle(av_font_t *av, uint32_t *vid, int linesize, char *fmt);
 extern void print_generic_text(av_font_t *font, uint32_t *vid, int linesize, char *fmt, float pos_x, float pos_y, int shadow, int box, int colour, float transparency);
 extern int display_bitmap_subtitle(av_font_t *av, uint32_t *vid, int linesize, int w, int h, uint32_t *bitmap_data);
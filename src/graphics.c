@@ -186,6 +186,38 @@ static int _read_png_data(image_t *image, const pngs_t *pngs)
 	return (HACKTV_OK);
 }
 
+static void _premultiply(image_t *image)
+{
+	uint32_t *a, *b, c, t;
+	int x, y;
+	
+	/* Flip the image the right way up */
+	for(y = 0; y < image->img_height / 2; y++)
+	{
+		a = &image->logo[y * image->img_width];
+		b = &image->logo[(image->img_height - y - 1) * image->img_width];
+		
+		for(x = 0; x < image->img_width; x++)
+		{
+			c = a[x];
+			a[x] = b[x];
+			b[x] = c;
+		}
+	}
+	
+	/* Scale the colours by alpha, ready for overlay_blend() */
+	for(x = 0; x < image->img_width * image->img_height; x++)
+	{
+		c = image->logo[x];
+		t = c >> 24;
+		
+		image->logo[x] = (c & 0xFF000000)
+		               | (((c >> 16 & 0xFF) * t + 127) / 255) << 16
+		               | (((c >>  8 & 0xFF) * t + 127) / 255) << 8
+		               | (((c >>  0 & 0xFF) * t + 127) / 255) << 0;
+	}
+}
+
 int load_png(image_t **s, int width, int height, char *image_name, float scale, float ratio, int type)
 {
 	const pngs_t *pngs;
@@ -280,6 +312,10 @@ int load_png(image_t **s, int width, int height, char *image_name, float scale,
 		}
 		
 		resize_bitmap(logo, image->logo, image->width, image->height, image->img_width, image->img_height);
+		free(logo);
+		
+		_premultiply(image);
+		
 		*s = image;
 		return(HACKTV_OK);
 	}
@@ -288,11 +324,50 @@ int load_png(image_t **s, int width, int height, char *image_name, float scale,
 }
 
 
+static void _blend_row(uint32_t *restrict dst, const uint32_t *restrict src, int n)
+{
+	uint32_t s, d, a;
+	int x;
+	
+	/* dst = src + dst * (1 - src alpha). Kept branch free so
+	 * the compiler can vectorise it. An alpha of 0 multiplies
+	 * by 256 / 256 to leave the frame untouched */
+	for(x = 0; x < n; x++)
+	{
+		s = src[x];
+		d = dst[x];
+		a = 256 - (s >> 24);
+		
+		dst[x] = ((((d & 0xFF00FF) * a) >> 8) & 0xFF00FF)
+		       + ((((d & 0x00FF00) * a) >> 8) & 0x00FF00)
+		       + (s & 0xFFFFFF);
+	}
+}
+
+void overlay_blend(uint32_t *framebuffer, int line_stride, int vid_width, int vid_height, const overlay_t *o)
+{
+	int x0, y0, x1, y1, y;
+	
+	if(o->pixels == NULL) return;
+	
+	/* Only blend the part of the layer inside the frame */
+	x0 = o->x < 0 ? 0 : o->x;
+	y0 = o->y < 0 ? 0 : o->y;
+	x1 = o->x + o->width > vid_width ? vid_width : o->x + o->width;
+	y1 = o->y + o->height > vid_height ? vid_height : o->y + o->height;
+	
+	for(y = y0; y < y1; y++)
+	{
+		_blend_row(
+			&framebuffer[y * line_stride + x0],
+			&o->pixels[(y - o->y) * o->width + (x0 - o->x)],
+			x1 - x0
+		);
+	}
+}
+
 void overlay_image(uint32_t *framebuffer, image_t *l, int vid_width, int line_stride, int vid_height, int pos)
 {
-	int i, j, x, y, r, g, b, vi;
-	float t;
-	uint32_t c;
 	int x_start = 0;
 	int y_start = 0;
 
@@ -343,31 +418,13 @@ void overlay_image(uint32_t *framebuffer, image_t *l, int vid_width, int line_st
 	}
 	
 	/* Overlay image */
-	for (y = 0, i = y_start; y < l->img_height; y++, i++) 
-	{
-		for(x = 0, j = x_start; x < l->img_width; x++, j++)
-		{
-			/* Only render image inside active video areas */
-			if(j >= 0 && j < vid_width)
-			{
-				/* Get pixel */
-				c = l->logo[x + ((l->img_height - y - 1) * l->img_width)];
-				
-				/* Calculate transparency level */
-				t = 1.0 - (float) (c >> 24) / 0xFF;
-				
-				/* Set logo position */
-				vi = i * line_stride + j;
-				
-				/* Apply transparency  */
-				r = ((framebuffer[vi] >> 16) & 0xFF) * t + ((c >> 16) & 0xFF) * (1 - t);
-				g = ((framebuffer[vi] >> 8)  & 0xFF) * t + ((c >> 8)  & 0xFF) * (1 - t);
-				b = ((framebuffer[vi] >> 0)  & 0xFF) * t + ((c >> 0)  & 0xFF) * (1 - t);
-				
-				framebuffer[vi] = (r << 16 | g << 8 | b << 0);
-			}
-		}
-	}
+	overlay_blend(framebuffer, line_stride, vid_width, vid_height, &(overlay_t) {
+		.pixels = l->logo,
+		.width = l->img_width,
+		.height = l->img_height,
+		.x = x_start,
+		.y = y_start,
+	});
 }
 
 /* Inspiration from http://tech-algorithm.com/articles/bilinear-image-scaling/ */
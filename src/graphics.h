@@ -35,13 +35,23 @@
 
 #define MAX_PNG_SIZE 128
 
+/* A layer of premultiplied ARGB pixels to blend over a frame.
+ * Alpha 0x00 is transparent, 0xFF is opaque */
+typedef struct {
+	uint32_t *pixels;
+	int width;
+	int height;
+	int x;
+	int y;
+} overlay_t;
+
 typedef struct {
 	char *name;
 	int width;
 	int height;
 	int img_width;
 	int img_height;
-	uint32_t *logo;
+	uint32_t *logo; /* Premultiplied, top row first */
 	png_bytep *row_pointers;
 	int position;
 } image_t;
@@ -64,6 +74,7 @@ typedef struct {
 } png_mem_t;
 
 extern int read_png_file(image_t *image);
+extern void overlay_blend(uint32_t *framebuffer, int line_stride, int vid_width, int vid_height, const overlay_t *o);
 extern void overlay_image(uint32_t *framebuffer, image_t *l, int vid_width, int line_stride, int vid_height, int pos);
 extern int load_png(image_t **s, int width, int height, char *filename, float scale, float ratio, int type);
 extern void resize_bitmap(uint32_t *input, uint32_t *output, int old_width, int old_height, int new_width, int new_height);
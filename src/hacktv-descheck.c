@@ -0,0 +1,203 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+/* Checks the shared DES core and the conditional access code built on
+ * it against fixed vectors. The FIPS 46 known answer tests the core
+ * alone. The Eurocrypt, Syster and Discret 14 vectors were produced by
+ * each module's own DES code, before they moved to des.c.
+ *
+ * Usage: hacktv-descheck
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "video.h"
+#include "syster-ca.h"
+#include "discret14-ca.h"
+
+static int _errors = 0;
+
+static void _check(const char *name, const uint8_t *out, const uint8_t *expected, int n)
+{
+	int i;
+	
+	if(memcmp(out, expected, n) == 0)
+	{
+		printf("%-24s OK\n", name);
+		return;
+	}
+	
+	printf("%-24s FAIL\n", name);
+	
+	printf("  Got:      ");
+	for(i = 0; i < n; i++) printf(" %02X", out[i]);
+	printf("\n  Expected: ");
+	for(i = 0; i < n; i++) printf(" %02X", expected[i]);
+	printf("\n");
+	
+	_errors++;
+}
+
+static void _check64(const char *name, uint64_t out, uint64_t expected)
+{
+	uint8_t a[8], b[8];
+	int i;
+	
+	for(i = 7; i >= 0; i--, out >>= 8, expected >>= 8)
+	{
+		a[i] = out & 0xFF;
+		b[i] = expected & 0xFF;
+	}
+	
+	_check(name, a, b, 8);
+}
+
+static void _check_des(void)
+{
+	des_key_t ks;
+	
+	/* FIPS 46 worked example */
+	des_key(&ks, 0x133457799BBCDFF1ULL);
+	_check64("DES encrypt", des_crypt(&ks, 0x0123456789ABCDEFULL, DES_ENCRYPT), 0x85E813540F0AB405ULL);
+	_check64("DES decrypt", des_crypt(&ks, 0x85E813540F0AB405ULL, DES_DECRYPT), 0x0123456789ABCDEFULL);
+}
+
+static void _check_eurocrypt(void)
+{
+	static const uint8_t key[16] = {
+		0x84, 0x42, 0x12, 0x5A, 0x3C, 0x7E, 0x91, 0x00,
+		0x2B, 0xD5, 0x63, 0x0F, 0xA8, 0x4E, 0x17, 0x00,
+	};
+	static const uint8_t in[8] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF };
+	static const struct {
+		const char *name;
+		int algo;
+		int desmode;
+		uint8_t out[8];
+	} v[] = {
+		{ "Eurocrypt M ECM",     EC_M,    ECM,  { 0xA3, 0x55, 0x43, 0x3C, 0x7D, 0x51, 0x65, 0xC3 } },
+		{ "Eurocrypt M hash",    EC_M,    HASH, { 0xC9, 0x37, 0x9D, 0x5B, 0xE5, 0x57, 0x8D, 0x54 } },
+		{ "Eurocrypt S ECM",     EC_S,    ECM,  { 0xFA, 0xF9, 0x95, 0xC5, 0x4B, 0x5B, 0x8E, 0x45 } },
+		{ "Eurocrypt S hash",    EC_S,    HASH, { 0x2E, 0xDF, 0x6C, 0xF8, 0xAA, 0x44, 0x7E, 0x12 } },
+		{ "Eurocrypt S2",        EC_S2,   ECM,  { 0xA1, 0xD0, 0x91, 0xC0, 0xBF, 0xFD, 0xC1, 0xE3 } },
+		{ "Eurocrypt 3DES",      EC_3DES, ECM,  { 0x67, 0x05, 0xFD, 0x19, 0x82, 0x39, 0x1B, 0x8B } },
+	};
+	des_key_t ks[2];
+	uint8_t data[8];
+	int i;
+	
+	eurocrypt_key(&ks[0], key);
+	eurocrypt_key(&ks[1], key + 8);
+	
+	for(i = 0; i < sizeof(v) / sizeof(v[0]); i++)
+	{
+		memcpy(data, in, 8);
+		eurocrypt_crypt(data, ks, v[i].desmode, v[i].algo);
+		_check(v[i].name, data, v[i].out, 8);
+	}
+}
+
+static void _check_syster(void)
+{
+	static const uint8_t key[8] = { 0x3A, 0x91, 0x5C, 0x07, 0xE2, 0x64, 0xBD, 0x18 };
+	static const uint8_t ecm_in[16] = {
+		0x03, 0x13, 0x23, 0x33, 0x43, 0x53, 0x63, 0x73,
+		0x83, 0x93, 0xA3, 0xB3, 0xC3, 0xD3, 0xE3, 0xF3,
+	};
+	static const uint8_t ecm_out[16] = {
+		0x90, 0x4D, 0xE0, 0x67, 0xF1, 0x62, 0x8E, 0x49,
+		0x1E, 0xC4, 0xCE, 0x70, 0x98, 0x35, 0x41, 0x2C,
+	};
+	des_key_t ks;
+	uint8_t ecm[16];
+	int i;
+	
+	syster_ca_key(&ks, key);
+	
+	/* Decrypting returns the control word, leaving the ECM alone */
+	for(i = 0; i < 16; i++)
+	{
+		ecm[i] = 0x10 * i + 0x07;
+	}
+	
+	_check64("Syster decrypt", encrypt_syster_cw(ecm, &ks, NG_DECRYPT), 0x1319CBD16A4D6D64ULL);
+	
+	/* Encrypting writes the encrypted control word into the ECM */
+	memcpy(ecm, ecm_in, 16);
+	_check64("Syster encrypt", encrypt_syster_cw(ecm, &ks, NG_ENCRYPT), 0x0646260773E3D3C3ULL);
+	_check("Syster encrypt ECM", ecm, ecm_out, 16);
+}
+
+static void _check_discret14(void)
+{
+	static const uint8_t sf_init[D14_CA_SUPERFRAME_BYTES] = {
+		0x01, 0x1B, 0xF7, 0x00, 0x01, 0x92, 0xFF, 0x00,
+		0x23, 0xB9, 0xA2, 0x92, 0xBD, 0xB1, 0x27, 0xF7,
+		0x02, 0x4D, 0x61, 0x63, 0x64, 0xCA, 0x3D, 0xE5,
+	};
+	static const uint8_t seed_init[16] = {
+		0x6B, 0x24, 0x07, 0xC1, 0xA2, 0xCE, 0xE2, 0x2C,
+		0xA2, 0x57, 0xF0, 0xCD, 0x89, 0xD0, 0x0E, 0x2F,
+	};
+	static const uint8_t sf_next[D14_CA_SUPERFRAME_BYTES] = {
+		0x03, 0x1B, 0xF7, 0x00, 0x01, 0x92, 0xFF, 0x00,
+		0x58, 0x5C, 0x38, 0x47, 0x33, 0x1F, 0xD0, 0x66,
+		0x49, 0x5E, 0x36, 0x5B, 0x8E, 0xA3, 0x25, 0x41,
+	};
+	static const uint8_t sf_toggle[D14_CA_SUPERFRAME_BYTES] = {
+		0x43, 0x1B, 0xF7, 0x00, 0x01, 0x92, 0xFF, 0x00,
+		0x49, 0x5E, 0x36, 0x5B, 0x8E, 0xA3, 0x25, 0x41,
+		0x58, 0x5C, 0x38, 0x47, 0x33, 0x1F, 0xD0, 0x66,
+	};
+	static const uint8_t seed_toggle[16] = {
+		0xAA, 0x8B, 0xDE, 0x81, 0x90, 0x95, 0xB6, 0xD2,
+		0x30, 0x35, 0x48, 0xB7, 0x4E, 0x55, 0xA2, 0xC7,
+	};
+	discret14_ca_t ca;
+	
+	/* The CA prints each superframe it logs before these results */
+	discret14_ca_init(&ca);
+	_check("Discret 14 superframe", ca.superframe, sf_init, D14_CA_SUPERFRAME_BYTES);
+	_check("Discret 14 ASIC seed", ca.asic_seed, seed_init, 16);
+	
+	discret14_ca_advance_packet(&ca);
+	discret14_ca_advance_packet(&ca);
+	_check("Discret 14 next packet", ca.superframe, sf_next, D14_CA_SUPERFRAME_BYTES);
+	
+	discret14_ca_toggle(&ca);
+	_check("Discret 14 toggle", ca.superframe, sf_toggle, D14_CA_SUPERFRAME_BYTES);
+	_check("Discret 14 toggle seed", ca.asic_seed, seed_toggle, 16);
+}
+
+int main(int argc, char *argv[])
+{
+	_check_des();
+	_check_eurocrypt();
+	_check_syster();
+	_check_discret14();
+	
+	if(_errors > 0)
+	{
+		printf("%d DES check%s failed\n", _errors, _errors == 1 ? "" : "s");
+		return(-1);
+	}
+	
+	printf("All DES checks passed\n");
+	
+	return(0);
+}
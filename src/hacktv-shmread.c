@@ -0,0 +1,222 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+/* Example reader for the hacktv shared memory output (-o shm:<name>).
+ * Copies samples from the ring to stdout, in the same format as file
+ * output, and reports any overruns on stderr.
+ *
+ * The reader attaches to the ring, so hacktv runs at the pace of the
+ * consumer and nothing is lost. With -p it reads passively, alongside
+ * an attached reader or to watch a live output without slowing it.
+ *
+ * Usage: hacktv-shmread [-p] <name> | <consumer>
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "rf_shm.h"
+
+static rf_shm_header_t *_open_shm(const char *name, size_t *map_size, int *writable)
+{
+	rf_shm_header_t *h;
+	struct stat st;
+	void *map;
+	int fd;
+	
+	/* Attaching needs write access to the header */
+	fd = *writable ? shm_open(name, O_RDWR, 0) : -1;
+	
+	if(fd < 0)
+	{
+		*writable = 0;
+		fd = shm_open(name, O_RDONLY, 0);
+	}
+	
+	if(fd < 0)
+	{
+		perror(name);
+		return(NULL);
+	}
+	
+	if(fstat(fd, &st) != 0 || st.st_size < sizeof(rf_shm_header_t))
+	{
+		fprintf(stderr, "%s: Not a hacktv shared memory output\n", name);
+		close(fd);
+		return(NULL);
+	}
+	
+	map = mmap(NULL, st.st_size, PROT_READ | (*writable ? PROT_WRITE : 0), MAP_SHARED, fd, 0);
+	close(fd);
+	
+	if(map == MAP_FAILED)
+	{
+		perror("mmap");
+		return(NULL);
+	}
+	
+	h = map;
+	
+	if(memcmp(h->magic, RF_SHM_MAGIC, 4) != 0 ||
+	   h->version != RF_SHM_VERSION ||
+	   h->header_size + h->size * h->sample_size > st.st_size)
+	{
+		fprintf(stderr, "%s: Not a hacktv shared memory output\n", name);
+		munmap(map, st.st_size);
+		return(NULL);
+	}
+	
+	*map_size = st.st_size;
+	
+	return(h);
+}
+
+static void _detach(rf_shm_header_t *h, uint32_t pid)
+{
+	__atomic_compare_exchange_n(&h->reader_pid, &pid, 0, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+int main(int argc, char *argv[])
+{
+	const struct timespec wait = { 0, 1000000 };
+	rf_shm_header_t *h;
+	const uint8_t *ring;
+	const char *name;
+	size_t map_size;
+	uint64_t head, tail, start, mask, i, n;
+	uint64_t overruns = 0;
+	uint32_t pid, none;
+	int attach;
+	
+	if(argc == 3 && strcmp(argv[1], "-p") == 0)
+	{
+		attach = 0;
+		name = argv[2];
+	}
+	else if(argc == 2)
+	{
+		attach = 1;
+		name = argv[1];
+	}
+	else
+	{
+		fprintf(stderr, "Usage: %s [-p] <name>\n", argv[0]);
+		return(-1);
+	}
+	
+	h = _open_shm(name, &map_size, &attach);
+	if(!h)
+	{
+		return(-1);
+	}
+	
+	fprintf(stderr, "%s: %u Hz, type %d, %s, %llu samples\n",
+		name, h->sample_rate, h->type,
+		h->flags & RF_SHM_FLAG_COMPLEX ? "complex" : "real",
+		(unsigned long long) h->size
+	);
+	
+	ring = (const uint8_t *) h + h->header_size;
+	mask = h->size - 1;
+	
+	/* Start from the newest sample */
+	tail = __atomic_load_n(&h->head, __ATOMIC_ACQUIRE);
+	pid = getpid();
+	
+	if(attach)
+	{
+		/* Publish the starting point before claiming the ring */
+		__atomic_store_n(&h->tail, tail, __ATOMIC_RELEASE);
+		
+		none = 0;
+		attach = __atomic_compare_exchange_n(&h->reader_pid, &none, pid, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+		
+		if(!attach)
+		{
+			fprintf(stderr, "Another reader (%u) is attached, reading passively\n", none);
+		}
+	}
+	else
+	{
+		fprintf(stderr, "Reading passively, samples may be lost\n");
+	}
+	
+	while(1)
+	{
+		head = __atomic_load_n(&h->head, __ATOMIC_ACQUIRE);
+		
+		if(head == tail)
+		{
+			/* Drained. Stop if the writer has gone */
+			if(__atomic_load_n(&h->state, __ATOMIC_ACQUIRE) == 0) break;
+			
+			nanosleep(&wait, NULL);
+			continue;
+		}
+		
+		if(head - tail > h->size)
+		{
+			fprintf(stderr, "Overrun, %llu samples lost\n", (unsigned long long) (head - tail - h->size));
+			tail = head - h->size;
+			overruns++;
+		}
+		
+		start = tail;
+		
+		while(tail < head)
+		{
+			/* Write straight from the ring, up to the wrap point */
+			i = tail & mask;
+			n = mask + 1 - i;
+			if(n > head - tail) n = head - tail;
+			
+			if(fwrite(ring + i * h->sample_size, h->sample_size, n, stdout) != n)
+			{
+				perror("fwrite");
+				if(attach) _detach(h, pid);
+				return(-1);
+			}
+			
+			tail += n;
+			
+			/* Let the writer reuse the space */
+			if(attach) __atomic_store_n(&h->tail, tail, __ATOMIC_RELEASE);
+		}
+		
+		/* Check the samples weren't overwritten while being written.
+		 * An attached reader's samples are held until it moves tail */
+		if(!attach && __atomic_load_n(&h->head, __ATOMIC_ACQUIRE) - start > h->size)
+		{
+			fprintf(stderr, "Overrun while reading\n");
+			overruns++;
+		}
+	}
+	
+	if(attach) _detach(h, pid);
+	
+	fprintf(stderr, "Output closed, %llu overruns\n", (unsigned long long) overruns);
+	
+	munmap(h, map_size);
+	
+	return(0);
+}
@@ -0,0 +1,436 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2017 Philip Heron <phil@sanslogic.co.uk>                    */
+/* Copyright 2026 Katy Coe - https://github.com/djkaty/                  */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+/* Checks the Videocrypt 10 ASIC model against the original reference
+ * model, which kept the shift register and FIFO as arrays of bool and
+ * followed the hardware one bit at a time. The ASIC code packs these
+ * into words for speed. Both are driven with the same random command
+ * sequences, and their state and responses must match throughout.
+ *
+ * The reference feedback function and its tables were written by
+ * Katy Coe, and are kept here unchanged apart from formatting.
+ *
+ * Usage: hacktv-vc10check [<seed>]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "videocrypt10-asic.h"
+
+/* Reference ASIC state */
+typedef struct {
+	bool shift_register[105];
+	bool fifo_buffer[64];
+	int iterations;
+	bool crypto_enabled;
+	bool decoder_capture;
+	int read_pointer;
+	bool has_pending_response;
+	uint8_t pending_response_byte;
+} _ref_t;
+
+/* Tap selectors for bits 64-79 */
+static const int _tap_selectors[16][2][4] =
+{
+	{{37, 49, 11, 61}, {61, 37, 49, 11}},  /* 64 */
+	{{35, 14, 24, 39}, {14, 39, 35, 24}},  /* 65 */
+	{{59, 63, 33, 43}, {43, 59, 63, 33}},  /* 66 */
+	{{48, 20,  2, 38}, {38, 48, 20,  2}},  /* 67 */
+	{{22, 46,  5, 40}, {40, 22, 46,  5}},  /* 68 */
+	{{47, 54, 16, 57}, {57, 47, 54, 16}},  /* 69 */
+	{{29,  3, 34, 42}, {34, 42,  3, 29}},  /* 70 */
+	{{51, 45, 18, 58}, {45, 58, 51, 18}},  /* 71 */
+	{{25, 52, 36, 10}, {36, 10, 52, 25}},  /* 72 */
+	{{21, 15, 30, 41}, {30, 41, 15, 21}},  /* 73 */
+	{{17, 60,  8, 28}, {60, 28, 17,  8}},  /* 74 */
+	{{ 4, 32, 13, 53}, {53, 13,  4, 32}},  /* 75 */
+	{{12,  7, 23,  9}, { 7,  9, 12, 23}},  /* 76 */
+	{{50, 27, 31, 19}, {31, 19, 27, 50}},  /* 77 */
+	{{ 0,  6, 55, 62}, { 6, 62,  0, 55}},  /* 78 */
+	{{44, 26, 56,  1}, { 1, 56, 44, 26}}   /* 79 */
+};
+
+/* P-boxes for bits 80-95 */
+typedef struct
+{
+	int bit;
+	int idx;
+} _pbox_t;
+
+static const _pbox_t _p_boxes[16][2][4] =
+{
+	{{{76,2}, {68,1}, {69,0}, {69,0}}, {{68,1}, {75,1}, {76,2}, {69,2}}},  /* 80 */
+	{{{79,3}, {71,0}, {68,3}, {73,0}}, {{71,2}, {73,0}, {79,3}, {68,3}}},  /* 81 */
+	{{{78,3}, {65,0}, {65,3}, {74,1}}, {{74,1}, {78,3}, {65,0}, {72,1}}},  /* 82 */
+	{{{66,2}, {64,3}, {78,2}, {75,2}}, {{64,3}, {75,2}, {64,2}, {78,2}}},  /* 83 */
+	{{{79,1}, {79,1}, {67,3}, {77,0}}, {{75,1}, {77,0}, {69,2}, {67,3}}},  /* 84 */
+	{{{66,2}, {66,1}, {75,0}, {73,1}}, {{75,0}, {64,2}, {79,2}, {66,1}}},  /* 85 */
+	{{{65,2}, {66,3}, {67,2}, {75,3}}, {{75,3}, {67,2}, {65,2}, {66,3}}},  /* 86 */
+	{{{64,0}, {70,2}, {74,2}, {77,1}}, {{70,2}, {74,2}, {77,1}, {64,0}}},  /* 87 */
+	{{{77,3}, {78,0}, {79,2}, {76,3}}, {{73,1}, {65,1}, {76,3}, {78,0}}},  /* 88 */
+	{{{72,2}, {76,1}, {77,2}, {66,0}}, {{76,1}, {77,2}, {66,0}, {72,2}}},  /* 89 */
+	{{{71,3}, {69,1}, {65,3}, {73,2}}, {{69,1}, {72,1}, {73,2}, {71,3}}},  /* 90 */
+	{{{74,3}, {67,0}, {71,1}, {79,0}}, {{67,0}, {73,3}, {72,0}, {73,3}}},  /* 91 */
+	{{{69,3}, {72,3}, {65,1}, {67,1}}, {{77,3}, {67,1}, {72,3}, {69,3}}},  /* 92 */
+	{{{76,0}, {70,3}, {68,2}, {78,1}}, {{78,1}, {68,2}, {76,0}, {70,3}}},  /* 93 */
+	{{{70,0}, {71,2}, {70,0}, {74,3}}, {{72,0}, {79,0}, {71,1}, {71,0}}},  /* 94 */
+	{{{74,0}, {70,1}, {64,1}, {68,0}}, {{68,0}, {74,0}, {70,1}, {64,1}}}   /* 95 */
+};
+
+/* Linear taps for bits 96-103 */
+static const int _linear_taps[8][2] =
+{
+	{5, 2}, {9, 8}, {17, 10}, {29, 18}, {38, 33}, {46, 44}, {53, 49}, {62, 57}
+};
+
+static bool _ref_feedback(const bool *input)
+{
+	/* Get bits from 0-63 based on mask in 64-79 */
+	bool sel[16][4];
+	for(int b = 0; b < 16; b++)
+	{
+		int bit_idx = b + 64;
+		int selector = input[bit_idx] ? 1 : 0;
+		for(int i = 0; i < 4; i++)
+		{
+			sel[b][i] = input[_tap_selectors[b][selector][i]];
+		}
+	}
+
+	/* Permute selected bits based on mask in 80-95 */
+	bool s[16][4];
+	for(int bit = 0; bit < 16; bit++)
+	{
+		int bit_idx = bit + 80;
+		int selector = input[bit_idx] ? 0 : 1;  /* Inverted! */
+		for(int i = 0; i < 4; i++)
+		{
+			_pbox_t entry = _p_boxes[bit][selector][i];
+			s[bit][i] = !sel[entry.bit - 64][entry.idx];
+		}
+	}
+
+	/* Special cases */
+	s[2][2]   = (input[82]   || !sel[1][0])  && (input[90]   || !sel[1][3]);
+	s[10][1]  = (!input[82]  || !sel[8][1])  && (!input[90]  || !sel[5][1]);
+
+	s[0][3]   = (input[84]   && !sel[5][2])  || (!input[80]  && !sel[5][0]);
+	s[4][0]   = (input[80]   && !sel[11][1]) || (!input[84]  && !sel[15][1]);
+
+	s[1][0]   = (!input[81]  || !sel[15][3]) && (input[94]   || !sel[7][2]);
+	s[14][3]  = (input[81]   || !sel[7][0])  && (!input[94]  || !sel[10][3]);
+
+	s[3][2]   = (!input[83]  || !sel[14][2]) && (!input[85]  || !sel[0][2]);
+	s[5][0]   = (input[83]   || !sel[2][2])  && (input[85]   || !sel[11][0]);
+
+	s[8][0]   = (!input[88]  || !sel[13][3]) && (input[85]   || !sel[9][1]);
+	s[5][2]   = (!input[85]  || !sel[11][0]) && (input[88]   || !sel[15][2]);
+
+	s[8][1]   = (!input[88]  || !sel[14][0]) && (input[92]   || !sel[1][1]);
+	s[12][0]  = (!input[92]  || !sel[5][3])  && (input[88]   || !sel[13][3]);
+
+	s[11][3]  = (input[91]   && !sel[9][3])  || (input[94]   && !sel[15][0]);
+	s[14][2]  = (!input[91]  && !sel[7][1])  || (!input[94]  && !sel[6][0]);
+
+	s[11][0]  = (input[94]   || !sel[10][3]) && (input[91]   || !sel[3][0]);
+	s[14][0]  = (!input[91]  || !sel[8][0])  && (!input[94]  || !sel[6][0]);
+
+	s[15][0]  = !s[15][0];
+
+	/* Complex logic */
+	bool a     = ((s[13][1] || s[9][3])  == (s[3][0]  && s[10][2]));
+	bool b     = (s[5][3]   || s[7][3])  && (s[4][2]  == s[13][0]);
+	bool i1    = a || b;
+
+	bool r1    = (s[15][0]  != s[11][1]) || (s[10][1] && s[2][2]);
+	bool r2_1  = (s[0][3]   || s[4][0])  != (s[1][0]  && s[14][3]);
+	bool r2    = r2_1 || !r1;
+
+	bool r5    = (s[1][3]   == s[6][2])  || (s[3][2]  && s[5][0]);
+	bool r5_1  = (s[2][1]   || s[9][0])  == (s[6][3]  && s[12][3]);
+	bool r6    = r5 && r5_1;
+
+	bool r9    = (s[7][0]   == s[10][0]) || (s[8][1]  && s[12][0]);
+	bool r12_1 = (s[11][3]  || s[14][2]) != (s[12][2] && s[13][2]);
+	bool r12   = r12_1 || !r9;
+
+	bool r10   = (s[1][2]   == s[9][2])  && (s[14][1] || s[15][2]);
+	bool r11   = (s[0][1]   || s[10][3]) == (s[3][1]  && s[15][1]);
+	bool c     = !r10 && !r11;
+
+	bool r7    = ((s[7][2]  == s[9][1])  || (s[8][0]  && s[5][2]))  ^ (s[8][2]  != s[12][1] || !(s[2][0]  || s[1][1]));
+	bool r8    = ((s[7][1]  == s[13][3]) || (s[11][2] && s[8][3]))  ^ (s[3][3]  != s[6][0]  || !(s[5][1]  || s[4][1]));
+	bool r13   = ((s[2][3]  == s[0][0])  || (s[14][0] && s[11][0])) ^ (s[4][3]  != s[0][2]  || !(s[6][1]  || s[15][3]));
+
+	bool i2    = (r2 != i1) && (r6 || r7);
+	a          = (c || !r13) == (r8 || !r12);
+
+	bool p     = a && !i2;
+
+	/* Handle bits 96-103 */
+	int xor_count = 0;
+	for(int bit = 96; bit < 104; bit++)
+	{
+		int tap_idx = input[bit] ? 1 : 0;
+		if(input[_linear_taps[bit - 96][tap_idx]])
+		{
+			xor_count++;
+		}
+	}
+	bool xors = (xor_count & 1) == 1;
+	xors ^= input[104];
+
+	return(p ^ xors);
+}
+
+static void _ref_iterate(_ref_t *r, int rounds)
+{
+	bool bit;
+	
+	for(; rounds > 0; rounds--)
+	{
+		bit = _ref_feedback(r->shift_register);
+		memmove(&r->shift_register[1], &r->shift_register[0], 104 * sizeof(bool));
+		r->shift_register[0] = bit;
+	}
+}
+
+static void _ref_load(bool *bits, uint8_t byte)
+{
+	int i;
+	
+	for(i = 0; i < 8; i++)
+	{
+		bits[i] = (byte >> i) & 1;
+	}
+}
+
+static void _ref_push(_ref_t *r, uint8_t byte)
+{
+	int i;
+	
+	memmove(&r->fifo_buffer[8], &r->fifo_buffer[0], 56 * sizeof(bool));
+	_ref_load(&r->fifo_buffer[0], byte);
+	
+	if(r->crypto_enabled)
+	{
+		for(i = 0; i < 64; i++)
+		{
+			r->shift_register[i] ^= r->fifo_buffer[i];
+		}
+		
+		_ref_iterate(r, r->iterations);
+	}
+}
+
+static uint8_t _ref_read(_ref_t *r)
+{
+	uint8_t v = 0;
+	int i;
+	
+	for(i = 0; i < 8; i++)
+	{
+		v |= r->shift_register[r->read_pointer * 8 + i] << i;
+	}
+	
+	r->read_pointer = (r->read_pointer + 1) % 8;
+	
+	return(v);
+}
+
+/* Process one two-byte command, or a single 0x13 read */
+static void _ref_command(_ref_t *r, const uint8_t *c)
+{
+	switch(c[0])
+	{
+	case 0x01:
+		_ref_push(r, c[1]);
+		break;
+	
+	case 0x21:
+		r->crypto_enabled = (c[1] >> 1) & 1;
+		r->decoder_capture = (c[1] >> 2) & 1;
+		
+		if(c[1] & 1)
+		{
+			r->shift_register[104] = false;
+			memset(r->shift_register, 0, 64 * sizeof(bool));
+			r->read_pointer = 0;
+		}
+		break;
+	
+	case 0x31:
+		r->iterations = c[1] > 0 ? c[1] * 1024 + 1 : 0;
+		break;
+	
+	case 0x51: _ref_load(&r->shift_register[96], c[1]); break;
+	case 0x61: _ref_load(&r->shift_register[64], c[1]); break;
+	case 0x71: _ref_load(&r->shift_register[72], c[1]); break;
+	case 0x81: _ref_load(&r->shift_register[80], c[1]); break;
+	case 0x91: _ref_load(&r->shift_register[88], c[1]); break;
+	
+	case 0x13:
+		r->pending_response_byte = _ref_read(r);
+		r->has_pending_response = true;
+		break;
+	}
+}
+
+static void _ref_reset(_ref_t *r)
+{
+	memset(r->shift_register, 0, sizeof(r->shift_register));
+	memset(r->fifo_buffer, true, sizeof(r->fifo_buffer));
+	r->iterations = 1025;
+	r->crypto_enabled = false;
+	r->decoder_capture = false;
+	r->read_pointer = 0;
+	r->has_pending_response = false;
+}
+
+static uint64_t _pack(const bool *bits, int n)
+{
+	uint64_t v = 0;
+	int i;
+	
+	for(i = 0; i < n; i++)
+	{
+		v |= (uint64_t) bits[i] << i;
+	}
+	
+	return(v);
+}
+
+static int _compare(const asic10_t *a, const _ref_t *r, int step)
+{
+	if(a->shift_register[0] == _pack(&r->shift_register[0], 64) &&
+	   a->shift_register[1] == _pack(&r->shift_register[64], 41) &&
+	   a->fifo_buffer == _pack(r->fifo_buffer, 64) &&
+	   a->iterations == r->iterations &&
+	   a->crypto_enabled == r->crypto_enabled &&
+	   a->decoder_capture == r->decoder_capture &&
+	   a->read_pointer == r->read_pointer)
+	{
+		return(0);
+	}
+	
+	fprintf(stderr, "State mismatch at step %d\n", step);
+	
+	return(-1);
+}
+
+static void _send(asic10_t *a, _ref_t *r, const uint8_t *c)
+{
+	asic_send(a, c, 2);
+	_ref_command(r, c);
+}
+
+int main(int argc, char *argv[])
+{
+	static const uint8_t loads[5] = { 0x51, 0x61, 0x71, 0x81, 0x91 };
+	asic10_t asic;
+	_ref_t ref;
+	uint8_t c[2], a, b;
+	int step, i;
+	
+	srand(argc > 1 ? atoi(argv[1]) : 1);
+	
+	asic_reset(&asic);
+	_ref_reset(&ref);
+	
+	/* Random commands. Each byte pushed runs up to 1025 clocks */
+	for(step = 0; step < 20000; step++)
+	{
+		c[0] = 0x01;
+		c[1] = rand();
+		
+		switch(rand() % 10)
+		{
+		case 0:
+			if(rand() % 50 == 0)
+			{
+				asic_reset(&asic);
+				_ref_reset(&ref);
+			}
+			break;
+		
+		case 1: c[0] = 0x21; c[1] &= 7; _send(&asic, &ref, c); break;
+		case 2: c[0] = 0x31; c[1] &= 1; _send(&asic, &ref, c); break;
+		case 3:
+		case 4: c[0] = loads[rand() % 5]; _send(&asic, &ref, c); break;
+		
+		case 5:
+			/* A byte captured from the decoder */
+			asic_send_from_decoder(&asic, &c[1], 1);
+			if(ref.decoder_capture) _ref_push(&ref, c[1]);
+			break;
+		
+		case 6:
+		case 7:
+			/* Read a byte back */
+			c[0] = 0x13;
+			asic_send(&asic, c, 1);
+			_ref_command(&ref, c);
+			
+			a = asic_receive_one(&asic);
+			b = ref.pending_response_byte;
+			
+			if(a != b)
+			{
+				fprintf(stderr, "Response mismatch at step %d: %02X, expected %02X\n", step, a, b);
+				return(-1);
+			}
+			break;
+		
+		default:
+			_send(&asic, &ref, c);
+			break;
+		}
+		
+		if(_compare(&asic, &ref, step) != 0)
+		{
+			return(-1);
+		}
+	}
+	
+	/* A long run of clocks with the largest iteration count */
+	c[0] = 0x21; c[1] = 0x03;
+	_send(&asic, &ref, c);
+	
+	c[0] = 0x31; c[1] = 0xFF;
+	_send(&asic, &ref, c);
+	
+	for(i = 0; i < 8; i++, step++)
+	{
+		c[0] = 0x01;
+		c[1] = rand();
+		_send(&asic, &ref, c);
+		
+		if(_compare(&asic, &ref, step) != 0)
+		{
+			return(-1);
+		}
+	}
+	
+	printf("Videocrypt 10 ASIC matches the reference model\n");
+	
+	return(0);
+}
+
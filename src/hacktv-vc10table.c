@@ -0,0 +1,121 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+/* Converts the flat 64MB Videocrypt 10 rainbow table into the compact
+ * format, which holds only the signatures present. hacktv reads either
+ * format from videocrypt10-data.bin.
+ *
+ * Usage: hacktv-vc10table <flat table> <compact table>
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "videocrypt10-ca.h"
+
+static void _wr32(uint8_t *p, uint32_t v)
+{
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v >> 0;
+}
+
+int main(int argc, char *argv[])
+{
+	uint8_t header[VC10_RAINBOW_HEADER_SIZE];
+	uint8_t sig[4], entry[8];
+	uint32_t key, entries;
+	FILE *fi, *fo;
+	
+	if(argc != 3)
+	{
+		fprintf(stderr, "Usage: %s <flat table> <compact table>\n", argv[0]);
+		return(-1);
+	}
+	
+	fi = fopen(argv[1], "rb");
+	if(!fi)
+	{
+		perror(argv[1]);
+		return(-1);
+	}
+	
+	fo = fopen(argv[2], "wb");
+	if(!fo)
+	{
+		perror(argv[2]);
+		fclose(fi);
+		return(-1);
+	}
+	
+	/* Reserve space for the header, it's written once the index is known */
+	memset(header, 0, sizeof(header));
+	fwrite(header, 1, sizeof(header), fo);
+	
+	/* The flat table is in key order, so the entries
+	 * can be written out as they are found */
+	for(key = entries = 0; key < VC10_RAINBOW_ENTRIES; key++)
+	{
+		if(fread(sig, 1, 4, fi) != 4) break;
+		
+		/* Record the first entry for each top byte */
+		if((key & 0xFFFF) == 0)
+		{
+			_wr32(&header[VC10_RAINBOW_INDEX + (key >> 16) * 4], entries);
+		}
+		
+		/* Skip empty entries */
+		if((sig[0] | sig[1] | sig[2] | sig[3]) == 0)
+		{
+			continue;
+		}
+		
+		_wr32(entry, key);
+		memcpy(&entry[4], sig, 4);
+		fwrite(entry, 1, 8, fo);
+		entries++;
+	}
+	
+	/* A short flat table has no entries for the remaining keys */
+	for(key = (key + 0xFFFF) >> 16; key <= 256; key++)
+	{
+		_wr32(&header[VC10_RAINBOW_INDEX + key * 4], entries);
+	}
+	
+	memcpy(header, VC10_RAINBOW_MAGIC, 8);
+	_wr32(&header[8], entries);
+	
+	fseek(fo, 0, SEEK_SET);
+	fwrite(header, 1, sizeof(header), fo);
+	
+	fclose(fi);
+	
+	if(ferror(fo))
+	{
+		perror(argv[2]);
+		fclose(fo);
+		return(-1);
+	}
+	
+	fclose(fo);
+	
+	fprintf(stderr, "Wrote %u signatures to %s\n", entries, argv[2]);
+	
+	return(0);
+}
+
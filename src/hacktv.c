@@ -141,6 +141,10 @@ static void print_usage(void)
 		"      --secam-field-id-lines <x> Set the number of lines per field used for SECAM field\n"
 		"                                 identification. (1-9, default: 9)\n"
 		"      --json                     Output a JSON array when used with --list-modes.\n"
+		"      --benchmark <seconds>      Render the given length of signal as fast as\n"
+		"                                 possible and report the time taken.\n"
+		"      --stats                    Print buffer fill levels and underrun counts\n"
+		"                                 when transmission ends.\n"
 		"      --version                  Print the version number and exit.\n"
 		"\n"
 		"Input options\n"
@@ -158,6 +162,8 @@ static void print_usage(void)
 		"      --ffmt <format>            Force input file format.\n"
 		"      --fopts <option=value[:option2=value]>\n"
 		"                                 Pass option(s) to ffmpeg.\n"
+		"      --video-buffers <frames>   Number of decoded frames to buffer ahead of\n"
+		"                                 the renderer, 1-64. Default: 8\n"
 		"\n"
 		"HackRF output options\n"
 		"\n"
@@ -217,6 +223,43 @@ static void print_usage(void)
 		"\n"
 		"  If no valid output prefix is provided, file: is assumed.\n"
 		"\n"
+		"Null output options\n"
+		"\n"
+		"  -o, --output null[:convert]    Discard the output. With convert, the samples\n"
+		"                                 are first converted to the --type data type.\n"
+		"\n"
+		"  The null output is the default when --benchmark is used.\n"
+		"\n"
+		"Network output options\n"
+		"\n"
+		"  -o, --output tcp:<host>:<port> Stream samples to a TCP listener.\n"
+		"  -o, --output udp:<host>:<port> Send samples as UDP packets.\n"
+		"  -t, --type <type>              Set the sample data type, as for file output.\n"
+		"\n"
+		"  TCP output is a raw stream of samples. The transmitter waits for the\n"
+		"  receiver if it falls behind.\n"
+		"\n"
+		"  UDP packets carry a 20 byte header with a sequence number and the index\n"
+		"  of the first sample, to allow lost packets to be detected. See rf_net.h.\n"
+		"\n"
+		"Shared memory output options\n"
+		"\n"
+		"  -o, --output shm:<name>        Write samples to a POSIX shared memory ring.\n"
+		"  -t, --type <type>              Set the sample data type, as for file output.\n"
+		"\n"
+		"  Other local processes can map the ring and read the samples without\n"
+		"  copying. One reader can attach, and hacktv then waits for it rather than\n"
+		"  overwrite samples it hasn't read. Other readers never hold hacktv back,\n"
+		"  and detect when they have fallen behind. See rf_shm.h for the layout,\n"
+		"  and hacktv-shmread for an example reader.\n"
+		"\n"
+		"Multiple outputs\n"
+		"\n"
+		"  The -o option can be given up to 8 times to send the same signal to\n"
+		"  several outputs, for example to transmit and record at once. Each\n"
+		"  output runs in its own thread with around half a second of buffering,\n"
+		"  so a short stall in one output does not interrupt the others.\n"
+		"\n"
 		"NOTE: The number of samples per line is rounded to the nearest integer,\n"
 		"which may result in a slight frame rate error.\n"
 		"\n"
@@ -234,10 +277,16 @@ static void print_usage(void)
 		"much of Europe until the end of analogue TV in the 2010s.\n"
 		"\n"
 		"hacktv supports TTI files. The path can be either a single file or a\n"
-		"directory. All files in the directory will be loaded.\n"
+		"directory. All files in the directory will be loaded, and on Linux they\n"
+		"are reloaded when changed.\n"
 		"\n"
 		"Raw packet sources are also supported with the raw:<source> path name.\n"
 		"The input is expected to be 42 byte teletext packets. Use - for stdin.\n"
+		"Raw files loop between their first and last page headers.\n"
+		"\n"
+		"Several sources can be combined with a comma separated list, such as\n"
+		"raw:capture.t42,pages/. Each magazine is taken from the first raw source\n"
+		"that carries it. TTI pages fill the magazines that are left.\n"
 		"\n"
 		"Lines 7-22 and 320-335 are used, 16 lines per field.\n"
 		"\n"
@@ -432,6 +481,264 @@ static void _list_modes(int json)
 	if(json) printf("]\n");
 }
 
+/* Benchmark state */
+typedef struct {
+	int64_t limit;   /* Number of samples to render */
+	int64_t samples; /* Samples rendered so far */
+	int64_t start;   /* Start time (ns) */
+	int64_t render;  /* Time spent in vid_next_line() (ns) */
+	int64_t sink;    /* Time spent in the RF sink (ns) */
+} _benchmark_t;
+
+static void _print_benchmark(hacktv_t *s, _benchmark_t *bm)
+{
+	double wall = (double) (time_ns() - bm->start) / 1e9;
+	double signal = (double) bm->samples / s->vid.sample_rate;
+	int i;
+	
+	if(wall <= 0) return;
+	
+	fprintf(stderr, "\nBenchmark: %.2f seconds of signal in %.2f seconds\n", signal, wall);
+	fprintf(stderr, "  Real-time factor: %.2fx\n", signal / wall);
+	fprintf(stderr, "  Throughput: %.2f MS/s\n", bm->samples / wall / 1e6);
+	fprintf(stderr, "  Render: %8.3f s %5.1f%%\n", bm->render / 1e9, bm->render / 1e7 / wall);
+	fprintf(stderr, "  Sink:   %8.3f s %5.1f%%\n", bm->sink / 1e9, bm->sink / 1e7 / wall);
+	
+	/* Threaded stages run concurrently with the main
+	 * thread, and may add up to more than 100% */
+	fprintf(stderr, "\nPer-stage time (* = separate thread):\n");
+	fprintf(stderr, "  %-16s %8.3f s %5.1f%%\n", "source",
+		s->vid.vframe_time / 1e9, s->vid.vframe_time / 1e7 / wall
+	);
+	
+	for(i = 0; i < s->vid.nprocesses; i++)
+	{
+		_lineprocess_t *p = &s->vid.processes[i];
+		
+		if(p->process == NULL) continue;
+		
+		fprintf(stderr, "  %-15s%c %8.3f s %5.1f%%\n",
+			p->name, p->thread ? '*' : ' ',
+			p->time / 1e9, p->time / 1e7 / wall
+		);
+	}
+}
+
+static char *_next_input(hacktv_t *s, int argc, char *argv[], int *c)
+{
+	char *pre;
+	int i, l;
+	
+	/* Start the list, or go back to the beginning when repeating */
+	if(*c < 0 || (*c >= argc && s->repeat))
+	{
+		*c = optind;
+		
+		if(s->shuffle)
+		{
+			/* Shuffle the input source list */
+			/* Avoids moving the last entry to the start
+			 * to prevent it repeating immediately */
+			for(i = optind; i < argc - 1; i++)
+			{
+				l = i + (rand() % (argc - i - (i == optind ? 1 : 0)));
+				pre = argv[i];
+				argv[i] = argv[l];
+				argv[l] = pre;
+			}
+		}
+	}
+	
+	if(*c >= argc)
+	{
+		/* No more inputs */
+		return(NULL);
+	}
+	
+	return(argv[(*c)++]);
+}
+
+static int _open_input(hacktv_t *s, av_t *av, char *input)
+{
+	char *pre, *sub;
+	int l;
+	
+	/* Get a pointer to the input prefix and target */
+	pre = input;
+	sub = strchr(pre, ':');
+	
+	if(sub != NULL)
+	{
+		l = sub - pre;
+		sub++;
+	}
+	else
+	{
+		l = strlen(pre);
+	}
+	
+	if(strncmp(pre, "test", l) == 0)
+	{
+		return(av_test_open(av, sub, &s->vid.conf));
+	}
+	else if(strncmp(pre, "ffmpeg", l) == 0)
+	{
+		return(av_ffmpeg_open(&s->vid, av, sub, s->ffmt, s->fopts));
+	}
+	
+	return(av_ffmpeg_open(&s->vid, av, pre, s->ffmt, s->fopts));
+}
+
+/* Next input, opened in the background while the current one plays */
+typedef struct {
+	hacktv_t *s;
+	int argc;
+	char **argv;
+	int c;
+	av_t av;
+	int r;
+	int running;
+	pthread_t thread;
+} _prefetch_t;
+
+static void *_prefetch_thread(void *arg)
+{
+	_prefetch_t *p = arg;
+	char *input;
+	int i;
+	
+	/* Try each input in turn until one opens. The decoder
+	 * threads start here, and run until their buffers fill */
+	for(i = optind; i < p->argc && !_abort; i++)
+	{
+		input = _next_input(p->s, p->argc, p->argv, &p->c);
+		if(input == NULL) break;
+		
+		p->r = _open_input(p->s, &p->av, input);
+		if(p->r == AV_OK) break;
+		
+		/* Don't leave a half open source to be closed later */
+		p->av.av_source_ctx = NULL;
+		p->av.read_video = NULL;
+		p->av.read_audio = NULL;
+		p->av.close = NULL;
+		p->av.av_font = NULL;
+	}
+	
+	return(NULL);
+}
+
+static void _prefetch_start(_prefetch_t *p)
+{
+	/* Open with the same settings as the current source */
+	p->av = p->s->vid.av;
+	p->av.av_source_ctx = NULL;
+	p->av.read_video = NULL;
+	p->av.read_audio = NULL;
+	p->av.close = NULL;
+	p->av.av_font = NULL;
+	p->r = AV_EOF;
+	
+	p->running = pthread_create(&p->thread, NULL, &_prefetch_thread, (void *) p) == 0;
+	
+	if(!p->running)
+	{
+		/* Open it now instead */
+		_prefetch_thread(p);
+	}
+}
+
+static int _prefetch_wait(_prefetch_t *p)
+{
+	if(p->running)
+	{
+		pthread_join(p->thread, NULL);
+		p->running = 0;
+	}
+	
+	return(p->r);
+}
+
+static int _open_output(hacktv_t *s, rf_t *rf, const char *type, char *output)
+{
+	if(strcmp(type, "hackrf") == 0)
+	{
+#ifdef HAVE_HACKRF
+		if(rf_hackrf_open(rf, output, s->vid.sample_rate, s->frequency, s->gain, s->amp, s->vid.conf.output_type == RF_INT16_REAL) != RF_OK)
+		{
+			return(RF_ERROR);
+		}
+#else
+		fprintf(stderr, "HackRF support is not available in this build of hacktv.\n");
+		return(RF_ERROR);
+#endif
+	}
+	else if(strcmp(type, "soapysdr") == 0)
+	{
+#ifdef HAVE_SOAPYSDR
+		if(rf_soapysdr_open(rf, output, s->vid.sample_rate, s->frequency, s->gain, s->antenna) != RF_OK)
+		{
+			return(RF_ERROR);
+		}
+#else
+		fprintf(stderr, "SoapySDR support is not available in this build of hacktv.\n");
+		return(RF_ERROR);
+#endif
+	}
+	else if(strcmp(type, "fl2k") == 0)
+	{
+#ifdef HAVE_FL2K
+		if(rf_fl2k_open(rf, output, s->vid.sample_rate, s->vid.conf.output_type == RF_INT16_REAL && s->vid.conf.s_video == 0, s->fl2k_audio) != RF_OK)
+		{
+			return(RF_ERROR);
+		}
+#else
+		fprintf(stderr, "FL2K support is not available in this build of hacktv.\n");
+		return(RF_ERROR);
+#endif
+	}
+	else if(strcmp(type, "null") == 0)
+	{
+		if(rf_null_open(rf, s->file_type, s->vid.conf.output_type == RF_INT16_COMPLEX || s->vid.conf.s_video, output && strcmp(output, "convert") == 0) != RF_OK)
+		{
+			return(RF_ERROR);
+		}
+	}
+	else if(strcmp(type, "tcp") == 0 || strcmp(type, "udp") == 0)
+	{
+#ifdef HAVE_RF_NET
+		if(rf_net_open(rf, output, strcmp(type, "tcp") == 0 ? RF_NET_TCP : RF_NET_UDP, s->file_type, s->vid.conf.output_type == RF_INT16_COMPLEX || s->vid.conf.s_video) != RF_OK)
+		{
+			return(RF_ERROR);
+		}
+#else
+		fprintf(stderr, "Network output is not available in this build of hacktv.\n");
+		return(RF_ERROR);
+#endif
+	}
+	else if(strcmp(type, "shm") == 0)
+	{
+#ifdef HAVE_RF_SHM
+		if(rf_shm_open(rf, output, s->vid.sample_rate, s->file_type, s->vid.conf.output_type == RF_INT16_COMPLEX || s->vid.conf.s_video) != RF_OK)
+		{
+			return(RF_ERROR);
+		}
+#else
+		fprintf(stderr, "Shared memory output is not available in this build of hacktv.\n");
+		return(RF_ERROR);
+#endif
+	}
+	else if(strcmp(type, "file") == 0)
+	{
+		if(rf_file_open(rf, output, s->file_type, s->vid.conf.output_type == RF_INT16_COMPLEX || s->vid.conf.s_video) != RF_OK)
+		{
+			return(RF_ERROR);
+		}
+	}
+	
+	return(RF_OK);
+}
+
 enum {
 	_OPT_TELETEXT = 1000,
 	_OPT_WSS,
@@ -496,6 +803,7 @@ enum {
 	_OPT_SECAM_FIELD_ID_LINES,
 	_OPT_FFMT,
 	_OPT_FOPTS,
+	_OPT_VIDEO_BUFFERS,
 	_OPT_PIXELRATE,
 	_OPT_LIST_MODES,
 	_OPT_JSON,
@@ -507,6 +815,8 @@ enum {
 	_OPT_PILLARBOX,
 	_OPT_FL2K_AUDIO,
 	_OPT_THREADS,
+	_OPT_BENCHMARK,
+	_OPT_STATS,
 	_OPT_VERSION,
 };
 
@@ -594,6 +904,7 @@ int main(int argc, char *argv[])
 		{ "json",           no_argument,       0, _OPT_JSON },
 		{ "ffmt",           required_argument, 0, _OPT_FFMT },
 		{ "fopts",          required_argument, 0, _OPT_FOPTS },
+		{ "video-buffers",  required_argument, 0, _OPT_VIDEO_BUFFERS },
 		{ "frequency",      required_argument, 0, 'f' },
 		{ "amp",            no_argument,       0, 'a' },
 		{ "gain",           required_argument, 0, 'g' },
@@ -610,14 +921,18 @@ int main(int argc, char *argv[])
 		{ "fl2k-audio",     required_argument, 0, _OPT_FL2K_AUDIO },
 		{ "showecm",        no_argument,       0, _OPT_SHOW_ECM },
 		{ "threads",        no_argument,       0, _OPT_THREADS },
+		{ "benchmark",      required_argument, 0, _OPT_BENCHMARK },
+		{ "stats",          no_argument,       0, _OPT_STATS },
 		{ "version",        no_argument,       0, _OPT_VERSION },
 		{ 0,                0,                 0,  0  }
 	};
 	static hacktv_t s;
+	static _prefetch_t next;
+	_benchmark_t bm = { 0 };
 	const vid_configs_t *vid_confs;
 	vid_config_t vid_conf;
 	char *pre, *sub;
-	int l;
+	char *output_type, *output;
 	int r;
 	r64_t rn;
 	
@@ -631,8 +946,7 @@ int main(int argc, char *argv[])
 	memset(&s, 0, sizeof(hacktv_t));
 	
 	/* Default configuration */
-	s.output_type = "hackrf";
-	s.output = NULL;
+	s.noutputs = 0;
 	s.mode = "i";
 	s.samplerate = 20250000;
 	s.pixelrate = 0;
@@ -720,23 +1034,43 @@ int main(int argc, char *argv[])
 			/* Try to match the prefix with a known type */
 			if(strcmp(pre, "file") == 0)
 			{
-				s.output_type = "file";
-				s.output = sub;
+				output_type = "file";
+				output = sub;
 			}
 			else if(strcmp(pre, "hackrf") == 0)
 			{
-				s.output_type = "hackrf";
-				s.output = sub;
+				output_type = "hackrf";
+				output = sub;
 			}
 			else if(strcmp(pre, "soapysdr") == 0)
 			{
-				s.output_type = "soapysdr";
-				s.output = sub;
+				output_type = "soapysdr";
+				output = sub;
 			}
 			else if(strcmp(pre, "fl2k") == 0)
 			{
-				s.output_type = "fl2k";
-				s.output = sub;
+				output_type = "fl2k";
+				output = sub;
+			}
+			else if(strcmp(pre, "null") == 0)
+			{
+				output_type = "null";
+				output = sub;
+			}
+			else if(strcmp(pre, "tcp") == 0)
+			{
+				output_type = "tcp";
+				output = sub;
+			}
+			else if(strcmp(pre, "udp") == 0)
+			{
+				output_type = "udp";
+				output = sub;
+			}
+			else if(strcmp(pre, "shm") == 0)
+			{
+				output_type = "shm";
+				output = sub;
 			}
 			else
 			{
@@ -746,10 +1080,20 @@ int main(int argc, char *argv[])
 					*colon = ':';
 				}
 				
-				s.output_type = "file";
-				s.output = pre;
+				output_type = "file";
+				output = pre;
+			}
+			
+			if(s.noutputs == RF_MULTI_MAX_SINKS)
+			{
+				fprintf(stderr, "Too many outputs.\n");
+				return(-1);
 			}
 			
+			s.output_type[s.noutputs] = output_type;
+			s.output[s.noutputs] = output;
+			s.noutputs++;
+			
 			break;
 		
 		case 'm': /* -m, --mode <name> */
@@ -1139,6 +1483,17 @@ int main(int argc, char *argv[])
 			s.fopts = optarg;
 			break;
 		
+		case _OPT_VIDEO_BUFFERS: /* --video-buffers <frames> */
+			s.video_buffers = strtol(optarg, NULL, 0);
+			
+			if(s.video_buffers < 1 || s.video_buffers > 64)
+			{
+				fprintf(stderr, "Video buffers must be between 1 and 64.\n");
+				return(-1);
+			}
+			
+			break;
+		
 		case 'f': /* -f, --frequency <value> */
 			s.frequency = (uint64_t) strtod(optarg, NULL);
 			break;
@@ -1215,6 +1570,21 @@ int main(int argc, char *argv[])
 			
 			break;
 		
+		case _OPT_BENCHMARK: /* --benchmark <seconds> */
+			
+			s.benchmark = atof(optarg);
+			if(s.benchmark <= 0)
+			{
+				fprintf(stderr, "Invalid benchmark length\n");
+				return(-1);
+			}
+			
+			break;
+		
+		case _OPT_STATS: /* --stats */
+			s.stats = 1;
+			break;
+		
 		case _OPT_VERSION: /* --version */
 			print_version();
 			return(0);
@@ -1237,6 +1607,14 @@ int main(int argc, char *argv[])
 		return(-1);
 	}
 	
+	if(s.noutputs == 0)
+	{
+		/* Benchmarks default to the null output */
+		s.output_type[0] = s.benchmark > 0 ? "null" : "hackrf";
+		s.output[0] = NULL;
+		s.noutputs = 1;
+	}
+	
 	/* Load the mode configuration */
 	for(vid_confs = vid_configs; vid_confs->id != NULL; vid_confs++)
 	{
@@ -1688,6 +2066,7 @@ int main(int argc, char *argv[])
 	vid_conf.cps = s.cps;
 	vid_conf.secam_field_id = s.secam_field_id;
 	vid_conf.secam_field_id_lines = s.secam_field_id_lines;
+	vid_conf.benchmark = s.benchmark > 0;
 	
 	/* Setup video encoder */
 	r = vid_init(&s.vid, s.samplerate, s.pixelrate, &vid_conf);
@@ -1699,55 +2078,41 @@ int main(int argc, char *argv[])
 	
 	vid_info(&s.vid);
 	
-	if(strcmp(s.output_type, "hackrf") == 0)
+	if(s.noutputs == 1)
 	{
-#ifdef HAVE_HACKRF
-		if(rf_hackrf_open(&s.rf, s.output, s.vid.sample_rate, s.frequency, s.gain, s.amp, s.vid.conf.output_type == RF_INT16_REAL) != RF_OK)
-		{
-			vid_free(&s.vid);
-			return(-1);
-		}
-#else
-		fprintf(stderr, "HackRF support is not available in this build of hacktv.\n");
-		vid_free(&s.vid);
-		return(-1);
-#endif
+		r = _open_output(&s, &s.rf, s.output_type[0], s.output[0]);
 	}
-	else if(strcmp(s.output_type, "soapysdr") == 0)
+	else if((r = rf_multi_open(&s.rf, s.vid.sample_rate)) == RF_OK)
 	{
-#ifdef HAVE_SOAPYSDR
-		if(rf_soapysdr_open(&s.rf, s.output, s.vid.sample_rate, s.frequency, s.gain, s.antenna) != RF_OK)
+		/* Feed each output from a single render */
+		for(c = 0; c < s.noutputs && r == RF_OK; c++)
 		{
-			vid_free(&s.vid);
-			return(-1);
+			rf_t rf = { 0 };
+			
+			r = _open_output(&s, &rf, s.output_type[c], s.output[c]);
+			
+			if(r == RF_OK)
+			{
+				r = rf_multi_add(&s.rf, &rf);
+			}
 		}
-#else
-		fprintf(stderr, "SoapySDR support is not available in this build of hacktv.\n");
-		vid_free(&s.vid);
-		return(-1);
-#endif
-	}
-	else if(strcmp(s.output_type, "fl2k") == 0)
-	{
-#ifdef HAVE_FL2K
-		if(rf_fl2k_open(&s.rf, s.output, s.vid.sample_rate, s.vid.conf.output_type == RF_INT16_REAL && s.vid.conf.s_video == 0, s.fl2k_audio) != RF_OK)
+		
+		if(r != RF_OK)
 		{
-			vid_free(&s.vid);
-			return(-1);
+			rf_close(&s.rf);
 		}
-#else
-		fprintf(stderr, "FL2K support is not available in this build of hacktv.\n");
+	}
+	
+	if(r != RF_OK)
+	{
 		vid_free(&s.vid);
 		return(-1);
-#endif
 	}
-	else if(strcmp(s.output_type, "file") == 0)
+	
+	if(s.stats)
 	{
-		if(rf_file_open(&s.rf, s.output, s.file_type, s.vid.conf.output_type == RF_INT16_COMPLEX || s.vid.conf.s_video) != RF_OK)
-		{
-			vid_free(&s.vid);
-			return(-1);
-		}
+		/* The outputs print their statistics when closed */
+		rf_stats(&s.rf);
 	}
 	
 	av_ffmpeg_init();
@@ -1768,6 +2133,9 @@ int main(int argc, char *argv[])
 		.width = s.vid.active_width,
 		.height = s.vid.conf.active_lines,
 		.sample_rate = (r64_t) { HACKTV_AUDIO_SAMPLE_RATE, 1 },
+		.allow_yuv = vid_allow_yuv(&s.vid),
+		.video_buffers = s.video_buffers,
+		.stats = s.stats,
 	};
 	
 	if((s.vid.conf.frame_orientation & 3) == VID_ROTATE_90 ||
@@ -1778,79 +2146,99 @@ int main(int argc, char *argv[])
 		s.vid.av.height = s.vid.active_width;
 	}
 	
-	do
+	if(s.benchmark > 0)
 	{
-		if(s.shuffle)
-		{
-			/* Shuffle the input source list */
-			/* Avoids moving the last entry to the start
-			 * to prevent it repeating immediately */
-			for(c = optind; c < argc - 1; c++)
-			{
-				l = c + (rand() % (argc - c - (c == optind ? 1 : 0)));
-				pre = argv[c];
-				argv[c] = argv[l];
-				argv[l] = pre;
-			}
-		}
+		bm.limit = s.benchmark * s.vid.sample_rate;
+		bm.start = time_ns();
+	}
+	
+	/* Each input is opened while the one before it plays,
+	 * so there is no gap in the signal between them */
+	next = (_prefetch_t) {
+		.s = &s,
+		.argc = argc,
+		.argv = argv,
+		.c = -1,
+	};
+	
+	_prefetch_start(&next);
+	
+	while(!_abort && _prefetch_wait(&next) == AV_OK)
+	{
+		/* Switch to the new source, closing the old one */
+		vid_av_switch(&s.vid, &next.av);
+		
+		/* Start opening the input after this one */
+		_prefetch_start(&next);
 		
-		for(c = optind; c < argc && !_abort; c++)
+		while(!_abort)
 		{
-			/* Get a pointer to the output prefix and target */
-			pre = argv[c];
-			sub = strchr(pre, ':');
+			vid_line_t *line;
+			int64_t t = 0;
 			
-			if(sub != NULL)
-			{
-				l = sub - pre;
-				sub++;
-			}
-			else
+			if(s.benchmark > 0)
 			{
-				l = strlen(pre);
+				if(bm.samples >= bm.limit)
+				{
+					/* Benchmark complete, stop here */
+					_abort = 1;
+					break;
+				}
+				
+				t = time_ns();
 			}
 			
-			if(strncmp(pre, "test", l) == 0)
-			{
-				r = av_test_open(&s.vid.av, sub, &s.vid.conf);
-			}
-			else if(strncmp(pre, "ffmpeg", l) == 0)
-			{
-				r = av_ffmpeg_open(&s.vid, &s.vid.conf, sub, s.ffmt, s.fopts);
-			}
-			else
-			{
-				r = av_ffmpeg_open(&s.vid, &s.vid.conf, pre, s.ffmt, s.fopts);
-			}
+			line = vid_next_line(&s.vid);
 			
-			if(r != AV_OK)
-			{
-				/* Error opening this source. Move to the next */
-				continue;
-			}
+			if(line == NULL) break;
 			
-			while(!_abort)
+			if(s.benchmark > 0)
 			{
-				vid_line_t *line = vid_next_line(&s.vid);
-				
-				if(line == NULL) break;
-				
-				if(rf_write(&s.rf, line->output, line->width) != RF_OK) break;
-				if(line->audio_len && rf_write_audio(&s.rf, line->audio, line->audio_len) != RF_OK) break;
+				bm.samples += line->width;
+				bm.render += time_ns() - t;
+				t = time_ns();
 			}
 			
-			if(_signal)
+			if(rf_write(&s.rf, line->output, line->width) != RF_OK) break;
+			if(line->audio_len && rf_write_audio(&s.rf, line->audio, line->audio_len) != RF_OK) break;
+			
+			if(s.benchmark > 0)
 			{
-				fprintf(stderr, "Caught signal %d\n", _signal);
-				_signal = 0;
+				bm.sink += time_ns() - t;
 			}
-			
-			av_close(&s.vid.av);
 		}
+		
+		if(_signal)
+		{
+			fprintf(stderr, "Caught signal %d\n", _signal);
+			_signal = 0;
+		}
+	}
+	
+	/* Close the input opened ahead, if any */
+	_prefetch_wait(&next);
+	av_close(&next.av);
+	
+	vid_av_close(&s.vid);
+	
+	if(s.benchmark > 0)
+	{
+		_print_benchmark(&s, &bm);
 	}
-	while(s.repeat && !_abort);
 	
+	if(s.stats)
+	{
+		fprintf(stderr, "\nBuffer statistics:\n");
+	}
+	
+	/* Stop the outputs before printing anything they read */
 	rf_close(&s.rf);
+	
+	if(s.stats)
+	{
+		vid_print_stats(&s.vid);
+	}
+	
 	vid_free(&s.vid);
 	
 	av_ffmpeg_deinit();
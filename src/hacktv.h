@@ -33,8 +33,9 @@
 typedef struct {
 	
 	/* Configuration */
-	char *output_type;
-	char *output;
+	char *output_type[RF_MULTI_MAX_SINKS];
+	char *output[RF_MULTI_MAX_SINKS];
+	int noutputs;
 	char *mode;
 	int samplerate;
 	int pixelrate;
@@ -114,7 +115,10 @@ typedef struct {
 	int json;
 	char *ffmt;
 	char *fopts;
+	int video_buffers;
 	int fl2k_audio;
+	double benchmark;
+	int stats;
 	
 	/* Video encoder state */
 	vid_t vid;
@@ -85,6 +85,7 @@
 #define MAC_PRBS_SR4_MASK (((uint32_t) 1 << 29) - 1)
 #define MAC_PRBS_SR5_MASK (((uint32_t) 1 << 61) - 1)
 
+#include "des.h"
 #include "eurocrypt.h"
 
 typedef struct {
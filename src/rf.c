@@ -17,6 +17,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "rf.h"
 
 /* RF sink callback handlers */
@@ -40,6 +41,17 @@ int rf_write_audio(rf_t *s, const int16_t *audio, size_t samples)
 	return(RF_OK);
 }
 
+int rf_stats(rf_t *s)
+{
+	/* Print any buffer statistics to stderr on close */
+	if(s->stats)
+	{
+		return(s->stats(s->ctx));
+	}
+	
+	return(RF_OK);
+}
+
 int rf_close(rf_t *s)
 {
 	if(s->close)
@@ -50,3 +62,82 @@ int rf_close(rf_t *s)
 	return(RF_OK);
 }
 
+
+/* Sample format helpers */
+size_t rf_type_size(int type, int complex)
+{
+	size_t size;
+	
+	switch(type)
+	{
+	case RF_UINT8:  size = sizeof(uint8_t);  break;
+	case RF_INT8:   size = sizeof(int8_t);   break;
+	case RF_UINT16: size = sizeof(uint16_t); break;
+	case RF_INT16:  size = sizeof(int16_t);  break;
+	case RF_INT32:  size = sizeof(int32_t);  break;
+	case RF_FLOAT:  size = sizeof(float);    break;
+	default: return(0);
+	}
+	
+	/* Double the size for complex types */
+	return(complex ? size * 2 : size);
+}
+
+void rf_convert(void *dst, const int16_t *iq_data, size_t samples, int type, int complex)
+{
+	size_t i;
+	
+	/* Real outputs only use the I channel */
+	if(complex) samples *= 2;
+	
+	switch(type)
+	{
+	case RF_UINT8:
+		for(i = 0; i < samples; i++, iq_data += 2 - complex)
+		{
+			((uint8_t *) dst)[i] = (*iq_data - INT16_MIN) >> 8;
+		}
+		break;
+	
+	case RF_INT8:
+		for(i = 0; i < samples; i++, iq_data += 2 - complex)
+		{
+			((int8_t *) dst)[i] = *iq_data >> 8;
+		}
+		break;
+	
+	case RF_UINT16:
+		for(i = 0; i < samples; i++, iq_data += 2 - complex)
+		{
+			((uint16_t *) dst)[i] = *iq_data - INT16_MIN;
+		}
+		break;
+	
+	case RF_INT16:
+		if(complex)
+		{
+			memcpy(dst, iq_data, samples * sizeof(int16_t));
+			break;
+		}
+		
+		for(i = 0; i < samples; i++, iq_data += 2)
+		{
+			((int16_t *) dst)[i] = *iq_data;
+		}
+		break;
+	
+	case RF_INT32:
+		for(i = 0; i < samples; i++, iq_data += 2 - complex)
+		{
+			((int32_t *) dst)[i] = (*iq_data << 16) + *iq_data;
+		}
+		break;
+	
+	case RF_FLOAT:
+		for(i = 0; i < samples; i++, iq_data += 2 - complex)
+		{
+			((float *) dst)[i] = (float) *iq_data * (1.0 / 32767.0);
+		}
+		break;
+	}
+}
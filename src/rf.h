@@ -38,6 +38,7 @@
 /* RF output function prototypes */
 typedef int (*rf_write_t)(void *ctx, const int16_t *iq_data, size_t samples);
 typedef int (*rf_write_audio_t)(void *ctx, const int16_t *audio, size_t samples);
+typedef int (*rf_stats_t)(void *ctx);
 typedef int (*rf_close_t)(void *ctx);
 
 typedef struct {
@@ -45,18 +46,31 @@ typedef struct {
 	void *ctx;
 	rf_write_t write;
 	rf_write_t write_audio;
+	rf_stats_t stats;
 	rf_close_t close;
 	
 } rf_t;
 
 extern int rf_write(rf_t *s, const int16_t *iq_data, size_t samples);
 extern int rf_write_audio(rf_t *s, const int16_t *audio, size_t samples);
+
+/* Ask the sink to print its buffer statistics to stderr. They are
+ * printed by rf_close(), once the sink's readers have stopped */
+extern int rf_stats(rf_t *s);
 extern int rf_close(rf_t *s);
 
+/* Sample format helpers for sinks with a configurable output type */
+extern size_t rf_type_size(int type, int complex);
+extern void rf_convert(void *dst, const int16_t *iq_data, size_t samples, int type, int complex);
+
 #include "rf_file.h"
+#include "rf_null.h"
+#include "rf_multi.h"
 #include "rf_hackrf.h"
 #include "rf_soapysdr.h"
 #include "rf_fl2k.h"
+#include "rf_net.h"
+#include "rf_shm.h"
 
 #endif
 
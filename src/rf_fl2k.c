@@ -51,6 +51,8 @@ typedef struct {
 	int pcm_len;
 	fir_int16_t spdif_resampler;
 	
+	int print_stats;
+	
 } fl2k_t;
 
 static void _callback(fl2k_data_info_t *data_info)
@@ -262,6 +264,32 @@ static int _rf_write_audio_spdif(void *private, const int16_t *audio, size_t sam
 	return(r >= 0 ? RF_OK : RF_ERROR);
 }
 
+static void _print_stats(fl2k_t *rf)
+{
+	const char *names[3] = { "fl2k red", "fl2k green", "fl2k blue" };
+	double block_time = (double) FL2K_BUF_LEN / rf->sample_rate;
+	int i;
+	
+	for(i = 0; i < 3; i++)
+	{
+		/* Skip unused channels */
+		if(rf->buffer[i].count == 0) continue;
+		
+		fifo_print_stats(names[i], &rf->buffer[i]);
+		fifo_reader_print_stats(names[i], &rf->reader[i], block_time);
+	}
+}
+
+static int _rf_stats(void *private)
+{
+	fl2k_t *rf = private;
+	
+	/* Printed by _rf_close() once the callbacks have stopped */
+	rf->print_stats = 1;
+	
+	return(RF_OK);
+}
+
 static int _rf_close(void *private)
 {
 	fl2k_t *rf = private;
@@ -277,6 +305,8 @@ static int _rf_close(void *private)
 		fifo_reader_close(&rf->reader[i]);
 	}
 	
+	if(rf->print_stats) _print_stats(rf);
+	
 	for(i = 0; i < 3; i++)
 	{
 		fifo_free(&rf->buffer[i]);
@@ -410,6 +440,7 @@ int rf_fl2k_open(rf_t *s, const char *device, unsigned int sample_rate, int base
 	/* Register the callback functions */
 	s->ctx = rf;
 	s->write = _rf_write;
+	s->stats = _rf_stats;
 	s->close = _rf_close;
 	
 	return(RF_OK);
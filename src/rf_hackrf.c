@@ -72,6 +72,7 @@ typedef struct {
 	/* Stats */
 	uint32_t stats_counter;
 	uint32_t num_shortfalls;
+	int print_stats;
 	
 } hackrf_t;
 
@@ -79,33 +80,38 @@ static int _tx_callback(hackrf_transfer *transfer)
 {
 	hackrf_t *rf = transfer->tx_ctx;
 	size_t l = transfer->valid_length;
-	uint8_t *pbuf, *buf = transfer->buffer;
-	int r;
+	uint8_t *buf = transfer->buffer;
+	fifo_span_t spans[2];
+	size_t r;
+	int i;
 	
-	while(l)
+	/* Take everything that is ready, up to the transfer length */
+	r = fifo_read_span(&rf->buffers_reader, spans, l, 0);
+	
+	if(r == -1)
 	{
-		r = fifo_read(&rf->buffers_reader, (void **) &pbuf, l, 0);
+		/* EOF, stop transmitting */
+		fifo_reader_close(&rf->buffers_reader);
+		return(-1);
+	}
+	
+	for(i = 0; i < 2 && spans[i].length > 0; i++)
+	{
+		memcpy(buf, spans[i].base, spans[i].length);
+		buf += spans[i].length;
+	}
+	
+	fifo_read_commit(&rf->buffers_reader, r);
+	l -= r;
+	
+	if(l > 0)
+	{
+		/* Buffer underrun, fill with zero. The FIFO only counts
+		 * reads that found nothing, so count short ones here */
+		if(rf->buffers_reader.prefill == NULL) fprintf(stderr, "U");
+		if(r > 0) rf->buffers_reader.stats.empty++;
 		
-		if(r == 0)
-		{
-			/* Buffer underrun, fill with zero */
-			if(rf->buffers_reader.prefill == NULL) fprintf(stderr, "U");
-			
-			memset(buf, 0, l);
-			l = 0;
-		}
-		else if(r < 0)
-		{
-			/* EOF, stop transmitting */
-			fifo_reader_close(&rf->buffers_reader);
-			return(-1);
-		}
-		else
-		{
-			memcpy(buf, pbuf, r);
-			l -= r;
-			buf += r;
-		}
+		memset(buf, 0, l);
 	}
 	
 	return(0);
@@ -246,8 +252,10 @@ static void _rf_write_print_stats(hackrf_t *rf, size_t samples)
 static int _rf_write(void *private, const int16_t *iq_data, size_t samples)
 {
 	hackrf_t *rf = private;
-	int8_t *iq8 = NULL;
-	int i, r;
+	fifo_span_t spans[2];
+	int8_t *iq8;
+	size_t i, r;
+	int j;
 	
 	/* Report some stats every ~1 second */
 	_rf_write_print_stats(rf, samples);
@@ -257,29 +265,38 @@ static int _rf_write(void *private, const int16_t *iq_data, size_t samples)
 	
 	while(samples > 0)
 	{
-		r = fifo_write_ptr(&rf->buffers, (void **) &iq8, 1);
+		/* Convert directly into as many free blocks as possible */
+		r = fifo_write_span(&rf->buffers, spans, samples, 1);
 		
-		if(r < 0) break;
+		if(r == -1) break;
 		
-		for(i = 0; i < r && i < samples; i++)
+		for(j = 0; j < 2; j++)
 		{
-			iq8[i] = iq_data[i] >> 8;
+			iq8 = spans[j].base;
+			
+			for(i = 0; i < spans[j].length; i++)
+			{
+				iq8[i] = iq_data[i] >> 8;
+			}
+			
+			iq_data += i;
 		}
 		
-		fifo_write(&rf->buffers, i);
+		fifo_write_commit(&rf->buffers, r);
 		
-		iq_data += i;
-		samples -= i;
+		samples -= r;
 	}
 	
-	return(r >= 0 ? RF_OK : RF_ERROR);
+	return(r != -1 ? RF_OK : RF_ERROR);
 }
 
 static int _rf_write_baseband(void *private, const int16_t *iq_data, size_t samples)
 {
 	hackrf_t *rf = private;
-	int8_t *iq8 = NULL;
-	int i, r = 0;
+	fifo_span_t spans[2];
+	int8_t *iq8;
+	size_t i, r = 0;
+	int j;
 	
 	/* Report some stats every ~1 second */
 	_rf_write_print_stats(rf, samples);
@@ -288,24 +305,30 @@ static int _rf_write_baseband(void *private, const int16_t *iq_data, size_t samp
 	
 	while(samples > 0)
 	{
-		r = fifo_write_ptr(&rf->buffers, (void **) &iq8, 1);
+		r = fifo_write_span(&rf->buffers, spans, samples, 1);
 		
-		if(r < 0) break;
+		if(r == -1) break;
 		
-		for(i = 0; i < r && i < samples; i += 2)
+		for(j = 0; j < 2; j++)
 		{
-			int sync = (iq_data[i] > -9000);
-			iq8[i + 0] = (iq_data[i] >> 1) & 0xFF;
-			iq8[i + 1] = ((iq_data[i] >> 9) & 0x7F) | (sync << 7);
+			iq8 = spans[j].base;
+			
+			for(i = 0; i < spans[j].length; i += 2)
+			{
+				int sync = (iq_data[i] > -9000);
+				iq8[i + 0] = (iq_data[i] >> 1) & 0xFF;
+				iq8[i + 1] = ((iq_data[i] >> 9) & 0x7F) | (sync << 7);
+			}
+			
+			iq_data += i;
 		}
 		
-		fifo_write(&rf->buffers, i);
+		fifo_write_commit(&rf->buffers, r);
 		
-		iq_data += i;
-		samples -= i;
+		samples -= r;
 	}
 	
-	return(r >= 0 ? RF_OK : RF_ERROR);
+	return(r != -1 ? RF_OK : RF_ERROR);
 }
 
 static int _rf_write_baseband_audio(void *private, const int16_t *audio, size_t samples)
@@ -337,6 +360,30 @@ static int _rf_write_baseband_audio(void *private, const int16_t *audio, size_t
 	return(RF_OK);
 }
 
+static void _print_stats(hackrf_t *rf)
+{
+	/* Each block holds TRANSFER_BUFFER_SIZE / 2 samples in either mode */
+	fifo_print_stats("hackrf", &rf->buffers);
+	fifo_reader_print_stats("hackrf", &rf->buffers_reader, (double) TRANSFER_BUFFER_SIZE / 2 / rf->sample_rate);
+	
+	if(rf->audio_buffers.count > 0)
+	{
+		/* 10ms audio blocks */
+		fifo_print_stats("hackdac audio", &rf->audio_buffers);
+		fifo_reader_print_stats("hackdac audio", &rf->audio_buffers_reader, 0.010);
+	}
+}
+
+static int _rf_stats(void *private)
+{
+	hackrf_t *rf = private;
+	
+	/* Printed by _rf_close() once the callbacks have stopped */
+	rf->print_stats = 1;
+	
+	return(RF_OK);
+}
+
 static int _rf_close(void *private)
 {
 	hackrf_t *rf = private;
@@ -345,8 +392,13 @@ static int _rf_close(void *private)
 	fifo_close(&rf->buffers);
 	if(rf->audio_buffers.count) fifo_close(&rf->audio_buffers);
 	
-	fifo_free(&rf->buffers);
-	if(rf->audio_buffers.count) fifo_free(&rf->audio_buffers);
+	/* Let the callback send what is still buffered. It closes
+	 * the readers itself when it reaches the end */
+	while(hackrf_is_streaming(rf->d) == HACKRF_TRUE &&
+	      __atomic_load_n(&rf->buffers_reader.eof, __ATOMIC_SEQ_CST) == 0)
+	{
+		usleep(1000);
+	}
 	
 	r = hackrf_stop_tx(rf->d);
 	if(r != HACKRF_SUCCESS)
@@ -361,6 +413,16 @@ static int _rf_close(void *private)
 		usleep(100);
 	}
 	
+	/* The callbacks have stopped reading. Release the readers in case
+	 * they stopped before the end, or fifo_free() would wait on them */
+	fifo_reader_close(&rf->buffers_reader);
+	fifo_reader_close(&rf->audio_buffers_reader);
+	
+	if(rf->print_stats) _print_stats(rf);
+	
+	fifo_free(&rf->buffers);
+	if(rf->audio_buffers.count) fifo_free(&rf->audio_buffers);
+	
 	r = hackrf_close(rf->d);
 	if(r != HACKRF_SUCCESS)
 	{
@@ -555,6 +617,7 @@ int rf_hackrf_open(rf_t *s, const char *serial, uint32_t sample_rate, uint64_t f
 	s->ctx = rf;
 	s->write = baseband ? _rf_write_baseband : _rf_write;
 	s->write_audio = baseband ? _rf_write_baseband_audio : NULL;
+	s->stats = _rf_stats;
 	s->close = _rf_close;
 	
 	return(RF_OK);
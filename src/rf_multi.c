@@ -0,0 +1,328 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "rf.h"
+#include "fifo.h"
+
+/* Samples per FIFO block, and the length of the FIFO in seconds */
+#define _BLOCK_SAMPLES 65536
+#define _FIFO_SECONDS  0.5
+
+/* Audio FIFO, 1 second at 32khz stereo */
+#define _AUDIO_BLOCKS 100
+#define _AUDIO_BLOCK_LEN (320 * sizeof(int16_t) * 2)
+
+typedef struct {
+	
+	rf_t rf;
+	
+	fifo_reader_t reader;
+	fifo_reader_t audio_reader;
+	
+	pthread_t thread;
+	int running;
+	int error;
+	
+} _rf_multi_sink_t;
+
+typedef struct {
+	
+	unsigned int sample_rate;
+	
+	/* IQ samples, interleaved int16 */
+	fifo_t fifo;
+	
+	/* Audio samples, for sinks that accept them */
+	fifo_t audio;
+	int have_audio;
+	
+	int nsinks;
+	_rf_multi_sink_t sinks[RF_MULTI_MAX_SINKS];
+	
+	int print_stats;
+	
+} rf_multi_t;
+
+static void *_sink_thread(void *arg)
+{
+	_rf_multi_sink_t *sink = arg;
+	fifo_span_t spans[2];
+	int16_t *data;
+	size_t len;
+	int i;
+	
+	while(1)
+	{
+		/* Pass the sink everything that is ready, in up to two parts */
+		len = fifo_read_span(&sink->reader, spans, SIZE_MAX, 1);
+		if(len == -1) break;
+		
+		for(i = 0; i < 2 && spans[i].length > 0; i++)
+		{
+			if(rf_write(&sink->rf, spans[i].base, spans[i].length / sizeof(int16_t) / 2) != RF_OK)
+			{
+				sink->error = 1;
+				break;
+			}
+		}
+		
+		fifo_read_commit(&sink->reader, len);
+		
+		if(sink->error) break;
+		
+		/* Pass on any audio received since the last block */
+		while(sink->rf.write_audio)
+		{
+			len = fifo_read(&sink->audio_reader, (void **) &data, _AUDIO_BLOCK_LEN, 0);
+			if(len == 0 || len == -1) break;
+			
+			if(rf_write_audio(&sink->rf, data, len / sizeof(int16_t)) != RF_OK)
+			{
+				sink->error = 1;
+				break;
+			}
+		}
+		
+		if(sink->error) break;
+	}
+	
+	/* Release the FIFOs so a failed sink doesn't block the others */
+	fifo_reader_close(&sink->reader);
+	
+	if(sink->rf.write_audio)
+	{
+		fifo_reader_close(&sink->audio_reader);
+	}
+	
+	return(NULL);
+}
+
+static int _fifo_write(fifo_t *fifo, const int16_t *data, size_t len)
+{
+	fifo_span_t spans[2];
+	size_t l;
+	int i;
+	
+	while(len > 0)
+	{
+		l = fifo_write_span(fifo, spans, len, 1);
+		if(l == -1) return(RF_ERROR);
+		
+		for(i = 0; i < 2 && spans[i].length > 0; i++)
+		{
+			memcpy(spans[i].base, data, spans[i].length);
+			data = (const int16_t *) ((const uint8_t *) data + spans[i].length);
+		}
+		
+		fifo_write_commit(fifo, l);
+		len -= l;
+	}
+	
+	return(RF_OK);
+}
+
+static int _rf_multi_write(void *private, const int16_t *iq_data, size_t samples)
+{
+	rf_multi_t *rf = private;
+	int i;
+	
+	for(i = 0; i < rf->nsinks; i++)
+	{
+		if(rf->sinks[i].error) return(RF_ERROR);
+	}
+	
+	return(_fifo_write(&rf->fifo, iq_data, samples * sizeof(int16_t) * 2));
+}
+
+static int _rf_multi_write_audio(void *private, const int16_t *audio, size_t samples)
+{
+	rf_multi_t *rf = private;
+	
+	if(!rf->have_audio) return(RF_OK);
+	
+	return(_fifo_write(&rf->audio, audio, samples * sizeof(int16_t)));
+}
+
+static void _print_stats(rf_multi_t *rf)
+{
+	char name[32];
+	int i;
+	
+	fifo_print_stats("multi", &rf->fifo);
+	if(rf->have_audio) fifo_print_stats("multi audio", &rf->audio);
+	
+	for(i = 0; i < rf->nsinks; i++)
+	{
+		_rf_multi_sink_t *sink = &rf->sinks[i];
+		
+		snprintf(name, sizeof(name), "multi %d", i + 1);
+		fifo_reader_print_stats(name, &sink->reader, (double) _BLOCK_SAMPLES / rf->sample_rate);
+		
+		if(sink->rf.write_audio)
+		{
+			snprintf(name, sizeof(name), "multi %d audio", i + 1);
+			fifo_reader_print_stats(name, &sink->audio_reader, 0.010);
+		}
+	}
+}
+
+static int _rf_multi_stats(void *private)
+{
+	rf_multi_t *rf = private;
+	int i;
+	
+	/* Printed by _rf_multi_close() once the sink threads have
+	 * stopped. The sinks print their own buffers when closed */
+	rf->print_stats = 1;
+	
+	for(i = 0; i < rf->nsinks; i++)
+	{
+		rf_stats(&rf->sinks[i].rf);
+	}
+	
+	return(RF_OK);
+}
+
+static int _rf_multi_close(void *private)
+{
+	rf_multi_t *rf = private;
+	int r = RF_OK;
+	int i;
+	
+	/* Signal EOF to the sinks and wait for them to drain */
+	fifo_close(&rf->fifo);
+	if(rf->have_audio) fifo_close(&rf->audio);
+	
+	for(i = 0; i < rf->nsinks; i++)
+	{
+		_rf_multi_sink_t *sink = &rf->sinks[i];
+		
+		if(sink->running)
+		{
+			pthread_join(sink->thread, NULL);
+		}
+	}
+	
+	if(rf->print_stats) _print_stats(rf);
+	
+	for(i = 0; i < rf->nsinks; i++)
+	{
+		_rf_multi_sink_t *sink = &rf->sinks[i];
+		
+		if(rf_close(&sink->rf) != RF_OK || sink->error)
+		{
+			r = RF_ERROR;
+		}
+	}
+	
+	fifo_free(&rf->fifo);
+	if(rf->have_audio) fifo_free(&rf->audio);
+	
+	free(rf);
+	
+	return(r);
+}
+
+int rf_multi_open(rf_t *s, unsigned int sample_rate)
+{
+	rf_multi_t *rf = calloc(1, sizeof(rf_multi_t));
+	size_t count;
+	
+	if(!rf)
+	{
+		perror("calloc");
+		return(RF_ERROR);
+	}
+	
+	rf->sample_rate = sample_rate;
+	
+	count = sample_rate * _FIFO_SECONDS / _BLOCK_SAMPLES;
+	if(count < 4) count = 4;
+	
+	if(fifo_init(&rf->fifo, count, _BLOCK_SAMPLES * sizeof(int16_t) * 2) != 0)
+	{
+		perror("fifo_init");
+		free(rf);
+		return(RF_ERROR);
+	}
+	
+	/* Register the callback functions */
+	s->ctx = rf;
+	s->write = _rf_multi_write;
+	s->write_audio = _rf_multi_write_audio;
+	s->stats = _rf_multi_stats;
+	s->close = _rf_multi_close;
+	
+	return(RF_OK);
+}
+
+int rf_multi_add(rf_t *s, rf_t *sink)
+{
+	rf_multi_t *rf = s->ctx;
+	_rf_multi_sink_t *p;
+	
+	if(rf->nsinks == RF_MULTI_MAX_SINKS)
+	{
+		fprintf(stderr, "%s: Too many outputs\n", __func__);
+		rf_close(sink);
+		return(RF_ERROR);
+	}
+	
+	/* The audio FIFO is only created when a sink needs it */
+	if(sink->write_audio && !rf->have_audio)
+	{
+		if(fifo_init(&rf->audio, _AUDIO_BLOCKS, _AUDIO_BLOCK_LEN) != 0)
+		{
+			perror("fifo_init");
+			rf_close(sink);
+			return(RF_ERROR);
+		}
+		
+		rf->have_audio = 1;
+	}
+	
+	p = &rf->sinks[rf->nsinks++];
+	p->rf = *sink;
+	
+	fifo_reader_init(&p->reader, &rf->fifo, 0);
+	
+	if(p->rf.write_audio)
+	{
+		fifo_reader_init(&p->audio_reader, &rf->audio, 0);
+	}
+	
+	if(pthread_create(&p->thread, NULL, &_sink_thread, p) != 0)
+	{
+		perror("pthread_create");
+		
+		/* The sink is closed along with the others */
+		fifo_reader_close(&p->reader);
+		if(p->rf.write_audio) fifo_reader_close(&p->audio_reader);
+		p->error = 1;
+		
+		return(RF_ERROR);
+	}
+	
+	p->running = 1;
+	
+	return(RF_OK);
+}
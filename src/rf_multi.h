@@ -0,0 +1,32 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _RF_MULTI_H
+#define _RF_MULTI_H
+
+/* Maximum number of sinks fed by a multi-sink */
+#define RF_MULTI_MAX_SINKS 8
+
+/* The multi-sink copies each write into a FIFO, and each sink added
+ * with rf_multi_add() reads from the FIFO in its own thread. A sink
+ * only holds back the others once the FIFO is full. The multi-sink
+ * takes ownership of the added sinks and closes them with itself. */
+extern int rf_multi_open(rf_t *s, unsigned int sample_rate);
+extern int rf_multi_add(rf_t *s, rf_t *sink);
+
+#endif
+
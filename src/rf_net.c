@@ -0,0 +1,569 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#define _GNU_SOURCE 1
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
+#include "rf.h"
+
+/* Use MSG_ZEROCOPY for TCP batches where the kernel supports it */
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define _ZEROCOPY 1
+#endif
+
+/* Size and number of TCP batch buffers. More than one is needed
+ * as a buffer can't be reused until a zerocopy send has completed */
+#define _TCP_BATCH_SIZE (256 * 1024)
+#define _TCP_BATCHES    4
+
+/* Largest UDP packet that avoids fragmentation on a 1500 byte MTU */
+#define _UDP_PACKET_SIZE 1472
+
+/* Number of UDP packets queued per send */
+#define _UDP_PACKETS 64
+
+/* Socket send buffer size */
+#define _SNDBUF_SIZE (4 * 1024 * 1024)
+
+typedef struct {
+	uint8_t *data;
+	size_t length;
+	
+	/* The last zerocopy notification ID used by this batch */
+	int pending;
+	uint32_t id;
+	
+} _net_batch_t;
+
+typedef struct {
+	
+	int fd;
+	int protocol;
+	int type;
+	int complex;
+	size_t sample_size;
+	
+	/* TCP batches */
+	_net_batch_t batch[_TCP_BATCHES];
+	size_t batch_size;
+	int b;
+	
+	/* MSG_ZEROCOPY state */
+	int zerocopy;
+	uint32_t zc_next;
+	uint32_t zc_done;
+	
+	/* UDP packets */
+	uint8_t *packets;
+	size_t payload_size;
+	int npackets;
+	size_t offset;
+	uint32_t seq;
+	uint64_t sample;
+	
+} rf_net_t;
+
+#ifdef _ZEROCOPY
+static int _zc_reap(rf_net_t *rf)
+{
+	struct pollfd pfd = { .fd = rf->fd, .events = 0 };
+	char control[128];
+	struct msghdr msg;
+	struct cmsghdr *cm;
+	struct sock_extended_err *serr;
+	socklen_t len;
+	int r;
+	
+	/* Wait for the error queue to become readable */
+	r = poll(&pfd, 1, -1);
+	if(r < 0)
+	{
+		return(errno == EINTR ? RF_OK : RF_ERROR);
+	}
+	
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+	
+	r = recvmsg(rf->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+	if(r < 0)
+	{
+		if(errno != EAGAIN && errno != EINTR)
+		{
+			perror("recvmsg");
+			return(RF_ERROR);
+		}
+		
+		/* Nothing queued, test for a socket error */
+		len = sizeof(r);
+		if(getsockopt(rf->fd, SOL_SOCKET, SO_ERROR, &r, &len) < 0 || r != 0 ||
+		   (pfd.revents & POLLHUP))
+		{
+			fprintf(stderr, "rf_net: Connection lost\n");
+			return(RF_ERROR);
+		}
+		
+		return(RF_OK);
+	}
+	
+	for(cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm))
+	{
+		if(!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+		   !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))
+		{
+			continue;
+		}
+		
+		serr = (struct sock_extended_err *) CMSG_DATA(cm);
+		if(serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+		{
+			continue;
+		}
+		
+		/* Notifications cover the range ee_info to ee_data */
+		if((int32_t) (serr->ee_data + 1 - rf->zc_done) > 0)
+		{
+			rf->zc_done = serr->ee_data + 1;
+		}
+		
+		if(serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+		{
+			/* The kernel fell back to copying the data (loopback,
+			 * or a device without scatter-gather). Zerocopy only
+			 * adds overhead in this case, so stop using it */
+			rf->zerocopy = 0;
+		}
+	}
+	
+	return(RF_OK);
+}
+#endif
+
+static int _zc_wait(rf_net_t *rf, uint32_t id)
+{
+#ifdef _ZEROCOPY
+	while((int32_t) (rf->zc_done - id) <= 0)
+	{
+		if(_zc_reap(rf) != RF_OK) return(RF_ERROR);
+	}
+#endif
+	
+	return(RF_OK);
+}
+
+static int _send_batch(rf_net_t *rf)
+{
+	_net_batch_t *b = &rf->batch[rf->b];
+	uint8_t *data = b->data;
+	size_t length = b->length;
+	ssize_t r;
+	int flags;
+	
+	while(length > 0)
+	{
+		flags = MSG_NOSIGNAL;
+#ifdef _ZEROCOPY
+		if(rf->zerocopy) flags |= MSG_ZEROCOPY;
+#endif
+		
+		r = send(rf->fd, data, length, flags);
+		
+		if(r < 0)
+		{
+			if(errno == EINTR) continue;
+#ifdef _ZEROCOPY
+			if(errno == ENOBUFS && rf->zerocopy)
+			{
+				/* Out of optmem for zerocopy notifications */
+				rf->zerocopy = 0;
+				continue;
+			}
+#endif
+			perror("send");
+			return(RF_ERROR);
+		}
+		
+#ifdef _ZEROCOPY
+		if(flags & MSG_ZEROCOPY)
+		{
+			/* Each successful zerocopy send uses one notification ID */
+			b->id = rf->zc_next++;
+			b->pending = 1;
+		}
+#endif
+		
+		data += r;
+		length -= r;
+	}
+	
+	/* Advance to the next batch, waiting for it to be free */
+	rf->b = (rf->b + 1) % _TCP_BATCHES;
+	b = &rf->batch[rf->b];
+	b->length = 0;
+	
+	if(b->pending)
+	{
+		b->pending = 0;
+		return(_zc_wait(rf, b->id));
+	}
+	
+	return(RF_OK);
+}
+
+static int _rf_net_write_tcp(void *private, const int16_t *iq_data, size_t samples)
+{
+	rf_net_t *rf = private;
+	_net_batch_t *b = &rf->batch[rf->b];
+	size_t i;
+	
+	while(samples > 0)
+	{
+		i = (rf->batch_size - b->length) / rf->sample_size;
+		if(i > samples) i = samples;
+		
+		rf_convert(b->data + b->length, iq_data, i, rf->type, rf->complex);
+		b->length += i * rf->sample_size;
+		
+		iq_data += i * 2;
+		samples -= i;
+		
+		if(b->length == rf->batch_size)
+		{
+			if(_send_batch(rf) != RF_OK) return(RF_ERROR);
+			b = &rf->batch[rf->b];
+		}
+	}
+	
+	return(RF_OK);
+}
+
+static int _send_packets(rf_net_t *rf)
+{
+	size_t packet_size = RF_NET_HEADER_SIZE + rf->payload_size;
+#ifdef __linux__
+	struct mmsghdr msgs[_UDP_PACKETS];
+#endif
+	struct iovec iov[_UDP_PACKETS];
+	uint8_t *p;
+	size_t length;
+	int i, r;
+	
+	/* Include any partially filled packet */
+	if(rf->offset > 0) rf->npackets++;
+	
+	for(i = 0; i < rf->npackets; i++)
+	{
+		p = rf->packets + packet_size * i;
+		length = (i == rf->npackets - 1 && rf->offset > 0 ? rf->offset : rf->payload_size);
+		
+		p[18] = (length >> 8) & 0xFF;
+		p[19] = (length >> 0) & 0xFF;
+		
+		iov[i].iov_base = p;
+		iov[i].iov_len = RF_NET_HEADER_SIZE + length;
+#ifdef __linux__
+		memset(&msgs[i], 0, sizeof(msgs[i]));
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+#endif
+	}
+	
+	for(i = 0; i < rf->npackets; i += r)
+	{
+#ifdef __linux__
+		r = sendmmsg(rf->fd, &msgs[i], rf->npackets - i, MSG_NOSIGNAL);
+#else
+		r = send(rf->fd, iov[i].iov_base, iov[i].iov_len, MSG_NOSIGNAL) < 0 ? -1 : 1;
+#endif
+		if(r < 0)
+		{
+			if(errno == EINTR)
+			{
+				r = 0;
+				continue;
+			}
+			
+			/* The receiver isn't listening yet, drop the packet */
+			if(errno == ECONNREFUSED)
+			{
+				r = 1;
+				continue;
+			}
+			
+			perror("send");
+			return(RF_ERROR);
+		}
+	}
+	
+	rf->npackets = 0;
+	rf->offset = 0;
+	
+	return(RF_OK);
+}
+
+static int _rf_net_write_udp(void *private, const int16_t *iq_data, size_t samples)
+{
+	rf_net_t *rf = private;
+	size_t packet_size = RF_NET_HEADER_SIZE + rf->payload_size;
+	uint8_t *p;
+	size_t i;
+	int j;
+	
+	while(samples > 0)
+	{
+		p = rf->packets + packet_size * rf->npackets;
+		
+		if(rf->offset == 0)
+		{
+			/* Write the header for a new packet */
+			memcpy(p, RF_NET_MAGIC, 4);
+			for(j = 0; j < 4; j++) p[4 + j] = (rf->seq >> (24 - j * 8)) & 0xFF;
+			for(j = 0; j < 8; j++) p[8 + j] = (rf->sample >> (56 - j * 8)) & 0xFF;
+			p[16] = rf->type;
+			p[17] = rf->complex ? RF_NET_FLAG_COMPLEX : 0;
+			rf->seq++;
+		}
+		
+		i = (rf->payload_size - rf->offset) / rf->sample_size;
+		if(i > samples) i = samples;
+		
+		rf_convert(p + RF_NET_HEADER_SIZE + rf->offset, iq_data, i, rf->type, rf->complex);
+		rf->offset += i * rf->sample_size;
+		rf->sample += i;
+		
+		iq_data += i * 2;
+		samples -= i;
+		
+		if(rf->offset == rf->payload_size)
+		{
+			rf->npackets++;
+			rf->offset = 0;
+			
+			if(rf->npackets == _UDP_PACKETS && _send_packets(rf) != RF_OK)
+			{
+				return(RF_ERROR);
+			}
+		}
+	}
+	
+	return(RF_OK);
+}
+
+static int _rf_net_close(void *private)
+{
+	rf_net_t *rf = private;
+	int i;
+	
+	if(rf->fd >= 0)
+	{
+		/* Flush any remaining data */
+		if(rf->protocol == RF_NET_TCP && rf->batch[rf->b].length > 0)
+		{
+			_send_batch(rf);
+		}
+		else if(rf->protocol == RF_NET_UDP && (rf->npackets > 0 || rf->offset > 0))
+		{
+			_send_packets(rf);
+		}
+		
+		/* Wait for any outstanding zerocopy sends to complete */
+		if(rf->zc_next != rf->zc_done)
+		{
+			_zc_wait(rf, rf->zc_next - 1);
+		}
+		
+		close(rf->fd);
+	}
+	
+	for(i = 0; i < _TCP_BATCHES; i++)
+	{
+		free(rf->batch[i].data);
+	}
+	
+	free(rf->packets);
+	free(rf);
+	
+	return(RF_OK);
+}
+
+static int _connect(rf_net_t *rf, const char *target)
+{
+	struct addrinfo hints, *res, *ai;
+	char host[256];
+	const char *port;
+	size_t l;
+	int r;
+	
+	/* Split the target into host and port, allowing for [ipv6]:port */
+	port = strrchr(target, ':');
+	if(port == NULL || port[1] == '\0')
+	{
+		fprintf(stderr, "rf_net: No port specified in '%s'\n", target);
+		return(RF_ERROR);
+	}
+	
+	l = port - target;
+	if(l > 1 && target[0] == '[' && target[l - 1] == ']')
+	{
+		target++;
+		l -= 2;
+	}
+	
+	if(l >= sizeof(host))
+	{
+		fprintf(stderr, "rf_net: Host name is too long\n");
+		return(RF_ERROR);
+	}
+	
+	memcpy(host, target, l);
+	host[l] = '\0';
+	port++;
+	
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = (rf->protocol == RF_NET_TCP ? SOCK_STREAM : SOCK_DGRAM);
+	
+	r = getaddrinfo(l > 0 ? host : NULL, port, &hints, &res);
+	if(r != 0)
+	{
+		fprintf(stderr, "rf_net: %s: %s\n", host, gai_strerror(r));
+		return(RF_ERROR);
+	}
+	
+	rf->fd = -1;
+	
+	for(ai = res; ai; ai = ai->ai_next)
+	{
+		rf->fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if(rf->fd < 0) continue;
+		
+		if(connect(rf->fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+		
+		close(rf->fd);
+		rf->fd = -1;
+	}
+	
+	freeaddrinfo(res);
+	
+	if(rf->fd < 0)
+	{
+		perror("connect");
+		return(RF_ERROR);
+	}
+	
+	return(RF_OK);
+}
+
+int rf_net_open(rf_t *s, const char *target, int protocol, int type, int complex)
+{
+	rf_net_t *rf;
+	int i;
+	
+	if(target == NULL)
+	{
+		fprintf(stderr, "No output host:port provided.\n");
+		return(RF_ERROR);
+	}
+	
+	rf = calloc(1, sizeof(rf_net_t));
+	if(!rf)
+	{
+		perror("calloc");
+		return(RF_OUT_OF_MEMORY);
+	}
+	
+	rf->fd = -1;
+	rf->protocol = protocol;
+	rf->type = type;
+	rf->complex = complex != 0;
+	
+	rf->sample_size = rf_type_size(type, rf->complex);
+	if(rf->sample_size == 0)
+	{
+		fprintf(stderr, "%s: Unrecognised data type %d\n", __func__, type);
+		_rf_net_close(rf);
+		return(RF_ERROR);
+	}
+	
+	if(_connect(rf, target) != RF_OK)
+	{
+		_rf_net_close(rf);
+		return(RF_ERROR);
+	}
+	
+	/* A large send buffer smooths over short network stalls */
+	i = _SNDBUF_SIZE;
+	setsockopt(rf->fd, SOL_SOCKET, SO_SNDBUF, &i, sizeof(i));
+	
+	if(protocol == RF_NET_TCP)
+	{
+		/* Batches hold a whole number of samples */
+		rf->batch_size = _TCP_BATCH_SIZE / rf->sample_size * rf->sample_size;
+		
+		for(i = 0; i < _TCP_BATCHES; i++)
+		{
+			rf->batch[i].data = malloc(rf->batch_size);
+			if(!rf->batch[i].data)
+			{
+				perror("malloc");
+				_rf_net_close(rf);
+				return(RF_OUT_OF_MEMORY);
+			}
+		}
+		
+#ifdef _ZEROCOPY
+		i = 1;
+		rf->zerocopy = setsockopt(rf->fd, SOL_SOCKET, SO_ZEROCOPY, &i, sizeof(i)) == 0;
+#endif
+		
+		s->write = _rf_net_write_tcp;
+	}
+	else
+	{
+		/* Packets hold a whole number of samples */
+		rf->payload_size = (_UDP_PACKET_SIZE - RF_NET_HEADER_SIZE) / rf->sample_size * rf->sample_size;
+		
+		rf->packets = malloc((RF_NET_HEADER_SIZE + rf->payload_size) * _UDP_PACKETS);
+		if(!rf->packets)
+		{
+			perror("malloc");
+			_rf_net_close(rf);
+			return(RF_OUT_OF_MEMORY);
+		}
+		
+		s->write = _rf_net_write_udp;
+	}
+	
+	/* Register the callback functions */
+	s->ctx = rf;
+	s->close = _rf_net_close;
+	
+	return(RF_OK);
+}
+
@@ -0,0 +1,47 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _RF_NET_H
+#define _RF_NET_H
+
+/* Network protocols */
+#define RF_NET_TCP 0
+#define RF_NET_UDP 1
+
+/* TCP output is a raw stream of samples in the selected format, with no
+ * header. The socket blocks when the receiver falls behind, which in turn
+ * holds back the renderer.
+ *
+ * UDP output is sent as packets of whole samples, each prefixed with the
+ * following 20 byte header. All fields are big-endian:
+ *
+ *  0: Magic "HTV1"
+ *  4: Packet sequence number, uint32
+ *  8: Index of the first sample in this packet, uint64
+ * 16: Sample type (RF_UINT8 .. RF_FLOAT), uint8
+ * 17: Flags, uint8. Bit 0 is set for complex samples
+ * 18: Payload length in bytes, uint16
+*/
+
+#define RF_NET_MAGIC       "HTV1"
+#define RF_NET_HEADER_SIZE 20
+#define RF_NET_FLAG_COMPLEX 0x01
+
+extern int rf_net_open(rf_t *s, const char *target, int protocol, int type, int complex);
+
+#endif
+
@@ -0,0 +1,108 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "rf.h"
+
+/* Null sink */
+typedef struct {
+	void *data;
+	size_t samples;
+	int complex;
+	int type;
+} rf_null_t;
+
+static int _rf_null_write(void *private, const int16_t *iq_data, size_t samples)
+{
+	return(RF_OK);
+}
+
+static int _rf_null_write_convert(void *private, const int16_t *iq_data, size_t samples)
+{
+	rf_null_t *rf = private;
+	size_t i;
+	
+	while(samples)
+	{
+		i = samples < rf->samples ? samples : rf->samples;
+		
+		rf_convert(rf->data, iq_data, i, rf->type, rf->complex);
+		
+		iq_data += i * 2;
+		samples -= i;
+	}
+	
+	return(RF_OK);
+}
+
+static int _rf_null_close(void *private)
+{
+	rf_null_t *rf = private;
+	
+	free(rf->data);
+	free(rf);
+	
+	return(RF_OK);
+}
+
+int rf_null_open(rf_t *s, int type, int complex, int convert)
+{
+	rf_null_t *rf = calloc(1, sizeof(rf_null_t));
+	size_t size;
+	
+	if(!rf)
+	{
+		perror("calloc");
+		return(RF_ERROR);
+	}
+	
+	rf->complex = complex != 0;
+	rf->type = type;
+	
+	if(convert)
+	{
+		size = rf_type_size(type, rf->complex);
+		if(size == 0)
+		{
+			fprintf(stderr, "%s: Unrecognised data type %d\n", __func__, type);
+			_rf_null_close(rf);
+			return(RF_ERROR);
+		}
+		
+		/* Number of samples in the temporary buffer, the
+		 * same as the file sink for a comparable result */
+		rf->samples = 4096;
+		
+		rf->data = malloc(size * rf->samples);
+		if(!rf->data)
+		{
+			perror("malloc");
+			_rf_null_close(rf);
+			return(RF_ERROR);
+		}
+	}
+	
+	/* Register the callback functions */
+	s->ctx = rf;
+	s->write = convert ? _rf_null_write_convert : _rf_null_write;
+	s->close = _rf_null_close;
+	
+	return(RF_OK);
+}
+
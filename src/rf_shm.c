@@ -0,0 +1,239 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "rf.h"
+
+/* Size of the header area, one page so the ring stays page aligned */
+#define _HEADER_SIZE 4096
+
+/* Shared memory sink */
+typedef struct {
+	char *name;
+	void *map;
+	size_t map_size;
+	rf_shm_header_t *header;
+	uint8_t *ring;
+	uint64_t head;
+	uint64_t mask;
+	size_t sample_size;
+	int complex;
+	int type;
+} rf_shm_t;
+
+static uint64_t _rf_shm_space(rf_shm_t *rf)
+{
+	const struct timespec wait = { 0, 100000 };
+	uint32_t pid;
+	int64_t used;
+	int i;
+	
+	for(i = 0; ; i++)
+	{
+		pid = __atomic_load_n(&rf->header->reader_pid, __ATOMIC_ACQUIRE);
+		
+		if(pid == 0)
+		{
+			/* No reader is attached, the whole ring is free */
+			return(rf->mask + 1);
+		}
+		
+		/* Samples the reader hasn't used yet. A tail ahead of
+		 * head is the reader's mistake, don't wait for it */
+		used = rf->head - __atomic_load_n(&rf->header->tail, __ATOMIC_ACQUIRE);
+		if(used < 0) used = 0;
+		
+		if(used <= rf->mask)
+		{
+			return(rf->mask + 1 - used);
+		}
+		
+		/* Check the reader is still running about every 100ms */
+		if(i % 1000 == 999 && kill(pid, 0) != 0 && errno == ESRCH)
+		{
+			fprintf(stderr, "Shared memory reader %u has gone, detaching it\n", pid);
+			__atomic_compare_exchange_n(&rf->header->reader_pid, &pid, 0, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+			continue;
+		}
+		
+		nanosleep(&wait, NULL);
+	}
+}
+
+static int _rf_shm_write(void *private, const int16_t *iq_data, size_t samples)
+{
+	rf_shm_t *rf = private;
+	size_t i, n, space;
+	
+	while(samples)
+	{
+		/* Convert straight into the ring, stopping at the wrap point
+		 * and at the attached reader's tail */
+		i = rf->head & rf->mask;
+		n = rf->mask + 1 - i;
+		if(n > samples) n = samples;
+		
+		space = _rf_shm_space(rf);
+		if(n > space) n = space;
+		
+		rf_convert(rf->ring + i * rf->sample_size, iq_data, n, rf->type, rf->complex);
+		
+		rf->head += n;
+		iq_data += n * 2;
+		samples -= n;
+		
+		/* Publish the new samples to readers */
+		__atomic_store_n(&rf->header->head, rf->head, __ATOMIC_RELEASE);
+	}
+	
+	return(RF_OK);
+}
+
+static int _rf_shm_close(void *private)
+{
+	rf_shm_t *rf = private;
+	
+	if(rf->map)
+	{
+		__atomic_store_n(&rf->header->state, 0, __ATOMIC_RELEASE);
+		munmap(rf->map, rf->map_size);
+		shm_unlink(rf->name);
+	}
+	
+	free(rf->name);
+	free(rf);
+	
+	return(RF_OK);
+}
+
+int rf_shm_open(rf_t *s, const char *name, unsigned int sample_rate, int type, int complex)
+{
+	rf_shm_t *rf;
+	uint64_t size;
+	int fd;
+	
+	if(name == NULL || *name == '\0')
+	{
+		fprintf(stderr, "%s: No shared memory name given\n", __func__);
+		return(RF_ERROR);
+	}
+	
+	rf = calloc(1, sizeof(rf_shm_t));
+	if(!rf)
+	{
+		perror("calloc");
+		return(RF_ERROR);
+	}
+	
+	rf->complex = complex != 0;
+	rf->type = type;
+	rf->sample_size = rf_type_size(type, rf->complex);
+	
+	if(rf->sample_size == 0)
+	{
+		fprintf(stderr, "%s: Unrecognised data type %d\n", __func__, type);
+		_rf_shm_close(rf);
+		return(RF_ERROR);
+	}
+	
+	/* POSIX shared memory names begin with a slash */
+	rf->name = malloc(strlen(name) + 2);
+	if(!rf->name)
+	{
+		perror("malloc");
+		_rf_shm_close(rf);
+		return(RF_ERROR);
+	}
+	
+	sprintf(rf->name, "%s%s", *name == '/' ? "" : "/", name);
+	
+	/* The ring holds at least a quarter of a second of samples */
+	for(size = 65536; size < sample_rate / 4; size <<= 1);
+	
+	rf->mask = size - 1;
+	rf->map_size = _HEADER_SIZE + size * rf->sample_size;
+	
+	fd = shm_open(rf->name, O_RDWR | O_CREAT, 0644);
+	if(fd < 0)
+	{
+		perror(rf->name);
+		_rf_shm_close(rf);
+		return(RF_ERROR);
+	}
+	
+	if(ftruncate(fd, rf->map_size) != 0)
+	{
+		perror("ftruncate");
+		close(fd);
+		shm_unlink(rf->name);
+		_rf_shm_close(rf);
+		return(RF_ERROR);
+	}
+	
+	rf->map = mmap(NULL, rf->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	
+	if(rf->map == MAP_FAILED)
+	{
+		perror("mmap");
+		rf->map = NULL;
+		shm_unlink(rf->name);
+		_rf_shm_close(rf);
+		return(RF_ERROR);
+	}
+	
+	rf->header = rf->map;
+	rf->ring = (uint8_t *) rf->map + _HEADER_SIZE;
+	
+	/* Fill in the header. The magic is written last so a reader
+	 * never sees a valid magic with an incomplete header */
+	memset(rf->header, 0, sizeof(rf_shm_header_t));
+	rf->header->version = RF_SHM_VERSION;
+	rf->header->header_size = _HEADER_SIZE;
+	rf->header->sample_rate = sample_rate;
+	rf->header->type = type;
+	rf->header->flags = rf->complex ? RF_SHM_FLAG_COMPLEX : 0;
+	rf->header->sample_size = rf->sample_size;
+	rf->header->size = size;
+	rf->header->head = 0;
+	rf->header->tail = 0;
+	rf->header->reader_pid = 0;
+	rf->header->state = 1;
+	
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(rf->header->magic, RF_SHM_MAGIC, 4);
+	
+	fprintf(stderr, "Shared memory output %s: %llu samples\n", rf->name, (unsigned long long) size);
+	
+	/* Register the callback functions */
+	s->ctx = rf;
+	s->write = _rf_shm_write;
+	s->close = _rf_shm_close;
+	
+	return(RF_OK);
+}
+
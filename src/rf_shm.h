@@ -0,0 +1,85 @@
+/* hacktv - Analogue video transmitter for the HackRF                    */
+/*=======================================================================*/
+/* Copyright 2026 Philip Heron <phil@sanslogic.co.uk>                    */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _RF_SHM_H
+#define _RF_SHM_H
+
+#include <stdint.h>
+
+/* The shared memory object starts with the header below, followed by the
+ * ring of samples at header_size bytes from the start. Fields are in host
+ * byte order. The ring holds size samples, where size is a power of two,
+ * in the format given by type and flags (the same as file output).
+ *
+ * head is the total number of samples written since the sink was opened.
+ * Sample n is found at ring offset (n & (size - 1)). Each reader keeps its
+ * own tail and reads as follows:
+ *
+ * 1. Load head with acquire ordering.
+ * 2. If head - tail > size the reader has been overrun. Samples before
+ *    head - size are lost, move tail forward.
+ * 3. Use the samples from tail to head directly from the ring.
+ * 4. Load head again. If head - tail is now more than size, the oldest
+ *    of the samples just used may have been overwritten while reading.
+ *
+ * With no reader attached the writer never waits, and runs as fast as
+ * hacktv can render. A real-time consumer should attach, so the writer
+ * is held back to its pace. One reader at a time can attach:
+ *
+ * 1. Store its starting point in tail.
+ * 2. Claim reader_pid by changing it from 0 to its process ID with a
+ *    compare and swap. If this fails another reader is attached.
+ * 3. After using samples, store the new tail with release ordering.
+ *    The writer waits rather than overwrite samples past tail.
+ * 4. Store 0 in reader_pid when done.
+ *
+ * An attached reader also stalls any other outputs hacktv is writing to.
+ * If the process in reader_pid exits without detaching, the writer
+ * notices within about 100ms and carries on without it.
+ *
+ * state is set to 0 when the sink is closed. The object is unlinked at
+ * the same time, but readers that have mapped it can still drain it.
+ * See hacktv-shmread.c for an example reader.
+*/
+
+#define RF_SHM_MAGIC       "HTVS"
+#define RF_SHM_VERSION     2
+#define RF_SHM_FLAG_COMPLEX 0x01
+
+typedef struct {
+	char magic[4];         /*  0: "HTVS" */
+	uint32_t version;      /*  4: RF_SHM_VERSION */
+	uint32_t header_size;  /*  8: Offset of the ring in bytes */
+	uint32_t sample_rate;  /* 12: Samples per second */
+	uint8_t type;          /* 16: Sample type (RF_UINT8 .. RF_FLOAT) */
+	uint8_t flags;         /* 17: RF_SHM_FLAG_* */
+	uint16_t sample_size;  /* 18: Bytes per sample */
+	uint32_t state;        /* 20: 1 while open, 0 once closed */
+	uint64_t size;         /* 24: Ring length in samples */
+	uint8_t reserved[32];
+	uint64_t head;         /* 64: Samples written, on its own cache line */
+	uint8_t reserved2[56];
+	uint64_t tail;         /* 128: Samples used by the attached reader */
+	uint32_t reader_pid;   /* 136: Process ID of the attached reader, or 0 */
+} rf_shm_header_t;
+
+#ifdef _RF_H
+extern int rf_shm_open(rf_t *s, const char *name, unsigned int sample_rate, int type, int complex);
+#endif
+
+#endif
+
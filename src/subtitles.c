@@ -125,51 +125,182 @@ static char *_get_subtitle_string(char *fmt)
 	return txt;
 }
 
-void load_text_subtitle(av_subs_t *subs, uint32_t start_time, uint32_t duration, char *fmt)
+/* Subtitle storage is allocated in blocks of at least this size */
+#define SUBS_POOL_BLOCK (1024 * 1024)
+
+static void *_pool_alloc(av_subs_t *subs, size_t len)
 {
-	int sindex;
+	av_subs_block_t *b = subs->pool;
+	void *p;
 	
-	sindex = subs[0].number_of_subs;
+	/* Keep allocations aligned for the bitmaps */
+	len = (len + 15) & ~(size_t) 15;
 	
-	char *s = _get_subtitle_string(fmt);
+	if(b == NULL || b->size - b->used < len)
+	{
+		size_t size = len > SUBS_POOL_BLOCK ? len : SUBS_POOL_BLOCK;
+		
+		b = malloc(sizeof(av_subs_block_t) + 16 + size);
+		if(!b)
+		{
+			return(NULL);
+		}
+		
+		b->next = subs->pool;
+		b->size = size;
+		b->used = 0;
+		subs->pool = b;
+	}
+	
+	p = (uint8_t *) b + ((sizeof(av_subs_block_t) + 15) & ~(size_t) 15) + b->used;
+	b->used += len;
+	
+	return(p);
+}
+
+static char *_pool_strdup(av_subs_t *subs, const char *s)
+{
+	size_t l = strlen(s) + 1;
+	char *d = _pool_alloc(subs, l);
+	
+	if(d)
+	{
+		memcpy(d, s, l);
+	}
 	
-	/* Load subs struct with data */
-	subs[sindex].index = sindex;
-	subs[sindex].start_time = start_time;
-	subs[sindex].end_time = start_time + duration;
+	return(d);
+}
+
+/* Insert a new event in start time order. The caller must hold the mutex */
+static av_sub_event_t *_add_event(av_subs_t *subs, uint32_t start_time, uint32_t end_time)
+{
+	av_sub_event_t *e;
+	int x;
+	
+	if(subs->number_of_subs == subs->allocated)
+	{
+		int n = subs->allocated ? subs->allocated * 2 : 256;
+		
+		e = realloc(subs->events, sizeof(av_sub_event_t) * n);
+		if(!e)
+		{
+			return(NULL);
+		}
+		
+		subs->events = e;
+		subs->allocated = n;
+	}
+	
+	/* Events normally arrive in order, so this rarely has to move any */
+	for(x = subs->number_of_subs; x > 0 && subs->events[x - 1].start_time > start_time; x--)
+	{
+		subs->events[x] = subs->events[x - 1];
+	}
+	
+	/* Don't let the cursor skip over an event added behind it */
+	if(x < subs->pos)
+	{
+		subs->pos = x;
+	}
+	
+	e = &subs->events[x];
+	memset(e, 0, sizeof(av_sub_event_t));
+	e->start_time = start_time;
+	e->end_time = end_time;
+	
+	subs->number_of_subs++;
+	
+	return(e);
+}
+
+/* Find the event showing at time ts. The caller must hold the mutex */
+static av_sub_event_t *_find_event(av_subs_t *subs, uint32_t ts)
+{
+	int x;
+	
+	/* Start again from the beginning if time has gone backwards */
+	if(ts < subs->last_ts)
+	{
+		subs->pos = 0;
+	}
+	
+	subs->last_ts = ts;
+	
+	/* Move the cursor past any events that have finished */
+	while(subs->pos < subs->number_of_subs && subs->events[subs->pos].end_time < ts)
+	{
+		subs->pos++;
+	}
+	
+	/* The events are sorted by start time, so only those
+	 * between the cursor and ts need to be checked */
+	for(x = subs->pos; x < subs->number_of_subs && subs->events[x].start_time <= ts; x++)
+	{
+		if(ts <= subs->events[x].end_time)
+		{
+			return(&subs->events[x]);
+		}
+	}
+	
+	return(NULL);
+}
+
+void load_text_subtitle(av_subs_t *subs, uint32_t start_time, uint32_t duration, char *fmt)
+{
+	av_sub_event_t *e;
+	char *text;
+	
+	char *s = _get_subtitle_string(fmt);
 	
 	/* Strip HTML and convert \N to \n */
 	_strip_html(s);
 	
-	/* Copy subtitle text into subs struct */
-	memcpy(subs[sindex].text, s, 256);
+	/* Copy subtitle text into the pool */
+	text = _pool_strdup(subs, s);
+	if(!text)
+	{
+		return;
+	}
+	
+	pthread_mutex_lock(&subs->mutex);
 	
-	/* Update number of subtitles */
-	subs[0].number_of_subs++;
+	e = _add_event(subs, start_time, start_time + duration);
+	if(e)
+	{
+		e->text = text;
+	}
 	
-	subs[0].type = SUB_TEXT;
+	subs->type = SUB_TEXT;
+	
+	pthread_mutex_unlock(&subs->mutex);
 }
 
-
 void load_bitmap_subtitle(AVSubtitle *sub, av_subs_t *subs, int bitmap_width, int max_bitmap_width, int max_bitmap_height, uint32_t pts, int bitmap_scale)
 {
+	av_sub_event_t *e;
 	uint32_t *bitmap;
-	int i, x, y, pixel, sindex;
+	size_t size;
+	int i, x, y, pixel;
 	
-	sindex = subs[0].number_of_subs;
-		
-	/* Load subs struct with data */
-	subs[sindex].index = sindex;
-	subs[sindex].start_time = pts + sub->start_display_time;
-	subs[sindex].end_time = pts + sub->start_display_time + sub->end_display_time;
-	subs[sindex].bitmap_height = max_bitmap_height;
-	subs[sindex].bitmap_width = bitmap_width;
+	/* Convert subtitle to bitmap, reusing the scratch buffer */
+	size = (size_t) max_bitmap_width * max_bitmap_height;
+	
+	if(size > subs->scratch_size)
+	{
+		bitmap = realloc(subs->scratch, size * sizeof(uint32_t));
+		if(!bitmap)
+		{
+			return;
+		}
 		
-	/* Convert subtitle to bitmap */
-	bitmap = malloc(max_bitmap_width * max_bitmap_height * sizeof(uint32_t));
+		subs->scratch = bitmap;
+		subs->scratch_size = size;
+	}
+	
+	bitmap = subs->scratch;
 	
 	/* Set all pixels to black */
-	memset(bitmap, 0, max_bitmap_width * max_bitmap_height * sizeof(uint32_t));
+	memset(bitmap, 0, size * sizeof(uint32_t));
 	
 	for(i = sub->num_rects - 1; i >= 0; i--)
 	{	
@@ -184,7 +315,7 @@ void load_bitmap_subtitle(AVSubtitle *sub, av_subs_t *subs, int bitmap_width, in
 				{
 					/* Pixel position */
 					pixel = (y / bitmap_scale * max_bitmap_width + x / bitmap_scale);
-
+					
 					char r = sub->rects[i]->data[1][c * 4 + 0];
 					char g = sub->rects[i]->data[1][c * 4 + 1];
 					char b = sub->rects[i]->data[1][c * 4 + 2];
@@ -195,37 +326,44 @@ void load_bitmap_subtitle(AVSubtitle *sub, av_subs_t *subs, int bitmap_width, in
 			}
 		}
 	}
-
-	/* Resize bitmap subtitle and load into subs struct */
-	subs[sindex].bitmap = malloc(bitmap_width * max_bitmap_height * sizeof(uint32_t));
-	resize_bitmap(bitmap, subs[sindex].bitmap, max_bitmap_width, max_bitmap_height, bitmap_width, max_bitmap_height);
 	
-	/* Update number of subtitles */
-	subs[0].number_of_subs++;
+	/* Resize the bitmap once here, into the pool */
+	bitmap = _pool_alloc(subs, (size_t) bitmap_width * max_bitmap_height * sizeof(uint32_t));
+	if(!bitmap)
+	{
+		return;
+	}
+	
+	resize_bitmap(subs->scratch, bitmap, max_bitmap_width, max_bitmap_height, bitmap_width, max_bitmap_height);
+	
+	pthread_mutex_lock(&subs->mutex);
+	
+	e = _add_event(subs, pts + sub->start_display_time, pts + sub->start_display_time + sub->end_display_time);
+	if(e)
+	{
+		e->bitmap = bitmap;
+		e->bitmap_width = bitmap_width;
+		e->bitmap_height = max_bitmap_height;
+	}
 	
 	/* Set subtitle type */
-	subs[0].type = SUB_BITMAP;
-
-	free(bitmap);
+	subs->type = SUB_BITMAP;
+	
+	pthread_mutex_unlock(&subs->mutex);
 }
 
 int subs_init_ffmpeg(av_subs_t **s)
 {
-
 	av_subs_t *subs;
-
-	/* Give subs typedef some memory - 512Kb enough?! */
-	subs = calloc(524288 * sizeof(char), sizeof(av_subs_t));
+	
+	subs = calloc(1, sizeof(av_subs_t));
 	if(!subs)
 	{
 		return(HACKTV_OUT_OF_MEMORY);
 	}
 	
-	memset(subs, 0, sizeof(av_subs_t));
+	pthread_mutex_init(&subs->mutex, NULL);
 	
-	subs[0].pos = 0;
-	subs[0].number_of_subs = 0;
-
 	*s = subs;
 	
 	return(HACKTV_OK);
@@ -234,12 +372,11 @@ int subs_init_ffmpeg(av_subs_t **s)
 int subs_init_file(char *video_path, av_subs_t **s)
 {
 	int bufc, c, char_count, n;
-	int sindex = 0;
-	struct stat fs;
-
+	av_sub_event_t *e;
 	av_subs_t *subs;
+	char *text;
 	
-	char *filename = malloc(strlen(video_path) + 1);
+	char *filename = malloc(strlen(video_path) + 5);
 	strcpy(filename, video_path);
 	
 	get_filename(filename);
@@ -249,6 +386,7 @@ int subs_init_file(char *video_path, av_subs_t **s)
 	if(access(filename, 0) == -1)
 	{
 		fprintf(stderr, "Error: subtitle path '%s' does not exist!\n", filename);
+		free(filename);
 		return(HACKTV_ERROR);
 	}
 	
@@ -256,27 +394,26 @@ int subs_init_file(char *video_path, av_subs_t **s)
 	
 	/* Hopefully enough chars in arrays */
 	char start_time[20], end_time[20], strbuf[256];
-
-	/* Get file size */
-	stat(filename, &fs);
-
-	/* Give subs struct some memory */
-	subs = calloc(fs.st_size * sizeof(char), sizeof(av_subs_t));
-	if(!subs)
+	
+	if(subs_init_ffmpeg(&subs) != HACKTV_OK)
 	{
+		free(filename);
 		return(HACKTV_OUT_OF_MEMORY);
 	}
 	
-	memset(subs, 0, sizeof(av_subs_t));
+	subs->type = SUB_TEXT;
 	
-	if(!subs)
-	{
-		return(HACKTV_OUT_OF_MEMORY);
-	}
-
 	FILE *fp;
 	fp = fopen(filename,"r");
-
+	free(filename);
+	
+	if(!fp)
+	{
+		perror("fopen");
+		subs_free(subs);
+		return(HACKTV_ERROR);
+	}
+	
 	/* Rubbish hack to not break on first line for files with BOM */
 	int start_file = 1;
 	while(1)
@@ -326,63 +463,85 @@ int subs_init_file(char *video_path, av_subs_t **s)
 		}
 		
 		/* Load subs struct with data */
-		subs[sindex].index = sindex;
-		subs[sindex].start_time = get_ms(start_time);
-		subs[sindex].end_time = get_ms(end_time);
 		_strip_html(strbuf);
-		memcpy(subs[sindex].text, strbuf, 256);
-		sindex++;
+		text = _pool_strdup(subs, strbuf);
+		e = text ? _add_event(subs, get_ms(start_time), get_ms(end_time)) : NULL;
+		
+		if(!e)
+		{
+			fclose(fp);
+			subs_free(subs);
+			return(HACKTV_OUT_OF_MEMORY);
+		}
+		
+		e->text = text;
 	}
 	
 	/* Close file */
 	fclose(fp);
-
-	subs[0].pos = 0;
-	subs[0].number_of_subs = sindex;
-	subs[0].type = SUB_TEXT;
+	
 	*s = subs;
+	
 	return(HACKTV_OK);
 }
 
-char *get_text_subtitle(av_subs_t *subs, uint32_t ts)
+void subs_free(av_subs_t *subs)
 {
-	char *fmt;
-	int x;
+	av_subs_block_t *b;
 	
-	fmt = "";
-	for(x = subs[0].pos; x < subs[0].number_of_subs; x++)
+	if(subs == NULL)
 	{
-		if(ts >= subs[x].start_time && ts <= subs[x].end_time)
-		{
-			fmt = subs[x].text;
-			subs[0].pos = x;
-			break;
-		}
+		return;
 	}
+	
+	while((b = subs->pool) != NULL)
+	{
+		subs->pool = b->next;
+		free(b);
+	}
+	
+	free(subs->events);
+	free(subs->scratch);
+	pthread_mutex_destroy(&subs->mutex);
+	free(subs);
+}
 
+char *get_text_subtitle(av_subs_t *subs, uint32_t ts)
+{
+	av_sub_event_t *e;
+	char *fmt;
+	
+	pthread_mutex_lock(&subs->mutex);
+	e = _find_event(subs, ts);
+	fmt = e && e->text ? e->text : "";
+	pthread_mutex_unlock(&subs->mutex);
+	
 	return fmt;
 }
 
-int get_bitmap_subtitle(av_subs_t *subs, uint32_t current_timestamp, int *w, int *h)
+uint32_t *get_bitmap_subtitle(av_subs_t *subs, uint32_t current_timestamp, int *w, int *h)
 {
-	int x;
+	av_sub_event_t *e;
+	uint32_t *bitmap = NULL;
 	
 	*w = 0;
 	
-	for(x = subs[0].pos; x < subs[0].number_of_subs; x++)
+	pthread_mutex_lock(&subs->mutex);
+	
+	e = _find_event(subs, current_timestamp);
+	if(e && e->bitmap)
 	{
-		if(current_timestamp >= subs[x].start_time && current_timestamp <= subs[x].end_time)
-		{
-			subs[0].pos = x;
-			*w = subs[x].bitmap_width;
-			*h = subs[x].bitmap_height;
-			break;
-		}
+		bitmap = e->bitmap;
+		*w = e->bitmap_width;
+		*h = e->bitmap_height;
 	}
-	return x;
+	
+	pthread_mutex_unlock(&subs->mutex);
+	
+	return bitmap;
 }
 
 int get_subtitle_type(av_subs_t *subs)
 {
-	return subs[0].type;
+	return subs->type;
 }
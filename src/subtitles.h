@@ -18,31 +18,62 @@
 #ifndef SUBTITLES_H_
 #define SUBTITLES_H_
 
+#include <pthread.h>
 #include <libavcodec/avcodec.h>
 #include "video.h"
 
 #define SUB_BITMAP 0
 #define SUB_TEXT 1
 
+/* A single subtitle event. Times are in milliseconds for text subtitles
+ * and in stream time base units for bitmap subtitles */
 typedef struct {
-	int pos;
-	int type;
-    int index;
-    int start_time;
-    int end_time;
-    char text[256];
-	int number_of_subs;
+	uint32_t start_time;
+	uint32_t end_time;
+	char *text;
 	uint32_t *bitmap;
 	int bitmap_width;
 	int bitmap_height;
-	void *font;
+} av_sub_event_t;
+
+/* Subtitle storage is allocated in blocks which are never moved or freed
+ * until the track is closed, so pointers handed out by the lookup
+ * functions remain valid while new events are being loaded */
+typedef struct _av_subs_block_t {
+	struct _av_subs_block_t *next;
+	size_t size;
+	size_t used;
+} av_subs_block_t;
+
+typedef struct {
+	int type;
+	
+	/* Events, sorted by start time */
+	av_sub_event_t *events;
+	int number_of_subs;
+	int allocated;
+	
+	/* Lookup cursor. Events before pos have finished */
+	int pos;
+	uint32_t last_ts;
+	
+	/* Text and bitmap storage */
+	av_subs_block_t *pool;
+	
+	/* Scratch buffer for unscaled bitmaps */
+	uint32_t *scratch;
+	size_t scratch_size;
+	
+	/* Events are loaded by the input thread and read by the scaler */
+	pthread_mutex_t mutex;
 } av_subs_t;
 
 extern void load_text_subtitle(av_subs_t *subs, uint32_t start_time, uint32_t duration, char *fmt);
 extern int subs_init_file(char *filename, av_subs_t **s);
 extern int subs_init_ffmpeg(av_subs_t **s);
+extern void subs_free(av_subs_t *subs);
 extern char *get_text_subtitle(av_subs_t *subs, uint32_t ts);
-extern int get_bitmap_subtitle(av_subs_t *subs, uint32_t current_timestamp, int *w, int *h);
+extern uint32_t *get_bitmap_subtitle(av_subs_t *subs, uint32_t current_timestamp, int *w, int *h);
 extern void load_bitmap_subtitle(AVSubtitle *av_sub, av_subs_t *subs, int bitmap_width, int w, int h, uint32_t pts, int bitmap_scale);
 extern int get_subtitle_type(av_subs_t *subs);
 #endif
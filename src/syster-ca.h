@@ -18,6 +18,9 @@
 #ifndef _SYSTER_CA_H
 #define _SYSTER_CA_H
 
-extern uint64_t encrypt_syster_cw(unsigned char *ecm, unsigned char k64[8], int m);
+#include "des.h"
+
+extern void syster_ca_key(des_key_t *ks, const unsigned char k64[8]);
+extern uint64_t encrypt_syster_cw(unsigned char *ecm, const des_key_t *ks, int m);
 
 #endif
@@ -344,6 +344,14 @@ int _ng_vbi_init(ng_t *s, vid_t *vid)
 		return(VID_OUT_OF_MEMORY);
 	}
 	
+	/* The data starts 45 symbols in */
+	s->lut8 = vbidata_init8(s->lut, 45, VBIDATA_LSB_FIRST);
+	
+	if(!s->lut8)
+	{
+		return(VID_OUT_OF_MEMORY);
+	}
+	
 	s->vbi_seq = 0;
 	s->block_seq = 0;
 	
@@ -411,7 +419,7 @@ void _render_ng_vbi(ng_t *s, vid_t *vid, vid_line_t *l)
 		}
 		
 		/* Render the line */
-		vbidata_render(s->lut, s->vbi[s->vbi_seq++], 45, NG_VBI_BYTES * 8, VBIDATA_LSB_FIRST, l);
+		vbidata_render8(s->lut8, s->vbi[s->vbi_seq++], NG_VBI_BYTES * 8, l);
 		l->vbialloc = 1;
 		
 		if(s->vbi_seq == 10)
@@ -443,6 +451,10 @@ int _ng_audio_init(ng_t *s)
 void _rand_seed(ng_t *s, unsigned char data[8], unsigned char key[8], int ecm_type)
 {
 	int i, j;
+	des_key_t ks;
+	
+	/* Expand the key once for all the blocks */
+	syster_ca_key(&ks, key);
 	
 	/* Generate 64 random control words */
 	for(j =0 ; j < 0x40; j++)
@@ -453,7 +465,7 @@ void _rand_seed(ng_t *s, unsigned char data[8], unsigned char key[8], int ecm_ty
 		}
 		
 		/* Encrypt plain control word to send to card */
-		s->blocks[j].cw = encrypt_syster_cw(s->blocks[j].ecm, key, NG_ENCRYPT);
+		s->blocks[j].cw = encrypt_syster_cw(s->blocks[j].ecm, &ks, NG_ENCRYPT);
 	}
 }
 
@@ -575,7 +587,7 @@ void ng_free(ng_t *s)
 	free(s->firlq);
 	free(s->firri);
 	free(s->firrq);
-	free(s->delay);
+	free(s->lut8);
 	free(s->lut);
 }
 
@@ -642,25 +654,41 @@ void ng_invert_audio(ng_t *s, int16_t *audio, size_t samples)
 static void _rotate_syster(int16_t *li, vid_line_t *lo, ng_t *n, int frame, const uint8_t sequence[25][576])
 {
 	int shift;
-	int x, y;
+	int x, x2, y;
 
-	y = lo->line < 336 ? lo->line - 23 : lo->line - 336 + 288;
-	shift = sequence[frame % 25][y];
+	x = n->video_scale[SCNR_LEFT];
+	x2 = n->video_scale[SCNR_LEFT + SCNR_TOTAL_CUTS];
 
-	y = n->video_scale[SCNR_LEFT + SCNR_TOTAL_CUTS - shift];
-	for(x = n->video_scale[SCNR_LEFT]; x < n->video_scale[SCNR_LEFT + SCNR_TOTAL_CUTS]; x++, y++)
+	/* Blank last line of each field - to stop interfering with D11 data */
+	if(lo->line == 310 || lo->line == 622)
 	{
-		lo->output[x * 2 + 1] =  li[(y - n->ng_delay) * 2];
-		if(y >= n->video_scale[SCNR_LEFT + SCNR_TOTAL_CUTS])
+		for(; x < x2; x++)
 		{
-			y = n->video_scale[SCNR_LEFT + 5];
+			lo->output[x * 2 + 0] = 16056;
+			lo->output[x * 2 + 1] = 0;
 		}
+
+		return;
 	}
 
-	for(x = n->video_scale[SCNR_LEFT]; x < n->video_scale[SCNR_LEFT + SCNR_TOTAL_CUTS]; x++)
+	y = lo->line < 336 ? lo->line - 23 : lo->line - 336 + 288;
+	shift = sequence[frame % 25][y];
+
+	/* The line is rotated in place, so build the result in the
+	 * second channel before moving it into position. The source
+	 * includes the sample at x2 before wrapping back to the cut */
+	y = n->video_scale[SCNR_LEFT + SCNR_TOTAL_CUTS - shift];
+
+	vid_rotate_line(
+		lo->output + 1, li, x, x2,
+		y - n->ng_delay,
+		x2 + 1 - n->ng_delay,
+		n->video_scale[SCNR_LEFT + 5] + 1 - n->ng_delay
+	);
+
+	for(; x < x2; x++)
 	{
-		/* Blank last line of each field - to stop interfering with D11 data */
-		lo->output[x * 2] = lo->line == 310 || lo->line == 622 ? 16056 : lo->output[x * 2 + 1];
+		lo->output[x * 2 + 0] = lo->output[x * 2 + 1];
 		lo->output[x * 2 + 1] = 0;
 	}
 }
@@ -733,21 +761,17 @@ int ng_render_line(vid_t *s, void *arg, int nlines, vid_line_t **lines)
 	}
 	
 	/* Swap the active line with the oldest line in the delay buffer,
-	 * with active video offset in j if necessary. */
+	 * with active video offset in j if necessary. Each source line is
+	 * only used once, so the buffers are exchanged rather than copied */
 	if(j > 0)
 	{
-		int16_t *dline = lines[j]->output;
-		
 		/* For PAL the colour burst is not moved, just the active
 		 * video. For SECAM the entire line is moved. */
-		x = s->active_left * 2;
+		x = s->active_left;
 		
 		if(s->conf.colour_mode == VID_SECAM) x = 0;
 		
-		for(; x < s->width * 2; x += 2)
-		{
-			l->output[x] = dline[x];
-		}
+		vid_swap_lines(l, lines[j], x);
 	}
 	
 	/* Rotate line without shuffling */
@@ -98,6 +98,7 @@ typedef struct {
 
 	/* VBI */
 	vbidata_lut_t *lut;
+	vbidata_lut8_t *lut8;
 	uint8_t vbi[10][NG_VBI_BYTES];
 	int vbi_seq;
 	int block_seq;
@@ -117,10 +118,6 @@ typedef struct {
 	/* The line order for the next field (0-287) */
 	int order[NG_LINES_PER_FIELD];
 
-	/* Syster delay line */
-	int16_t *delay;
-	int16_t *delay_line[NG_DELAY_LINES];
-
 	/* D11 delay values */
 	int ng_delay;
 	int d11_line_delay[D11_LINES_PER_FIELD * D11_FIELDS];
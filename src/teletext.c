@@ -40,6 +40,21 @@
 #include <dirent.h>
 #include <limits.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <fcntl.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#endif
 #include "video.h"
 #include "vbidata.h"
 
@@ -69,6 +84,42 @@ static const uint8_t _hamming84[0x10] = {
 
 
 
+/* Inverse of _hamming84, 0xFF for invalid codes */
+static const uint8_t _unhamming84_lut[0x100] = {
+	0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0x06, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x02, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x03, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0x04, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0x05, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0x0A, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0x0B, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x0C, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0D, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x09,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0E, 0xFF, 0xFF,
+};
+
 static uint8_t _unhamming84(uint8_t b)
 {
 	int i;
@@ -486,6 +537,81 @@ static void _update_page_crc(tt_page_t *page, const uint8_t header[45])
 	}
 }
 
+static void _next_page(tt_service_t *s, tt_magazine_t *mag, unsigned int timecode)
+{
+	tt_page_t *npage;
+	int i, pg;
+	
+	/* Send a priority page if one has earned enough credit */
+	for(i = 0; i < mag->nprio; i++)
+	{
+		pg = mag->prio[i];
+		
+		if(mag->credit[pg] >= mag->npages)
+		{
+			mag->credit[pg] -= mag->npages;
+			mag->page = mag->index[pg];
+			return;
+		}
+	}
+	
+	npage = mag->ring->next;
+	
+	/* Test if we need to advance the next page's subpage */
+	if(npage->cycle_time && npage != npage->next_subpage)
+	{
+		int adv = 0;
+		
+		if(npage->cycle_mode == 0)
+		{
+			/* Timer mode */
+			if(timecode >= npage->cycle_count)
+			{
+				npage->cycle_count = timecode + npage->cycle_time * s->second_delay;
+				adv = 1;
+			}
+		}
+		else
+		{
+			/* Cycle mode */
+			npage->cycle_count++;
+			
+			if(npage->cycle_count == npage->cycle_time)
+			{
+				npage->cycle_count = 0;
+				adv = 1;
+			}
+		}
+		
+		if(adv)
+		{
+			mag->ring->next = npage->next_subpage;
+			npage->next_subpage->next = npage->next;
+			npage->next_subpage->cycle_count = npage->cycle_count;
+			npage->next_subpage->erase = 1;
+			
+			mag->index[npage->page & 0xFF] = npage->next_subpage;
+			
+			/* Keep the magazine's first page in the ring */
+			if(mag->pages == npage)
+			{
+				mag->pages = npage->next_subpage;
+			}
+		}
+	}
+	
+	/* Continue around the ring */
+	mag->ring = mag->ring->next;
+	mag->page = mag->ring;
+	
+	/* Give the priority pages their credit */
+	for(i = 0; i < mag->nprio; i++)
+	{
+		pg = mag->prio[i];
+		mag->credit[pg] += mag->repeat[pg] - 1;
+	}
+}
+
 static int _next_magazine_packet(tt_service_t *s, tt_magazine_t *mag, uint8_t line[45], unsigned int timecode)
 {
 	char header[33];
@@ -497,6 +623,7 @@ static int _next_magazine_packet(tt_service_t *s, tt_magazine_t *mag, uint8_t li
 		_header(line, mag->magazine & 0x07, 0xFF, 0x3F7F, 0x8000, header);
 		
 		mag->filler = 0;
+		s->last_header = timecode;
 		
 		return(TT_OK);
 	}
@@ -524,6 +651,8 @@ static int _next_magazine_packet(tt_service_t *s, tt_magazine_t *mag, uint8_t li
 		/* Set the delay time (20ms rule) */
 		mag->delay = timecode + s->header_delay;
 		mag->row++;
+		
+		s->last_header = timecode;
 	}
 	else
 	{
@@ -551,45 +680,8 @@ static int _next_magazine_packet(tt_service_t *s, tt_magazine_t *mag, uint8_t li
 	/* Test if this is the last row on this page */
 	if(mag->row - 1 == mag->page->packets)
 	{
-		tt_page_t *npage = mag->page->next;
-		
-		/* Test if we need to advance the next page's subpage */
-		if(npage->cycle_time && npage != npage->next_subpage)
-		{
-			int adv = 0;
-			
-			if(npage->cycle_mode == 0)
-			{
-				/* Timer mode */
-				if(timecode >= npage->cycle_count)
-				{
-					npage->cycle_count = timecode + npage->cycle_time * s->second_delay;
-					adv = 1;
-				}
-			}
-			else
-			{
-				/* Cycle mode */
-				npage->cycle_count++;
-				
-				if(npage->cycle_count == npage->cycle_time)
-				{
-					npage->cycle_count = 0;
-					adv = 1;
-				}
-			}
-			
-			if(adv)
-			{
-				mag->page->next = npage->next_subpage;
-				npage->next_subpage->next = npage->next;
-				npage->next_subpage->cycle_count = npage->cycle_count;
-				npage->next_subpage->erase = 1;
-			}
-		}
-		
 		/* Advance magazine to the next page */
-		mag->page = mag->page->next;
+		_next_page(s, mag, timecode);
 		mag->row = 0;
 		
 		/* Special case for magazines with only one page,
@@ -622,12 +714,57 @@ static int _next_packet(tt_service_t *s, uint8_t line[45], unsigned int timecode
 		return(TT_OK);
 	}
 	
+	/* If headers have fallen behind the target rate, give this packet
+	 * to a magazine that is ready to send one. An empty magazine can
+	 * send a filler header at any time */
+	if(timecode - s->last_header >= s->header_interval)
+	{
+		tt_magazine_t *mag = NULL;
+		tt_magazine_t *m;
+		
+		for(i = 0; mag == NULL && i < 8; i++)
+		{
+			m = &s->magazines[(s->magazine + i) & 7];
+			
+			if(s->skip & (1 << ((s->magazine + i) & 7)))
+			{
+				continue;
+			}
+			
+			if(m->filler || (m->pages != NULL && m->row == 0))
+			{
+				mag = m;
+			}
+		}
+		
+		for(i = 0; mag == NULL && i < 8; i++)
+		{
+			m = &s->magazines[(s->magazine + i) & 7];
+			
+			if(m->pages == NULL && !(s->skip & (1 << ((s->magazine + i) & 7))))
+			{
+				m->filler = 1;
+				mag = m;
+			}
+		}
+		
+		if(mag != NULL && _next_magazine_packet(s, mag, line, timecode) == TT_OK)
+		{
+			return(TT_OK);
+		}
+	}
+	
 	/* Test each magazine for the next available packet */
 	for(i = 0; i < 8; i++)
 	{
-		r = _next_magazine_packet(s, &s->magazines[s->magazine++], line, timecode);
+		r = TT_NO_PACKET;
+		
+		if(!(s->skip & (1 << s->magazine)))
+		{
+			r = _next_magazine_packet(s, &s->magazines[s->magazine], line, timecode);
+		}
 		
-		s->magazine &= 7;
+		s->magazine = (s->magazine + 1) & 7;
 		
 		if(r == TT_OK)
 		{
@@ -686,22 +823,114 @@ static int _page_mkpackets(tt_page_t *page, uint8_t lines[25][40])
 	return(TT_OK);
 }
 
+/* The number of times a page is sent per magazine cycle. Subtitles
+ * and newsflashes go out most often, followed by the index pages */
+static int _page_repeat(tt_page_t *page)
+{
+	if(page->page_status & 0x0003)
+	{
+		return(TT_REPEAT_SUBTITLE);
+	}
+	
+	if((page->page & 0xFF) == 0x00)
+	{
+		return(TT_REPEAT_INDEX);
+	}
+	
+	return(1);
+}
+
+static void _set_repeat(tt_magazine_t *mag, int pg, int repeat)
+{
+	int i;
+	
+	for(i = 0; i < mag->nprio && mag->prio[i] != pg; i++);
+	
+	if(repeat > 1 && i == mag->nprio)
+	{
+		/* Add to the priority list */
+		mag->prio[mag->nprio++] = pg;
+		mag->credit[pg] = 0;
+	}
+	else if(repeat <= 1 && i < mag->nprio)
+	{
+		/* Remove from the priority list */
+		mag->prio[i] = mag->prio[--mag->nprio];
+	}
+	
+	mag->repeat[pg] = repeat;
+}
+
+/* Find the page before pg in the ring, wrapping around to the last.
+ * This tests at most the four words of the present bitmap */
+static tt_page_t *_prev_page(tt_magazine_t *mag, int pg)
+{
+	uint64_t m;
+	int w;
+	
+	/* The highest page number below pg */
+	w = pg >> 6;
+	m = mag->present[w] & ((UINT64_C(1) << (pg & 63)) - 1);
+	
+	while(m == 0 && w > 0)
+	{
+		m = mag->present[--w];
+	}
+	
+	if(m == 0)
+	{
+		/* None, so wrap around to the highest in use */
+		for(w = 3; w > 0 && mag->present[w] == 0; w--);
+		m = mag->present[w];
+		
+		if(m == 0)
+		{
+			return(mag->index[pg]);
+		}
+	}
+	
+	return(mag->index[w << 6 | (63 - __builtin_clzll(m))]);
+}
+
+static void _set_present(tt_magazine_t *mag, int pg, int present)
+{
+	uint64_t bit = UINT64_C(1) << (pg & 63);
+	
+	if(present)
+	{
+		mag->present[pg >> 6] |= bit;
+	}
+	else
+	{
+		mag->present[pg >> 6] &= ~bit;
+	}
+}
+
 static void _add_page(tt_service_t *s, tt_page_t *new_page)
 {
 	tt_magazine_t *mag;
 	tt_page_t *page;
 	tt_page_t *subpage;
+	int pg;
 	
 	/* Make sure erase flag is set for the new page */
 	new_page->erase = 1;
 	
 	mag = &s->magazines[(new_page->page >> 8) & 0x07];
+	pg = new_page->page & 0xFF;
+	page = mag->index[pg];
+	
+	_set_repeat(mag, pg, _page_repeat(new_page));
 	
 	if(mag->pages == NULL)
 	{
 		/* This is the first page added to the magazine */
 		mag->pages = new_page;
 		mag->page = new_page;
+		mag->ring = new_page;
+		mag->index[pg] = new_page;
+		mag->npages = 1;
+		_set_present(mag, pg, 1);
 		
 		new_page->next = new_page;
 		new_page->subpages = new_page;
@@ -710,26 +939,25 @@ static void _add_page(tt_service_t *s, tt_page_t *new_page)
 		return;
 	}
 	
-	/* Scan the magazine for the page insertion point */
-	for(page = mag->pages; page->next != mag->pages; page = page->next)
-	{
-		if(page->page <= new_page->page &&
-		   page->next->page > new_page->page) break;
-	}
-	
-	if(page->page != new_page->page)
+	if(page == NULL)
 	{
-		/* This is a new page, to be appended */
+		/* This is a new page, insert it after the one before */
+		page = _prev_page(mag, pg);
+		
 		new_page->next = page->next;
 		new_page->subpages = new_page;
 		new_page->next_subpage = new_page;
 		
 		page->next = new_page;
 		
-		if(new_page->page < mag->pages->page)
+		if(pg < (mag->pages->page & 0xFF))
 		{
 			mag->pages = new_page;
 		}
+		
+		mag->index[pg] = new_page;
+		mag->npages++;
+		_set_present(mag, pg, 1);
 	}
 	else
 	{
@@ -763,9 +991,10 @@ static void _add_page(tt_service_t *s, tt_page_t *new_page)
 			
 			/* This is an existing subpage, replace it */
 			
-			/* Copy the subpage pointers */
+			/* Copy the subpage pointers and cycle timer */
 			new_page->next_subpage = subpage->next_subpage;
 			new_page->subpages = subpage->subpages;
+			new_page->cycle_count = subpage->cycle_count;
 			
 			/* Free the old page packet data */
 			free(subpage->data);
@@ -886,7 +1115,9 @@ int update_teletext_subtitle(char *t, tt_service_t *s)
 	return 0;
 }
 
-static int _load_tti(tt_service_t *s, char *filename)
+/* Parse a TTI file. The pages are returned in a list linked by their next
+ * pointer, ready to be passed to _add_page() */
+static int _load_tti(tt_page_t **pages, char *filename)
 {
 	char buf[200];
 	size_t i, len;
@@ -898,6 +1129,8 @@ static int _load_tti(tt_service_t *s, char *filename)
 	tt_page_t *page;
 	int esc;
 	
+	*pages = NULL;
+	
 	f = fopen(filename, "rb");
 	if(!f)
 	{
@@ -968,7 +1201,8 @@ static int _load_tti(tt_service_t *s, char *filename)
 					
 					/* Save current page */
 					_page_mkpackets(page, lines);
-					_add_page(s, page);
+					*pages = page;
+					pages = &page->next;
 					
 					/* Lazily copy the old page settings */
 					page = malloc(sizeof(tt_page_t));
@@ -981,8 +1215,9 @@ static int _load_tti(tt_service_t *s, char *filename)
 					
 					memcpy(page, opage, sizeof(tt_page_t));
 					
-					/* Have to unset the packet pointer */
+					/* Have to unset the packet and list pointers */
 					page->data = NULL;
+					page->next = NULL;
 				}
 				
 				/* Clear existing page data */
@@ -1101,7 +1336,11 @@ static int _load_tti(tt_service_t *s, char *filename)
 	if(page->page > 0)
 	{
 		_page_mkpackets(page, lines);
-		_add_page(s, page);
+		*pages = page;
+	}
+	else
+	{
+		free(page);
 	}
 	
 	return(TT_OK);
@@ -1116,26 +1355,39 @@ static int _new_service(tt_service_t *s)
 	s->timestamp = 0;
 	s->second_delay = 25 * 625;
 	s->header_delay = (20e-3 * s->second_delay) + 0.5;
+	s->header_interval = s->second_delay / TT_HEADER_RATE;
+	s->last_header = 0;
 	s->magazine = 1;
 	
 	for(i = 1; i <= 8; i++)
 	{
 		mag = &s->magazines[i & 0x07];
 		
+		memset(mag, 0, sizeof(tt_magazine_t));
 		mag->magazine = i;
-		mag->filler = 0;
-		mag->pages = NULL;
-		mag->row = 0;
-		mag->delay = 0;
 	}
 	
 	return(TT_OK);
 }
 
+static void _free_pages(tt_page_t *page)
+{
+	tt_page_t *next;
+	
+	for(; page; page = next)
+	{
+		next = page->next;
+		free(page->data);
+		free(page);
+	}
+}
+
 static void _free_service(tt_service_t *s)
 {
 	tt_magazine_t *mag;
+	tt_page_t *page;
 	tt_page_t *npage;
+	tt_page_t *subpage;
 	tt_page_t *nsubpage;
 	int i;
 	
@@ -1144,191 +1396,927 @@ static void _free_service(tt_service_t *s)
 		mag = &s->magazines[i];
 		if(mag->pages == NULL) continue;
 		
-		mag->page = mag->pages->next->subpages;
-		mag->pages->next = NULL;
+		/* Break the page ring after the last page */
+		for(page = mag->pages; page->next != mag->pages; page = page->next);
+		page->next = NULL;
 		
-		while(mag->page)
+		for(page = mag->pages; page; page = npage)
 		{
-			npage = mag->page->next == NULL ? NULL : mag->page->next->subpages;
+			npage = page->next;
 			
-			for(mag->page->next_subpage = mag->page->subpages->next_subpage;
-			    mag->page->next_subpage != mag->page;
-			    mag->page->next_subpage = nsubpage)
+			/* Free the other subpages of this page */
+			for(subpage = page->next_subpage; subpage != page; subpage = nsubpage)
 			{
-				nsubpage = mag->page->next_subpage->next_subpage;
+				nsubpage = subpage->next_subpage;
 				
-				free(mag->page->next_subpage->data);
-				free(mag->page->next_subpage);
+				free(subpage->data);
+				free(subpage);
 			}
 			
-			free(mag->page->data);
-			free(mag->page);
-			
-			mag->page = npage;
+			free(page->data);
+			free(page);
 		}
 		
 		mag->pages = NULL;
+		mag->page = NULL;
+		mag->ring = NULL;
+		mag->npages = 0;
+		mag->nprio = 0;
+		memset(mag->index, 0, sizeof(mag->index));
+		memset(mag->present, 0, sizeof(mag->present));
 	}
 }
 
-
-
-int tt_init(tt_t *s, vid_t *vid, char *path)
+static void _remove_page(tt_service_t *s, uint16_t pgno, uint8_t subno)
 {
-	int level;
-	struct stat fs;
-	
-	memset(s, 0, sizeof(tt_t));
-	s->text = malloc(256 * sizeof(char));
+	tt_magazine_t *mag;
+	tt_page_t *prev;
+	tt_page_t *page;
+	tt_page_t *psub;
+	tt_page_t *sub;
+	tt_page_t *p;
+	int pg;
 	
-	/* Calculate the high level for teletext data, 66% of the white level */
-	level = round((vid->white_level - vid->black_level) * 0.66);
+	mag = &s->magazines[(pgno >> 8) & 0x07];
+	pg = pgno & 0xFF;
+	page = mag->index[pg];
 	
-	s->vid = vid;
-	s->lut = vbidata_init(
-		360, s->vid->width,
-		level,
-		VBIDATA_FILTER_RC, (double) s->vid->width / 444, 0.7,
-		vid->pixel_rate * (12e-6 - (64e-6 / 444 * 12))
-	);
+	if(page == NULL)
+	{
+		return;
+	}
 	
-	if(!s->lut)
+	/* Find the subpage */
+	for(psub = page; psub->next_subpage->subpage != subno; psub = psub->next_subpage)
 	{
-		return(VID_OUT_OF_MEMORY);
+		if(psub->next_subpage == page) return;
 	}
 	
-	/* Is the path to a raw teletext packet source? */
-	if(strncmp(path, "raw:", 4) == 0)
+	sub = psub->next_subpage;
+	prev = _prev_page(mag, pg);
+	
+	if(sub->next_subpage == sub)
 	{
-		if(strcmp(path + 4, "-") == 0)
+		/* This is the only subpage, remove the whole page */
+		mag->index[pg] = NULL;
+		mag->npages--;
+		_set_present(mag, pg, 0);
+		_set_repeat(mag, pg, 0);
+		
+		if(page->next == page)
 		{
-			s->raw = stdin;
+			/* The magazine is now empty */
+			mag->pages = NULL;
+			mag->page = NULL;
+			mag->ring = NULL;
+			mag->row = 0;
+			mag->filler = 0;
 		}
 		else
 		{
-			s->raw = fopen(path + 4, "rb");
+			prev->next = page->next;
+			
+			if(mag->pages == page)
+			{
+				mag->pages = page->next;
+			}
+			
+			if(mag->ring == page)
+			{
+				mag->ring = mag->page == page ? page->next : prev;
+			}
 			
-			if(!s->raw)
+			if(mag->page == page)
 			{
-				fprintf(stderr, "%s: ", path + 4);
-				perror("fopen");
-				tt_free(s);
-				return(VID_ERROR);
+				mag->page = page->next;
+				mag->row = 0;
 			}
 		}
-		
-		return(VID_OK);
-	}
-	
-	_new_service(&s->service);
-	
-	if(strcmp(path,"subtitles") == 0)
-	{
-		sprintf(s->text,"%s", " ");
-		update_teletext_subtitle(s->text, &s->service);
 	}
 	else
 	{
-		/* Test if the path is a file or a directory */
-		if(stat(path, &fs) != 0)
+		/* Unlink the subpage */
+		p = sub->next_subpage;
+		psub->next_subpage = p;
+		
+		if(page->subpages == sub)
 		{
-			fprintf(stderr, "%s: ", path);
-			perror("stat");
-			tt_free(s);
-			return(VID_ERROR);
+			/* The first subpage has gone */
+			psub = p;
+			
+			do
+			{
+				psub->subpages = p;
+				psub = psub->next_subpage;
+			}
+			while(psub != p);
 		}
 		
-		if(fs.st_mode & S_IFDIR)
+		if(sub == page)
 		{
-			DIR *dir;
-			struct dirent *ent;
-			char filename[PATH_MAX];
-			
-			/* Path is a directory, scan all the files within */
+			/* This subpage is on air, replace it with the next one */
+			if(page->next == page)
+			{
+				p->next = p;
+			}
+			else
+			{
+				p->next = page->next;
+				prev->next = p;
+			}
 			
-			dir = opendir(path);
+			mag->index[pg] = p;
 			
-			if(!dir)
+			if(mag->pages == sub)
 			{
-				fprintf(stderr, "%s: ", path);
-				perror("opendir");
-				tt_free(s);
-				return(VID_ERROR);
+				mag->pages = p;
 			}
 			
-			while((ent = readdir(dir)))
+			if(mag->ring == sub)
 			{
-				/* Skip hidden dot files */
-				if(ent->d_name[0] == '.')
-				{
-					continue;
-				}
-				
-				snprintf(filename, PATH_MAX, "%s/%s", path, ent->d_name);
-				_load_tti(&s->service, filename);
+				mag->ring = p;
 			}
 			
-			closedir(dir);
-		}
-		else if(fs.st_mode & S_IFREG)
-		{
-			/* Path is a single file */
-			_load_tti(&s->service, path);
-		}
-		else
-		{
-			fprintf(stderr, "%s: Not a file or directory\n", path);
+			if(mag->page == sub)
+			{
+				mag->page = p;
+				mag->row = 0;
+				p->erase = 1;
+			}
 		}
 	}
-	return(VID_OK);
+	
+	free(sub->data);
+	free(sub);
 }
 
-void tt_free(tt_t *s)
+static tt_file_t **_find_file(tt_t *s, const char *name)
 {
-	if(s == NULL) return;
+	tt_file_t **f;
 	
-	if(s->raw && s->raw != stdin)
-	{
-		fclose(s->raw);
-	}
-	else
+	for(f = &s->files; *f; f = &(*f)->next)
 	{
-		_free_service(&s->service);
+		if(strcmp((*f)->name, name) == 0) break;
 	}
 	
-	free(s->lut);
-	
-	memset(s, 0, sizeof(tt_t));
+	return(f);
 }
 
-int tt_next_packet(tt_t *s, uint8_t vbi[45], int frame, int line)
+static void _apply_update(tt_t *s, tt_update_t *u)
 {
-	int r;
+	tt_file_t **pf, *f;
+	tt_page_t *page, *next;
+	uint32_t *keys = NULL;
+	int nkeys = 0;
+	int i, j;
 	
-	/* Update the timecode */
-	s->timecode  = (frame - 1) * s->vid->conf.lines;
-	s->timecode += line - 1;
+	pf = _find_file(s, u->name);
+	f = *pf;
+	
+	/* List the pages in the new version of the file */
+	for(page = u->pages; page; page = page->next)
+	{
+		nkeys++;
+	}
 	
-	/* Fetch the next line, or TT_NO_PACKET */
-	if(s->raw)
+	if(nkeys > 0)
 	{
-		if(feof(s->raw))
+		keys = malloc(sizeof(uint32_t) * nkeys);
+		if(!keys)
 		{
-			/* Return to the start of the file when we hit the end */
-			fseek(s->raw, 0, SEEK_SET);
+			perror("malloc");
+			_free_pages(u->pages);
+			return;
 		}
 		
-		/* Synchronization sequence (Clock run-in and framing code) */
-		vbi[0] = 0x55;
-		vbi[1] = 0x55;
-		vbi[2] = 0x27;
+		for(i = 0, page = u->pages; page; page = page->next)
+		{
+			keys[i++] = page->page << 8 | page->subpage;
+		}
+	}
+	
+	if(f)
+	{
+		/* Remove any pages no longer in the file */
+		for(i = 0; i < f->nkeys; i++)
+		{
+			for(j = 0; j < nkeys && keys[j] != f->keys[i]; j++);
+			
+			if(j == nkeys)
+			{
+				_remove_page(&s->service, f->keys[i] >> 8, f->keys[i] & 0xFF);
+			}
+		}
 		
-		r = fread(&vbi[3], 1, 42, s->raw);
-		r = r == 42 ? TT_OK : TT_NO_PACKET;
+		free(f->keys);
+		f->keys = NULL;
+		f->nkeys = 0;
 	}
-	else
+	
+	/* Add the new pages, replacing any existing ones */
+	for(page = u->pages; page; page = next)
 	{
-		r = _next_packet(&s->service, vbi, s->timecode);
+		next = page->next;
+		_add_page(&s->service, page);
+	}
+	
+	u->pages = NULL;
+	
+	/* Restart any page that was replaced mid-transmission,
+	 * so its header, erase flag and CRC are sent again */
+	for(i = 0; i < 8; i++)
+	{
+		tt_magazine_t *mag = &s->service.magazines[i];
+		
+		if(mag->page && mag->page->update)
+		{
+			mag->page->update = 0;
+			mag->row = 0;
+		}
+	}
+	
+	if(nkeys == 0)
+	{
+		/* The file has gone, forget about it */
+		if(f)
+		{
+			*pf = f->next;
+			free(f->name);
+			free(f);
+		}
+		
+		return;
+	}
+	
+	if(!f)
+	{
+		f = calloc(1, sizeof(tt_file_t));
+		if(!f)
+		{
+			perror("calloc");
+			free(keys);
+			return;
+		}
+		
+		f->name = u->name;
+		u->name = NULL;
+		*pf = f;
+	}
+	
+	f->keys = keys;
+	f->nkeys = nkeys;
+}
+
+static void _free_update(tt_update_t *u)
+{
+	_free_pages(u->pages);
+	free(u->name);
+	free(u);
+}
+
+static void _apply_updates(tt_t *s)
+{
+	tt_update_t *u, *list, *next;
+	
+	/* Take all pending updates */
+	u = __atomic_exchange_n(&s->updates, NULL, __ATOMIC_ACQUIRE);
+	
+	/* They were pushed in reverse order */
+	for(list = NULL; u; u = next)
+	{
+		next = u->next;
+		u->next = list;
+		list = u;
+	}
+	
+	for(u = list; u; u = next)
+	{
+		next = u->next;
+		_apply_update(s, u);
+		_free_update(u);
+	}
+}
+
+static void _push_update(tt_t *s, tt_update_t *u)
+{
+	u->next = __atomic_load_n(&s->updates, __ATOMIC_RELAXED);
+	
+	while(!__atomic_compare_exchange_n(&s->updates, &u->next, u, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/* Parse a file in the teletext directory and queue it for the renderer */
+static void _queue_file(tt_t *s, const char *name)
+{
+	char filename[PATH_MAX];
+	struct stat fs;
+	tt_update_t *u;
+	
+	/* Skip hidden dot files */
+	if(name[0] == '.')
+	{
+		return;
+	}
+	
+	u = calloc(1, sizeof(tt_update_t));
+	if(!u)
+	{
+		perror("calloc");
+		return;
+	}
+	
+	u->name = strdup(name);
+	if(!u->name)
+	{
+		perror("strdup");
+		free(u);
+		return;
+	}
+	
+	snprintf(filename, PATH_MAX, "%s/%s", s->path, name);
+	
+	/* A missing or unreadable file queues an empty update, which
+	 * removes any pages it had loaded before */
+	if(stat(filename, &fs) == 0 && (fs.st_mode & S_IFREG))
+	{
+		_load_tti(&u->pages, filename);
+	}
+	
+	_push_update(s, u);
+}
+
+static void *_watch_thread(void *arg)
+{
+	tt_t *s = arg;
+	struct dirent *ent;
+	
+	/* The thread can only be cancelled while it waits in poll() */
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+	
+	/* Load the initial set of pages. They go on air as they are parsed.
+	 * The directory was opened by tt_init(), so errors are reported there */
+	while(!__atomic_load_n(&s->abort, __ATOMIC_RELAXED) && (ent = readdir(s->dir)))
+	{
+		_queue_file(s, ent->d_name);
+	}
+	
+	closedir(s->dir);
+	s->dir = NULL;
+	
+#ifdef __linux__
+	/* Reload files as they are changed */
+	while(s->watch_fd >= 0 && !__atomic_load_n(&s->abort, __ATOMIC_RELAXED))
+	{
+		char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+		const struct inotify_event *ev;
+		struct pollfd pfd[2];
+		ssize_t len;
+		char *p;
+		int r;
+		
+		pfd[0].fd = s->watch_fd;
+		pfd[0].events = POLLIN;
+		pfd[1].fd = s->wake_fd;
+		pfd[1].events = POLLIN;
+		
+		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+		r = poll(pfd, 2, -1);
+		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+		
+		if(r < 0)
+		{
+			if(errno == EINTR) continue;
+			perror("poll");
+			break;
+		}
+		
+		if(pfd[1].revents)
+		{
+			/* Woken by tt_free() */
+			break;
+		}
+		
+		len = read(s->watch_fd, buf, sizeof(buf));
+		if(len <= 0)
+		{
+			if(len < 0 && errno == EINTR) continue;
+			perror("read");
+			break;
+		}
+		
+		for(p = buf; p < buf + len; p += sizeof(struct inotify_event) + ev->len)
+		{
+			ev = (const struct inotify_event *) p;
+			
+			if(ev->len > 0 && (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM)))
+			{
+				_queue_file(s, ev->name);
+			}
+		}
+	}
+#endif
+	
+	return(NULL);
+}
+
+/* Decode a packet's magazine and row as magazine | row << 3 */
+static uint8_t _raw_addr(const uint8_t *p)
+{
+	uint8_t m = _unhamming84_lut[p[0]];
+	uint8_t y = _unhamming84_lut[p[1]];
+	
+	if(m == 0xFF || y == 0xFF)
+	{
+		return(0xFF);
+	}
+	
+	return((m & 7) | (m >> 3 | y << 1) << 3);
+}
+
+static int _raw_open(tt_t *s, const char *path)
+{
+	tt_raw_t *r;
+	uint8_t a;
+	size_t i;
+	
+	r = realloc(s->raw, sizeof(tt_raw_t) * (s->nraw + 1));
+	if(!r)
+	{
+		perror("realloc");
+		return(VID_OUT_OF_MEMORY);
+	}
+	
+	s->raw = r;
+	r = &s->raw[s->nraw];
+	memset(r, 0, sizeof(tt_raw_t));
+	
+	if(strcmp(path, "-") == 0)
+	{
+		/* A stream can't be indexed, so it claims every magazine */
+		r->stream = stdin;
+		r->magazines = 0xFF;
+		s->nraw++;
+		
+		return(VID_OK);
+	}
+	else
+	{
+		struct stat fs;
+		int fd;
+		
+		/* Without O_BINARY, Windows would translate line endings
+		 * in the packet data as it's read */
+		fd = open(path, O_RDONLY | O_BINARY);
+		
+		if(fd < 0 || fstat(fd, &fs) != 0)
+		{
+			fprintf(stderr, "%s: ", path);
+			perror("open");
+			if(fd >= 0) close(fd);
+			return(VID_ERROR);
+		}
+		
+		r->packets = fs.st_size / 42;
+		r->length = r->packets * 42;
+		
+		if(r->packets == 0)
+		{
+			fprintf(stderr, "%s: No teletext packets found\n", path);
+			close(fd);
+			return(VID_ERROR);
+		}
+		
+#ifndef _WIN32
+		r->data = mmap(NULL, r->length, PROT_READ, MAP_PRIVATE, fd, 0);
+		
+		if(r->data == MAP_FAILED)
+		{
+			r->data = NULL;
+		}
+		else
+		{
+			madvise((void *) r->data, r->length, MADV_SEQUENTIAL);
+		}
+#else
+		uint8_t *data = malloc(r->length);
+		
+		if(data && read(fd, data, r->length) != (ssize_t) r->length)
+		{
+			free(data);
+			data = NULL;
+		}
+		
+		r->data = data;
+#endif
+		
+		close(fd);
+		
+		if(r->data == NULL)
+		{
+			fprintf(stderr, "%s: ", path);
+			perror("mmap");
+			return(VID_ERROR);
+		}
+	}
+	
+	/* Account for the source now so tt_free() releases it */
+	s->nraw++;
+	
+	/* Build the index */
+	r->addr = malloc(r->packets);
+	if(!r->addr)
+	{
+		perror("malloc");
+		return(VID_OUT_OF_MEMORY);
+	}
+	
+	r->loop_start = r->packets;
+	r->loop_end = r->packets;
+	
+	for(i = 0; i < r->packets; i++)
+	{
+		a = r->addr[i] = _raw_addr(&r->data[i * 42]);
+		
+		if(a == 0xFF)
+		{
+			continue;
+		}
+		
+		if(a >> 3 < 30)
+		{
+			r->magazines |= 1 << (a & 7);
+		}
+		
+		if(a >> 3 == 0)
+		{
+			/* A page header, which may be a loop point */
+			if(r->loop_start == r->packets)
+			{
+				r->loop_start = i;
+			}
+			else
+			{
+				r->loop_end = i;
+			}
+		}
+	}
+	
+	if(r->loop_start == r->packets)
+	{
+		/* No page headers, play the whole file */
+		r->loop_start = 0;
+	}
+	
+	r->pos = r->loop_start;
+	
+	return(VID_OK);
+}
+
+static int _raw_next_packet(tt_raw_t *r, uint8_t vbi[45])
+{
+	uint8_t a;
+	
+	if(r->stream)
+	{
+		if(fread(&vbi[3], 1, 42, r->stream) != 42)
+		{
+			return(TT_NO_PACKET);
+		}
+		
+		a = _raw_addr(&vbi[3]);
+	}
+	else
+	{
+		/* Return to the first page when we reach the last */
+		if(r->pos >= r->loop_end)
+		{
+			r->pos = r->loop_start;
+		}
+		
+		a = r->addr[r->pos];
+		memcpy(&vbi[3], &r->data[r->pos++ * 42], 42);
+	}
+	
+	/* Drop packets that belong to another source */
+	if(r->skip || r->skip_service)
+	{
+		if(a == 0xFF ||
+		   (r->skip & (1 << (a & 7))) ||
+		   (r->skip_service && a >> 3 >= 30))
+		{
+			return(TT_NO_PACKET);
+		}
+	}
+	
+	return(TT_OK);
+}
+
+static void _raw_free(tt_raw_t *r)
+{
+	if(r->data)
+	{
+#ifndef _WIN32
+		munmap((void *) r->data, r->length);
+#else
+		free((void *) r->data);
+#endif
+	}
+	
+	free(r->addr);
+}
+
+static int _tti_open(tt_t *s, const char *path)
+{
+	struct stat fs;
+	
+	s->has_service = 1;
+	
+	if(strcmp(path, "subtitles") == 0)
+	{
+		sprintf(s->text,"%s", " ");
+		update_teletext_subtitle(s->text, &s->service);
+		return(VID_OK);
+	}
+	
+	/* Test if the path is a file or a directory */
+	if(stat(path, &fs) != 0)
+	{
+		fprintf(stderr, "%s: ", path);
+		perror("stat");
+		return(VID_ERROR);
+	}
+	
+	if(fs.st_mode & S_IFDIR)
+	{
+		if(s->path)
+		{
+			fprintf(stderr, "%s: Only one teletext directory can be used\n", path);
+			return(VID_ERROR);
+		}
+		
+		/* Path is a directory. The files within are loaded on a
+		 * background thread, which then watches for changes */
+		s->path = strdup(path);
+		s->watch_fd = -1;
+		s->wake_fd = -1;
+		
+		if(!s->path)
+		{
+			perror("strdup");
+			return(VID_OUT_OF_MEMORY);
+		}
+		
+		s->dir = opendir(path);
+		
+		if(!s->dir)
+		{
+			fprintf(stderr, "%s: ", path);
+			perror("opendir");
+			return(VID_ERROR);
+		}
+		
+#ifdef __linux__
+		s->watch_fd = inotify_init1(IN_CLOEXEC);
+		s->wake_fd = eventfd(0, EFD_CLOEXEC);
+		
+		if(s->watch_fd < 0 || s->wake_fd < 0 ||
+		   inotify_add_watch(s->watch_fd, path, IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM) < 0)
+		{
+			fprintf(stderr, "%s: ", path);
+			perror("inotify");
+			fprintf(stderr, "Teletext pages will not be reloaded\n");
+			
+			if(s->watch_fd >= 0) close(s->watch_fd);
+			s->watch_fd = -1;
+		}
+#endif
+		
+		if(pthread_create(&s->watch_thread, NULL, &_watch_thread, (void *) s) != 0)
+		{
+			perror("pthread_create");
+			closedir(s->dir);
+			s->dir = NULL;
+			return(VID_ERROR);
+		}
+		
+		s->watching = 1;
+	}
+	else if(fs.st_mode & S_IFREG)
+	{
+		tt_page_t *page, *next;
+		
+		/* Path is a single file */
+		_load_tti(&page, (char *) path);
+		
+		for(; page; page = next)
+		{
+			next = page->next;
+			_add_page(&s->service, page);
+		}
+	}
+	else
+	{
+		fprintf(stderr, "%s: Not a file or directory\n", path);
+	}
+	
+	return(VID_OK);
+}
+
+int tt_init(tt_t *s, vid_t *vid, char *path)
+{
+	int level;
+	char *list, *src, *save;
+	uint8_t mask;
+	int i, r;
+	
+	memset(s, 0, sizeof(tt_t));
+	s->text = malloc(256 * sizeof(char));
+	
+	/* Calculate the high level for teletext data, 66% of the white level */
+	level = round((vid->white_level - vid->black_level) * 0.66);
+	
+	s->vid = vid;
+	s->lut = vbidata_init(
+		360, s->vid->width,
+		level,
+		VBIDATA_FILTER_RC, (double) s->vid->width / 444, 0.7,
+		vid->pixel_rate * (12e-6 - (64e-6 / 444 * 12))
+	);
+	
+	if(!s->lut)
+	{
+		return(VID_OUT_OF_MEMORY);
+	}
+	
+	/* Render whole bytes at a time */
+	s->lut8 = vbidata_init8(s->lut, 0, VBIDATA_LSB_FIRST);
+	
+	if(!s->lut8)
+	{
+		tt_free(s);
+		return(VID_OUT_OF_MEMORY);
+	}
+	
+	_new_service(&s->service);
+	
+	/* The path is a comma separated list of sources. Each is either
+	 * a raw packet source (raw:<file> or raw:-), a TTI file or
+	 * directory, or "subtitles" */
+	list = strdup(path);
+	if(!list)
+	{
+		tt_free(s);
+		return(VID_OUT_OF_MEMORY);
+	}
+	
+	r = VID_OK;
+	
+	for(src = strtok_r(list, ",", &save); src && r == VID_OK; src = strtok_r(NULL, ",", &save))
+	{
+		if(strncmp(src, "raw:", 4) == 0)
+		{
+			r = _raw_open(s, src + 4);
+		}
+		else
+		{
+			r = _tti_open(s, src);
+		}
+	}
+	
+	free(list);
+	
+	if(r != VID_OK)
+	{
+		tt_free(s);
+		return(r);
+	}
+	
+	/* In parallel mode each magazine can only come from one source.
+	 * Raw sources take them first, in the order given, and the
+	 * service uses whatever is left */
+	for(mask = 0, i = 0; i < s->nraw; i++)
+	{
+		s->raw[i].skip = mask;
+		s->raw[i].skip_service = s->has_service;
+		mask |= s->raw[i].magazines;
+	}
+	
+	s->service.skip = mask;
+	
+	return(VID_OK);
+}
+
+void tt_free(tt_t *s)
+{
+	tt_update_t *u;
+	tt_file_t *f;
+	
+	if(s == NULL) return;
+	
+	if(s->watching)
+	{
+		__atomic_store_n(&s->abort, 1, __ATOMIC_RELAXED);
+		
+#ifdef __linux__
+		if(s->wake_fd >= 0)
+		{
+			uint64_t one = 1;
+			ssize_t r;
+			
+			do
+			{
+				r = write(s->wake_fd, &one, sizeof(one));
+			}
+			while(r < 0 && errno == EINTR);
+			
+			if(r != sizeof(one))
+			{
+				/* The thread would never wake, stop it in poll() instead */
+				perror("write");
+				pthread_cancel(s->watch_thread);
+			}
+		}
+#endif
+		
+		pthread_join(s->watch_thread, NULL);
+	}
+	
+#ifdef __linux__
+	if(s->path)
+	{
+		if(s->watch_fd >= 0) close(s->watch_fd);
+		if(s->wake_fd >= 0) close(s->wake_fd);
+	}
+#endif
+	
+	while(s->nraw > 0)
+	{
+		_raw_free(&s->raw[--s->nraw]);
+	}
+	
+	free(s->raw);
+	
+	/* Free any updates that never made it on air */
+	while((u = s->updates) != NULL)
+	{
+		s->updates = u->next;
+		_free_update(u);
+	}
+	
+	while((f = s->files) != NULL)
+	{
+		s->files = f->next;
+		free(f->name);
+		free(f->keys);
+		free(f);
+	}
+	
+	_free_service(&s->service);
+	
+	free(s->path);
+	free(s->text);
+	
+	free(s->lut8);
+	free(s->lut);
+	
+	memset(s, 0, sizeof(tt_t));
+}
+
+int tt_next_packet(tt_t *s, uint8_t vbi[45], int frame, int line)
+{
+	int i, n, src;
+	int r;
+	
+	/* Update the timecode */
+	s->timecode  = (frame - 1) * s->vid->conf.lines;
+	s->timecode += line - 1;
+	
+	/* Put any reloaded pages on air */
+	if(__atomic_load_n(&s->updates, __ATOMIC_ACQUIRE) != NULL)
+	{
+		_apply_updates(s);
+	}
+	
+	/* Synchronization sequence (Clock run-in and framing code) */
+	vbi[0] = 0x55;
+	vbi[1] = 0x55;
+	vbi[2] = 0x27;
+	
+	/* Offer the line to each source in turn, or return TT_NO_PACKET */
+	n = s->nraw + (s->has_service ? 1 : 0);
+	
+	for(r = TT_NO_PACKET, i = 0; r != TT_OK && i < n; i++)
+	{
+		src = s->source;
+		s->source = (s->source + 1) % n;
+		
+		if(src < s->nraw)
+		{
+			r = _raw_next_packet(&s->raw[src], vbi);
+		}
+		else
+		{
+			r = _next_packet(&s->service, vbi, s->timecode);
+		}
 	}
 	
 	return(r);
@@ -1352,7 +2340,7 @@ int tt_render_line(vid_t *s, void *arg, int nlines, vid_line_t **lines)
 		
 		if(r == TT_OK)
 		{
-			vbidata_render(tt->lut, vbi, 0, 360, VBIDATA_LSB_FIRST, l);
+			vbidata_render8(tt->lut8, vbi, 360, l);
 		}
 		
 		l->vbialloc = 1;
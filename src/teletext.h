@@ -21,6 +21,8 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <time.h>
+#include <pthread.h>
+#include <dirent.h>
 #include "video.h"
 #include "vbidata.h"
 
@@ -29,6 +31,13 @@
 #define TT_NO_PACKET     2
 #define TT_OUT_OF_MEMORY 3
 
+/* Repetition priorities, in transmissions per magazine cycle */
+#define TT_REPEAT_INDEX    2
+#define TT_REPEAT_SUBTITLE 4
+
+/* Target minimum rate of header packets, per second */
+#define TT_HEADER_RATE 20
+
 typedef struct _tt_page_t {
 	
 	/* The page number, 0x100 - 0x8FF */
@@ -97,6 +106,27 @@ typedef struct {
 	/* A pointer to the currently active page */
 	tt_page_t *page;
 	
+	/* The last page sent in ring order. Priority pages are
+	 * sent between ring pages without moving this */
+	tt_page_t *ring;
+	
+	/* Index of the pages by number (0x00 - 0xFF). Each entry
+	 * points to the page's current subpage in the ring */
+	tt_page_t *index[0x100];
+	int npages;
+	
+	/* One bit for each page number in the index, to find
+	 * the page before a given one without a scan */
+	uint64_t present[4];
+	
+	/* Pages that are sent more than once per cycle. Each
+	 * earns (repeat - 1) credits for every ring page sent and
+	 * is sent again out of order once it has npages credits */
+	int nprio;
+	uint8_t prio[0x100];
+	uint8_t repeat[0x100];
+	int credit[0x100];
+	
 	/* The currently active row */
 	int row;
 	
@@ -122,21 +152,98 @@ typedef struct {
 	 * 8/30 packet, containing the updated time */
 	unsigned int second_delay;
 	
+	/* The target maximum number of ticks between header
+	 * packets, and the timecode of the last one sent. Headers
+	 * keep the clock and page counter rolling on receivers */
+	unsigned int header_interval;
+	unsigned int last_header;
+	
 	/* The currently active magazine */
 	unsigned int magazine;
 	
+	/* Magazines carried by a raw packet source, which are skipped */
+	uint8_t skip;
+	
 	/* The available magazines */
 	tt_magazine_t magazines[8];
 	
 } tt_service_t;
 
+/* A reloaded TTI file, passed from the watcher thread to the renderer.
+ * A NULL page list removes any pages previously loaded from the file */
+typedef struct _tt_update_t {
+	char *name;
+	tt_page_t *pages;
+	struct _tt_update_t *next;
+} tt_update_t;
+
+/* The pages currently on air from each TTI file */
+typedef struct _tt_file_t {
+	char *name;
+	uint32_t *keys; /* page << 8 | subpage */
+	int nkeys;
+	struct _tt_file_t *next;
+} tt_file_t;
+
+/* A raw teletext packet source. Files are mapped into memory and indexed
+ * when opened; stdin is read one packet at a time */
+typedef struct {
+	FILE *stream;
+	
+	/* The packets, 42 bytes each */
+	const uint8_t *data;
+	size_t length;
+	size_t packets;
+	
+	/* Index of each packet's address, magazine | row << 3,
+	 * or 0xFF if it could not be decoded (or is 7/31) */
+	uint8_t *addr;
+	
+	/* The next packet, and the loop points. These fall on the
+	 * first and last page headers in the file */
+	size_t pos;
+	size_t loop_start;
+	size_t loop_end;
+	
+	/* Magazines carried by this source, and those carried
+	 * by an earlier one which are dropped */
+	uint8_t magazines;
+	uint8_t skip;
+	
+	/* Drop packets 30 and 31, the service sends its own */
+	int skip_service;
+	
+} tt_raw_t;
+
 typedef struct {
 	vid_t *vid;
 	vbidata_lut_t *lut;
-	FILE *raw;
+	vbidata_lut8_t *lut8;
+	
+	/* Raw packet sources */
+	tt_raw_t *raw;
+	int nraw;
+	
+	/* Set if the TTI / subtitle service is in use */
+	int has_service;
+	
+	/* The next source to offer a line to */
+	int source;
+	
 	tt_service_t service;
 	unsigned int timecode;
 	char *text;
+	
+	/* Directory loader / watcher */
+	char *path;
+	DIR *dir;
+	pthread_t watch_thread;
+	int watching;
+	int watch_fd;
+	int wake_fd;
+	int abort;
+	tt_update_t *updates;
+	tt_file_t *files;
 } tt_t;
 
 extern int tt_init(tt_t *s, vid_t *vid, char *path);
@@ -183,13 +183,47 @@ vbidata_lut_t *vbidata_init_step(unsigned int nsymbols, unsigned int dwidth, int
 	return(lut);
 }
 
-void vbidata_render(const vbidata_lut_t *lut, const uint8_t *src, int offset, int length, int order, vid_line_t *line)
+static void _render_symbol(const vbidata_lut_t *lut, vid_line_t *line)
 {
-	int b = -offset;
 	int x, lx;
-	int bit;
 	vid_line_t *l;
 	
+	x = 0;
+	lx = lut->offset;
+	l = line;
+	
+	/* Move to the previous line if the offset for this symbol is negative */
+	while(lx < 0 && l->width > 0)
+	{
+		l = l->previous;
+		lx += l->width;
+	}
+	
+	/* Lines with zero length mark a boundary we can't pass */
+	if(l->width == 0)
+	{
+		l = l->next;
+		x = -lx;
+		lx = 0;
+	}
+	
+	/* Render the symbol - moving to the next line if necessary */
+	while(x < lut->length && l->width > 0)
+	{
+		for(; x < lut->length && lx < l->width; x++, lx++)
+		{
+			l->output[lx * 2] += lut->value[x];
+		}
+		
+		l = l->next;
+		lx = 0;
+	}
+}
+
+static void _render(const vbidata_lut_t *lut, const uint8_t *src, int b, int length, int order, vid_line_t *line)
+{
+	int bit;
+	
 	/* LUT format:
 	 * 
 	 * Array of int16's:
@@ -204,37 +238,166 @@ void vbidata_render(const vbidata_lut_t *lut, const uint8_t *src, int offset, in
 		
 		if(bit)
 		{
-			x = 0;
-			lx = lut->offset;
-			l = line;
-			
-			/* Move to the previous line if the offset for this symbol is negative */
-			while(lx < 0 && l->width > 0)
-			{
-				l = l->previous;
-				lx += l->width;
-			}
+			_render_symbol(lut, line);
+		}
+	}
+}
+
+void vbidata_render(const vbidata_lut_t *lut, const uint8_t *src, int offset, int length, int order, vid_line_t *line)
+{
+	_render(lut, src, -offset, length, order, line);
+}
+
+vbidata_lut8_t *vbidata_init8(const vbidata_lut_t *lut, int offset, int order)
+{
+	const vbidata_lut_t *sym[8];
+	const vbidata_lut_t *p;
+	vbidata_lut8_t *lut8;
+	vbidata_lut8_byte_t *e;
+	int16_t *values;
+	size_t l;
+	int nsymbols, nbytes;
+	int k, j, v, x, x1, x2;
+	
+	/* Count the symbols. The first offset symbols are always zero */
+	for(p = lut, nsymbols = 0; p->length != -1; p = (vbidata_lut_t *) &p->value[p->length])
+	{
+		nsymbols++;
+	}
+	
+	nbytes = nsymbols > offset ? (nsymbols - offset) / 8 : 0;
+	
+	/* Calculate the size of the table */
+	l = sizeof(vbidata_lut8_t) + sizeof(vbidata_lut8_byte_t) * (nbytes + 1);
+	
+	for(p = lut, j = 0; j < offset && p->length != -1; j++)
+	{
+		p = (vbidata_lut_t *) &p->value[p->length];
+	}
+	
+	for(k = 0; k < nbytes; k++)
+	{
+		x1 = INT16_MAX;
+		x2 = INT16_MIN;
+		
+		for(j = 0; j < 8; j++, p = (vbidata_lut_t *) &p->value[p->length])
+		{
+			if(p->length == 0) continue;
+			if(p->offset < x1) x1 = p->offset;
+			if(p->offset + p->length > x2) x2 = p->offset + p->length;
+		}
+		
+		if(x2 > x1)
+		{
+			l += sizeof(int16_t) * 256 * (x2 - x1);
+		}
+	}
+	
+	lut8 = malloc(l);
+	if(!lut8)
+	{
+		return(NULL);
+	}
+	
+	lut8->nbytes = nbytes;
+	lut8->order = order;
+	values = (int16_t *) &lut8->bytes[nbytes + 1];
+	
+	/* Build each byte's waveforms */
+	for(p = lut, j = 0; j < offset && p->length != -1; j++)
+	{
+		p = (vbidata_lut_t *) &p->value[p->length];
+	}
+	
+	for(k = 0; k <= nbytes; k++)
+	{
+		e = &lut8->bytes[k];
+		e->bits = p;
+		e->offset = 0;
+		e->length = 0;
+		e->values = values;
+		
+		if(k == nbytes) break;
+		
+		/* Find the span of this byte's symbols */
+		x1 = INT16_MAX;
+		x2 = INT16_MIN;
+		
+		for(j = 0; j < 8; j++, p = (vbidata_lut_t *) &p->value[p->length])
+		{
+			sym[order == VBIDATA_LSB_FIRST ? j : 7 - j] = p;
 			
-			/* Lines with zero length mark a boundary we can't pass */
-			if(l->width == 0)
+			if(p->length == 0) continue;
+			if(p->offset < x1) x1 = p->offset;
+			if(p->offset + p->length > x2) x2 = p->offset + p->length;
+		}
+		
+		if(x2 <= x1) continue;
+		
+		e->offset = x1;
+		e->length = x2 - x1;
+		
+		/* Sum the symbols for each byte value. The int16 sums wrap
+		 * exactly as adding the symbols one at a time would */
+		for(v = 0; v < 256; v++, values += e->length)
+		{
+			for(x = 0; x < e->length; x++)
 			{
-				l = l->next;
-				x = -lx;
-				lx = 0;
+				values[x] = 0;
 			}
 			
-			/* Render the symbol - moving to the next line if necessary */
-			while(x < lut->length && l->width > 0)
+			for(j = 0; j < 8; j++)
 			{
-				for(; x < lut->length && lx < l->width; x++, lx++)
+				if(((v >> j) & 1) == 0) continue;
+				
+				for(x = 0; x < sym[j]->length; x++)
 				{
-					l->output[lx * 2] += lut->value[x];
+					values[sym[j]->offset - x1 + x] += sym[j]->value[x];
 				}
-				
-				l = l->next;
-				lx = 0;
 			}
 		}
 	}
+	
+	return(lut8);
 }
 
+void vbidata_render8(const vbidata_lut8_t *lut, const uint8_t *src, int length, vid_line_t *line)
+{
+	const vbidata_lut8_byte_t *e;
+	const int16_t *v;
+	int16_t *o;
+	int n, k, x;
+	
+	n = length / 8;
+	if(n > lut->nbytes) n = lut->nbytes;
+	
+	for(k = 0; k < n; k++)
+	{
+		if(src[k] == 0) continue;
+		
+		e = &lut->bytes[k];
+		
+		if(e->offset >= 0 && e->offset + e->length <= line->width)
+		{
+			/* The whole byte falls within this line */
+			o = &line->output[e->offset * 2];
+			v = &e->values[src[k] * e->length];
+			
+			for(x = 0; x < e->length; x++)
+			{
+				o[x * 2] += v[x];
+			}
+		}
+		else
+		{
+			/* This byte crosses a line boundary, render it a bit at a time */
+			_render(e->bits, &src[k], 0, 8, lut->order, line);
+		}
+	}
+	
+	/* Render any remaining symbols a bit at a time */
+	if(n * 8 < length)
+	{
+		_render(lut->bytes[n].bits, &src[n], 0, length - n * 8, lut->order, line);
+	}
+}
@@ -31,11 +31,28 @@ typedef struct {
 	int16_t value[];
 } vbidata_lut_t;
 
+/* Byte LUT. Each entry holds the summed waveform of 8 symbols for every
+ * possible byte value, so whole bytes can be rendered with one pass */
+typedef struct {
+	int16_t offset;
+	int16_t length;
+	const vbidata_lut_t *bits;
+	const int16_t *values;
+} vbidata_lut8_byte_t;
+
+typedef struct {
+	int nbytes;
+	int order;
+	vbidata_lut8_byte_t bytes[];
+} vbidata_lut8_t;
+
 extern void vbidata_update(vbidata_lut_t *lut, int render, int offset, int value);
 extern int vbidata_update_step(vbidata_lut_t *lut, double offset, double width, double rise, int level);
 extern vbidata_lut_t *vbidata_init(unsigned int nsymbols, unsigned int dwidth, int level, int filter, double bwidth, double beta, double offset);
 extern vbidata_lut_t *vbidata_init_step(unsigned int nsymbols, unsigned int dwidth, int level, double width, double rise, double offset);
 extern void vbidata_render(const vbidata_lut_t *lut, const uint8_t *src, int offset, int length, int order, vid_line_t *line);
+extern vbidata_lut8_t *vbidata_init8(const vbidata_lut_t *lut, int offset, int order);
+extern void vbidata_render8(const vbidata_lut8_t *lut, const uint8_t *src, int length, vid_line_t *line);
 
 #endif
 
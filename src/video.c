@@ -36,6 +36,9 @@
  * 
  * - 3x for RGB > gamma corrected Y, I and Q levels.
  * 
+ * - 3x small tables for planar YUV > Y, I and Q levels, summed
+ *   per pixel. Used for YUV sources when gamma is 1.0.
+ * 
  * - A temporary gamma table used while generating the above.
  * 
  * - PAL colour carrier (4 full frames in length + 1 line) or
@@ -2340,6 +2343,140 @@ static double _dlimit(double v, double min, double max)
 	return(v);
 }
 
+static void _rgb_levels(vid_t *s, double level, double r, double g, double b, double *py, double *pu, double *pv)
+{
+	double y, u, v, d;
+	
+	/* Calculate Y, Cb and Cr values */
+	y = r * s->conf.rw_co
+	  + g * s->conf.gw_co
+	  + b * s->conf.bw_co;
+	u = (b - y) * s->conf.eu_co;
+	v = (r - y) * s->conf.ev_co;
+	
+	/* Limit magnitude of D/D2-MAC chrominance to -0.5 >= 0.5 */
+	if(s->conf.type == VID_MAC)
+	{
+		d = fabs(u) > fabs(v) ? fabs(u) : fabs(v);
+		if(d > 0.5)
+		{
+			d = 0.5 / d;
+			u *= d;
+			v *= d;
+		}
+	}
+	
+	/* Adjust values to correct signal level */
+	y = (s->conf.black_level + (y * (s->conf.white_level - s->conf.black_level))) * level;
+	
+	if(s->conf.colour_mode != VID_SECAM)
+	{
+		u *= (s->conf.white_level - s->conf.black_level) * level;
+		v *= (s->conf.white_level - s->conf.black_level) * level;
+	}
+	else
+	{
+		u = (u + SECAM_CB_FREQ - SECAM_FM_FREQ) / SECAM_FM_DEV;
+		v = (v + SECAM_CR_FREQ - SECAM_FM_FREQ) / SECAM_FM_DEV;
+	}
+	
+	*py = y;
+	*pu = u;
+	*pv = v;
+}
+
+static void _yuv_plane_tables(vid_t *s, int matrix, int full_range)
+{
+	double level, kr, kb, kg;
+	double y0, u0, v0;
+	double y, u, v;
+	double r, g, b, c;
+	int i;
+	
+	level = s->conf.video_level * (s->conf.modulation == VID_FM ? 1.0 : s->conf.level);
+	
+	switch(matrix)
+	{
+	case AV_MATRIX_BT709:  kr = 0.2126; kb = 0.0722; break;
+	case AV_MATRIX_BT2020: kr = 0.2627; kb = 0.0593; break;
+	default:               kr = 0.299;  kb = 0.114;  break;
+	}
+	
+	kg = 1.0 - kr - kb;
+	
+	/* The conversion is linear when gamma is 1.0, so the Y, Cb and
+	 * Cr contributions can be looked up separately and summed. The
+	 * levels for black (R = G = B = 0) are included in the Y table */
+	_rgb_levels(s, level, 0, 0, 0, &y0, &u0, &v0);
+	
+	for(i = 0; i < 0x100; i++)
+	{
+		/* Y */
+		c = full_range ? i / 255.0 : (i - 16) / 219.0;
+		_rgb_levels(s, level, c, c, c, &y, &u, &v);
+		
+		s->yuv_plane_lookup[0][i].y = round(y * INT16_MAX);
+		s->yuv_plane_lookup[0][i].u = round(u * INT16_MAX);
+		s->yuv_plane_lookup[0][i].v = round(v * INT16_MAX);
+		
+		c = full_range ? (i - 128) / 255.0 : (i - 128) / 224.0;
+		
+		/* Cb */
+		r = 0;
+		b = 2 * (1 - kb) * c;
+		g = -kb * b / kg;
+		_rgb_levels(s, level, r, g, b, &y, &u, &v);
+		
+		s->yuv_plane_lookup[1][i].y = round((y - y0) * INT16_MAX);
+		s->yuv_plane_lookup[1][i].u = round((u - u0) * INT16_MAX);
+		s->yuv_plane_lookup[1][i].v = round((v - v0) * INT16_MAX);
+		
+		/* Cr */
+		r = 2 * (1 - kr) * c;
+		b = 0;
+		g = -kr * r / kg;
+		_rgb_levels(s, level, r, g, b, &y, &u, &v);
+		
+		s->yuv_plane_lookup[2][i].y = round((y - y0) * INT16_MAX);
+		s->yuv_plane_lookup[2][i].u = round((u - u0) * INT16_MAX);
+		s->yuv_plane_lookup[2][i].v = round((v - v0) * INT16_MAX);
+	}
+	
+	s->yuv_plane_matrix = matrix;
+	s->yuv_plane_full_range = full_range;
+}
+
+static inline int16_t _clip16(int32_t v)
+{
+	if(v < -INT16_MAX) return(-INT16_MAX);
+	if(v > INT16_MAX) return(INT16_MAX);
+	return(v);
+}
+
+static inline _yuv16_t _yuv_level(const vid_t *s, uint8_t y, uint8_t u, uint8_t v)
+{
+	const _yuv32_t *ty = &s->yuv_plane_lookup[0][y];
+	const _yuv32_t *tu = &s->yuv_plane_lookup[1][u];
+	const _yuv32_t *tv = &s->yuv_plane_lookup[2][v];
+	
+	return((_yuv16_t) {
+		_clip16(ty->y + tu->y + tv->y),
+		_clip16(ty->u + tu->u + tv->u),
+		_clip16(ty->v + tu->v + tv->v),
+	});
+}
+
+static void _yuv_rows(vid_t *s, int vy, const uint8_t **py, const uint8_t **pu, const uint8_t **pv)
+{
+	av_frame_t *f = &s->vframe;
+	int y = vy + f->plane_y;
+	int cy = y >> f->chroma_shift_y;
+	
+	*py = f->planes[0] + y * f->plane_stride[0];
+	*pu = f->planes[1] + cy * f->plane_stride[1];
+	*pv = f->planes[2] + cy * f->plane_stride[2];
+}
+
 static int16_t *_burstwin(unsigned int sample_rate, double width, double rise, double level, int *len)
 {
 	int16_t *win;
@@ -3444,6 +3581,9 @@ static int _vid_next_line_raster(vid_t *s, void *arg, int nlines, vid_line_t **l
 		uint32_t rgb = 0x000000;
 		uint32_t *prgb = &rgb;
 		int stride = 0;
+		const uint8_t *py, *pu, *pv;
+		int yuv = 0, fx = 0, sx = 0;
+		_yuv16_t c;
 		int16_t *o, *oc;
 		
 		/* Calculate active video portion of this line */
@@ -3455,7 +3595,15 @@ static int _vid_next_line_raster(vid_t *s, void *arg, int nlines, vid_line_t **l
 			*o = s->yuv_level_lookup[0x000000].y;
 		}
 		
-		if(s->vframe.framebuffer && vy >= 0)
+		if(s->vframe.format == AV_FRAME_YUV && vy >= 0)
+		{
+			/* Planar YUV source, read directly */
+			_yuv_rows(s, vy, &py, &pu, &pv);
+			fx = x - s->active_left - s->vframe_x + s->vframe.plane_x;
+			sx = s->vframe.chroma_shift_x;
+			yuv = 1;
+		}
+		else if(s->vframe.framebuffer && vy >= 0)
 		{
 			prgb  = &s->vframe.framebuffer[vy * s->vframe.line_stride];
 			prgb += (x - s->active_left - s->vframe_x) * s->vframe.pixel_stride;
@@ -3463,23 +3611,32 @@ static int _vid_next_line_raster(vid_t *s, void *arg, int nlines, vid_line_t **l
 		}
 		
 		oc = &s->chrominance_buffer[x * 2];
-		for(; x < s->active_left + s->vframe_x + s->vframe.width && x < ar; x++, o += 2, oc += 2, prgb += stride)
+		for(; x < s->active_left + s->vframe_x + s->vframe.width && x < ar; x++, o += 2, oc += 2, prgb += stride, fx++)
 		{
-			rgb = *prgb & 0xFFFFFF;
-			
-			if(s->conf.colour_mode == VID_APOLLO_FSC ||
-			   s->conf.colour_mode == VID_CBS_FSC)
+			if(yuv)
+			{
+				c = _yuv_level(s, py[fx], pu[fx >> sx], pv[fx >> sx]);
+			}
+			else
 			{
-				rgb  = (rgb >> (8 * fsc)) & 0xFF;
-				rgb |= (rgb << 8) | (rgb << 16);
+				rgb = *prgb & 0xFFFFFF;
+				
+				if(s->conf.colour_mode == VID_APOLLO_FSC ||
+				   s->conf.colour_mode == VID_CBS_FSC)
+				{
+					rgb  = (rgb >> (8 * fsc)) & 0xFF;
+					rgb |= (rgb << 8) | (rgb << 16);
+				}
+				
+				c = s->yuv_level_lookup[rgb];
 			}
 			
-			*o = s->yuv_level_lookup[rgb].y;
+			*o = c.y;
 			
 			if(pal)
 			{
-				oc[0] = s->yuv_level_lookup[rgb].u;
-				oc[1] = s->yuv_level_lookup[rgb].v;
+				oc[0] = c.u;
+				oc[1] = c.v;
 			}
 		}
 		
@@ -3620,8 +3777,19 @@ static int _vid_render_secam(vid_t *s, void *arg, int nlines, vid_line_t **lines
 		uint32_t rgb = 0x000000;
 		uint32_t *prgb = &rgb;
 		int stride = 0;
+		const uint8_t *py, *pu, *pv;
+		int yuv = 0, fx = 0, sx = 0;
+		_yuv16_t c;
 		
-		if(s->vframe.framebuffer && vy >= 0)
+		if(s->vframe.format == AV_FRAME_YUV && vy >= 0)
+		{
+			/* Planar YUV source, read directly */
+			_yuv_rows(s, vy, &py, &pu, &pv);
+			fx = s->vframe.plane_x;
+			sx = s->vframe.chroma_shift_x;
+			yuv = 1;
+		}
+		else if(s->vframe.framebuffer && vy >= 0)
 		{
 			prgb = &s->vframe.framebuffer[vy * s->vframe.line_stride];
 			stride = s->vframe.pixel_stride;
@@ -3636,14 +3804,15 @@ static int _vid_render_secam(vid_t *s, void *arg, int nlines, vid_line_t **lines
 				s->chrominance_buffer[x] = s->yuv_level_lookup[0x000000].v;
 			}
 			
-			for(; x < s->active_left + s->vframe_x + s->vframe.width; x++, prgb += stride)
+			for(; x < s->active_left + s->vframe_x + s->vframe.width; x++, prgb += stride, fx++)
 			{
+				c = yuv ? _yuv_level(s, py[fx], pu[fx >> sx], pv[fx >> sx]) : s->yuv_level_lookup[*prgb & 0xFFFFFF];
+				
 				s->chrominance_buffer[x] =
-					(s->yuv_level_lookup[*prgb & 0xFFFFFF].v +
-					 s->chrominance_buffer[s->width + x]) / 2;
+					(c.v + s->chrominance_buffer[s->width + x]) / 2;
 				
 				/* Store this lines D'b values to average with next line */
-				s->chrominance_buffer[s->width + x] = s->yuv_level_lookup[*prgb & 0xFFFFFF].u;
+				s->chrominance_buffer[s->width + x] = c.u;
 			}
 			
 			for(; x < s->width; x++)
@@ -3660,14 +3829,15 @@ static int _vid_render_secam(vid_t *s, void *arg, int nlines, vid_line_t **lines
 				s->chrominance_buffer[x] = s->yuv_level_lookup[0x000000].u;
 			}
 			
-			for(; x < s->active_left + s->vframe_x + s->vframe.width; x++, prgb += stride)
+			for(; x < s->active_left + s->vframe_x + s->vframe.width; x++, prgb += stride, fx++)
 			{
+				c = yuv ? _yuv_level(s, py[fx], pu[fx >> sx], pv[fx >> sx]) : s->yuv_level_lookup[*prgb & 0xFFFFFF];
+				
 				s->chrominance_buffer[x] =
-					(s->yuv_level_lookup[*prgb & 0xFFFFFF].u +
-					 s->chrominance_buffer[s->width + x]) / 2;
+					(c.u + s->chrominance_buffer[s->width + x]) / 2;
 				
 				/* Store this lines D'r values to average with next line */
-				s->chrominance_buffer[s->width + x] = s->yuv_level_lookup[*prgb & 0xFFFFFF].v;
+				s->chrominance_buffer[s->width + x] = c.v;
 			}
 			
 			for(; x < s->width; x++)
@@ -3746,6 +3916,10 @@ static int _vid_audio_process(vid_t *s, void *arg, int nlines, vid_line_t **line
 	int16_t *buf;
 	int x;
 	
+	/* The source may be closed by the main thread while
+	 * this runs, see vid_av_close() */
+	pthread_mutex_lock(&s->av_mutex);
+	
 	for(x = 0; x < l->width; x++)
 	{
 		int16_t add[2] = { 0, 0 };
@@ -3927,6 +4101,8 @@ static int _vid_audio_process(vid_t *s, void *arg, int nlines, vid_line_t **line
 	l->audio_len /= sizeof(int16_t);
 	if(l->audio_len == 0) l->audio = NULL;
 	
+	pthread_mutex_unlock(&s->av_mutex);
+	
 	return(1);
 }
 
@@ -4061,18 +4237,45 @@ static int _add_lineprocess(vid_t *s, const char *name, int nlines, int thread,
 	return(VID_OK);
 }
 
+static void _run_lineprocess(_lineprocess_t *p)
+{
+	int64_t t;
+	
+	if(p->process == NULL) return;
+	
+	if(p->vid->conf.benchmark == 0)
+	{
+		p->process(p->vid, p->arg, p->nlines, p->lines);
+		return;
+	}
+	
+	t = time_ns();
+	p->process(p->vid, p->arg, p->nlines, p->lines);
+	p->time += time_ns() - t;
+}
+
 static void *_lineprocess_thread(void *priv)
 {
 	_lineprocess_t *p = priv;
+	uint64_t round = 0;
 	int i;
 	
 	fprintf(stderr, "%s: Thread started\n", p->name);
 	
-	while(p->vid->thread_abort == 0)
+	while(1)
 	{
-		if(p->process) p->process(p->vid, p->arg, p->nlines, p->lines);
+		_run_lineprocess(p);
 		
 		pthread_barrier_wait(&p->vid->process_barrier);
+		round++;
+		
+		/* vid_free() sets the round of its final barrier wait. Testing
+		 * the round rather than a flag ensures every thread leaves
+		 * after the same barrier, or some could block forever */
+		if(p->vid->thread_exit_round > 0 && round >= p->vid->thread_exit_round)
+		{
+			break;
+		}
 		
 		for(i = 0; i < p->nlines; i++)
 		{
@@ -4080,19 +4283,6 @@ static void *_lineprocess_thread(void *priv)
 		}
 	}
 	
-	fprintf(stderr, "%s: Thread ending\n", p->name);
-	
-	/* Ensure all lineprocess theads exit at the same moment,
-	 * or some could block forever at pthread_barrier_wait() */
-	
-	p->vid->nthreads--;
-	
-	do
-	{
-		pthread_barrier_wait(&p->vid->process_barrier);
-	}
-	while(p->vid->nthreads > 0);
-	
 	fprintf(stderr, "%s: Thread ended\n", p->name);
 	
 	return(NULL);
@@ -4392,46 +4582,15 @@ int vid_init(vid_t *s, unsigned int sample_rate, unsigned int pixel_rate, const
 	/* Generate the RGB > signal level lookup tables */
 	for(c = 0x000000; c <= 0xFFFFFF; c++)
 	{
-		double r, g, b;
 		double y, u, v;
 		
-		/* Calculate RGB 0..1 values */
-		r = glut[(c & 0xFF0000) >> 16];
-		g = glut[(c & 0x00FF00) >> 8];
-		b = glut[(c & 0x0000FF) >> 0];
-		
-		/* Calculate Y, Cb and Cr values */
-		y = r * s->conf.rw_co
-		  + g * s->conf.gw_co
-		  + b * s->conf.bw_co;
-		u = (b - y) * s->conf.eu_co;
-		v = (r - y) * s->conf.ev_co;
-		
-		/* Limit magnitude of D/D2-MAC chrominance to -0.5 >= 0.5 */
-		if(s->conf.type == VID_MAC)
-		{
-			d = fabs(u) > fabs(v) ? fabs(u) : fabs(v);
-			if(d > 0.5)
-			{
-				d = 0.5 / d;
-				u *= d;
-				v *= d;
-			}
-		}
-		
-		/* Adjust values to correct signal level */
-		y = (s->conf.black_level + (y * (s->conf.white_level - s->conf.black_level))) * level;
-		
-		if(s->conf.colour_mode != VID_SECAM)
-		{
-			u *= (s->conf.white_level - s->conf.black_level) * level;
-			v *= (s->conf.white_level - s->conf.black_level) * level;
-		}
-		else
-		{
-			u = (u + SECAM_CB_FREQ - SECAM_FM_FREQ) / SECAM_FM_DEV;
-			v = (v + SECAM_CR_FREQ - SECAM_FM_FREQ) / SECAM_FM_DEV;
-		}
+		/* Calculate signal levels from the RGB 0..1 values */
+		_rgb_levels(s, level,
+			glut[(c & 0xFF0000) >> 16],
+			glut[(c & 0x00FF00) >> 8],
+			glut[(c & 0x0000FF) >> 0],
+			&y, &u, &v
+		);
 		
 		/* Convert to INT16 range and store in tables */
 		s->yuv_level_lookup[c].y = round(_dlimit(y, -1, 1) * INT16_MAX);
@@ -4439,6 +4598,10 @@ int vid_init(vid_t *s, unsigned int sample_rate, unsigned int pixel_rate, const
 		s->yuv_level_lookup[c].v = round(_dlimit(v, -1, 1) * INT16_MAX);
 	}
 	
+	/* Generate the planar YUV lookup tables. These are
+	 * regenerated if a source uses a different matrix */
+	_yuv_plane_tables(s, AV_MATRIX_BT601, 0);
+	
 	if(s->conf.colour_mode == VID_PAL ||
 	   s->conf.colour_mode == VID_NTSC)
 	{
@@ -4871,6 +5034,7 @@ int vid_init(vid_t *s, unsigned int sample_rate, unsigned int pixel_rate, const
 	}
 	
 	/* Prepare audio FIFO (1 second at 32khz) */
+	pthread_mutex_init(&s->av_mutex, NULL);
 	fifo_init(&s->audiofifo, 100, 320 * sizeof(int16_t) * 2);
 	fifo_reader_init(&s->audio_reader, &s->audiofifo, 0);
 	
@@ -5239,15 +5403,13 @@ void vid_free(vid_t *s)
 {
 	int i;
 	
-	/* Close the AV source */
-	av_close(&s->av);
-	
 	/* Wait for threads to end */
 	if(s->thread_abort == 0)
 	{
 		s->thread_abort = 1;
+		s->thread_exit_round = s->thread_round + 1;
 		
-		while(s->nthreads > 0)
+		if(s->nthreads > 0)
 		{
 			pthread_barrier_wait(&s->process_barrier);
 		}
@@ -5272,6 +5434,9 @@ void vid_free(vid_t *s)
 		pthread_barrier_destroy(&s->process_barrier);
 	}
 	
+	/* Close the AV source */
+	av_close(&s->av);
+	
 	if(s->conf.passthru)
 	{
 		fclose(s->passthru);
@@ -5340,6 +5505,7 @@ void vid_free(vid_t *s)
 	
 	fifo_reader_close(&s->audio_reader);
 	fifo_free(&s->audiofifo);
+	pthread_mutex_destroy(&s->av_mutex);
 	
 	/* Free allocated memory */
 	free(s->yuv_level_lookup);
@@ -5380,6 +5546,78 @@ void vid_free(vid_t *s)
 	memset(s, 0, sizeof(vid_t));
 }
 
+void vid_av_close(vid_t *s)
+{
+	/* The audio process may still be reading from the
+	 * source, wait for it to finish the current line */
+	pthread_mutex_lock(&s->av_mutex);
+	
+	av_close(&s->av);
+	
+	/* Drop any samples left over from the old source */
+	s->audiobuffer = NULL;
+	s->audiobuffer_samples = 0;
+	
+	pthread_mutex_unlock(&s->av_mutex);
+}
+
+void vid_av_switch(vid_t *s, av_t *next)
+{
+	av_t old;
+	
+	pthread_mutex_lock(&s->av_mutex);
+	
+	/* Take the source from next, keeping our own settings */
+	old = s->av;
+	s->av.av_source_ctx = next->av_source_ctx;
+	s->av.read_video = next->read_video;
+	s->av.read_audio = next->read_audio;
+	s->av.close = next->close;
+	
+	next->av_source_ctx = NULL;
+	next->read_video = NULL;
+	next->read_audio = NULL;
+	next->close = NULL;
+	
+	/* Drop any samples left over from the old source */
+	s->audiobuffer = NULL;
+	s->audiobuffer_samples = 0;
+	
+	pthread_mutex_unlock(&s->av_mutex);
+	
+	/* The old source is closed outside the lock, so the
+	 * audio process can start on the new one straight away */
+	av_close(&old);
+}
+
+void vid_print_stats(vid_t *s)
+{
+	/* 10ms audio blocks */
+	fifo_print_stats("audio", &s->audiofifo);
+	fifo_reader_print_stats("audio", &s->audio_reader, 0.010);
+}
+
+int vid_allow_yuv(vid_t *s)
+{
+	/* Planar YUV frames can be rendered directly when the
+	 * conversion to signal levels is linear, and the frame
+	 * doesn't need to be rotated or flipped */
+	if(s->conf.type == VID_MAC) return(0);
+	if(s->conf.gamma != 1.0) return(0);
+	if(s->conf.frame_orientation != 0) return(0);
+	
+	switch(s->conf.colour_mode)
+	{
+	case VID_MONOCHROME:
+	case VID_PAL:
+	case VID_NTSC:
+	case VID_SECAM:
+		return(1);
+	}
+	
+	return(0);
+}
+
 void vid_info(vid_t *s)
 {
 	fprintf(stderr, "Video: %dx%d %.2f fps (full frame %dx%d)\n",
@@ -5401,6 +5639,53 @@ size_t vid_get_framebuffer_length(vid_t *s)
 	return(sizeof(uint32_t) * s->active_width * s->conf.active_lines);
 }
 
+void vid_swap_lines(vid_line_t *a, vid_line_t *b, int x)
+{
+	int16_t *t;
+	int16_t v;
+	
+	/* Exchange the line buffers. Every buffer in the ring is max_width
+	 * samples long so ownership can move freely between lines */
+	t = a->output;
+	a->output = b->output;
+	b->output = t;
+	
+	/* Swap back the samples before x, leaving the sync and
+	 * colour burst of each line in place */
+	for(x = x * 2 - 1; x >= 0; x--)
+	{
+		v = a->output[x];
+		a->output[x] = b->output[x];
+		b->output[x] = v;
+	}
+}
+
+void vid_rotate_line(int16_t *dst, const int16_t *src, int x, int x2, int y, int y2, int y3)
+{
+	const int16_t *s;
+	int16_t *d;
+	int i, n;
+	
+	/* Copy in spans between wrap points rather than testing
+	 * for the wrap on every sample, so the loop vectorises */
+	while(x < x2)
+	{
+		n = x2 - x;
+		if(y2 - y < n) n = y2 - y;
+		
+		d = dst + x * 2;
+		s = src + y * 2;
+		
+		for(i = 0; i < n; i++)
+		{
+			d[i * 2] = s[i * 2];
+		}
+		
+		x += n;
+		y = y3;
+	}
+}
+
 static vid_line_t *_vid_next_line(vid_t *s)
 {
 	vid_line_t *l = s->output_process->lines[0];
@@ -5409,6 +5694,8 @@ static vid_line_t *_vid_next_line(vid_t *s)
 	/* Load the next frame */
 	if(s->bline == 1 || (s->conf.interlace && s->bline == s->conf.hline))
 	{
+		int64_t t = s->conf.benchmark ? time_ns() : 0;
+		
 		/* Have we reached the end of the video? */
 		if(av_eof(&s->av))
 		{
@@ -5429,6 +5716,14 @@ static vid_line_t *_vid_next_line(vid_t *s)
 			s->conf.active_lines
 		);
 		
+		/* Match the YUV tables to the source colour matrix */
+		if(s->vframe.format == AV_FRAME_YUV &&
+		  (s->vframe.colour_matrix != s->yuv_plane_matrix ||
+		   s->vframe.full_range != s->yuv_plane_full_range))
+		{
+			_yuv_plane_tables(s, s->vframe.colour_matrix, s->vframe.full_range);
+		}
+		
 		/* Calculate frame offset from top left */
 		s->vframe_x = (s->active_width - s->vframe.width) / 2;
 		s->vframe_y = (s->conf.active_lines - s->vframe.height) / 2;
@@ -5438,6 +5733,11 @@ static vid_line_t *_vid_next_line(vid_t *s)
 		{
 			cc608_fifo_write(&s->cc608.ccfifo, s->vframe.cc608, 2);
 		}
+		
+		if(s->conf.benchmark)
+		{
+			s->vframe_time += time_ns() - t;
+		}
 	}
 	
 	for(i = 0; i < s->nprocesses; i++)
@@ -5446,10 +5746,7 @@ static vid_line_t *_vid_next_line(vid_t *s)
 		
 		if(p->thread == 0)
 		{
-			if(p->process)
-			{
-				p->process(p->vid, p->arg, p->nlines, p->lines);
-			}
+			_run_lineprocess(p);
 			
 			for(j = 0; j < p->nlines; j++)
 			{
@@ -5459,6 +5756,7 @@ static vid_line_t *_vid_next_line(vid_t *s)
 	}
 	
 	pthread_barrier_wait(&s->process_barrier);
+	s->thread_round++;
 	
 	/* Advance the next line/frame counter */
 	if(s->bline++ == s->conf.lines)
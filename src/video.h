@@ -321,6 +321,9 @@ typedef struct {
 	/* Video filter enable flag */
 	int vfilter;
 	
+	/* Record the time spent in each line process */
+	int benchmark;
+	
 } vid_config_t;
 
 typedef struct {
@@ -335,6 +338,12 @@ typedef struct {
 	int16_t v;
 } _yuv16_t;
 
+typedef struct {
+	int32_t y;
+	int32_t u;
+	int32_t v;
+} _yuv32_t;
+
 struct vid_line_t {
 	
 	/* The output line buffer */
@@ -385,6 +394,9 @@ struct _lineprocess_t {
 	/* Thread handle */
 	int thread; /* 0 = Main thread, 1 = Separate thread */
 	pthread_t pthread;
+	
+	/* Time spent in the process callback (ns), if benchmarking */
+	int64_t time;
 };
 
 struct vid_t {
@@ -412,6 +424,12 @@ struct vid_t {
 	
 	_yuv16_t *yuv_level_lookup;
 	
+	/* Planar YUV > signal level lookup tables, one for each
+	 * input plane. The three results are summed per pixel */
+	_yuv32_t yuv_plane_lookup[3][0x100];
+	int yuv_plane_matrix;
+	int yuv_plane_full_range;
+	
 	unsigned int colour_lookup_width;
 	unsigned int colour_lookup_offset;
 	cint16_t *colour_lookup;
@@ -442,6 +460,9 @@ struct vid_t {
 	int vframe_x;
 	int vframe_y;
 	
+	/* Time spent reading frames from the source (ns), if benchmarking */
+	int64_t vframe_time;
+	
 	/* The frame and line number being rendered next */
 	int bframe;
 	int bline;
@@ -487,6 +508,7 @@ struct vid_t {
 	/* Audio state */
 	fifo_t audiofifo;
 	fifo_reader_t audio_reader;
+	pthread_mutex_t av_mutex;
 	int16_t *audiobuffer;
 	size_t audiobuffer_samples;
 	int interp;
@@ -539,6 +561,8 @@ struct vid_t {
 	int nprocesses;
 	int nthreads;
 	int thread_abort;
+	uint64_t thread_round;
+	uint64_t thread_exit_round;
 	_lineprocess_t *processes;
 	_lineprocess_t *output_process;
 	pthread_barrier_t process_barrier;
@@ -548,8 +572,24 @@ extern const vid_configs_t vid_configs[];
 
 extern int vid_init(vid_t *s, unsigned int sample_rate, unsigned int pixel_rate, const vid_config_t * const conf);
 extern void vid_free(vid_t *s);
+extern void vid_av_close(vid_t *s);
+extern void vid_av_switch(vid_t *s, av_t *next);
+extern void vid_print_stats(vid_t *s);
 extern void vid_info(vid_t *s);
+extern int vid_allow_yuv(vid_t *s);
 extern size_t vid_get_framebuffer_length(vid_t *s);
+
+/* Swap the contents of two lines from sample x onwards. The buffers
+ * themselves are exchanged, so only the first x samples are copied.
+ * Only valid between lines within the same line process window */
+extern void vid_swap_lines(vid_line_t *a, vid_line_t *b, int x);
+
+/* Cut and rotate. Copies samples x to x2 - 1 of dst from src, starting
+ * at sample y. When the source reaches sample y2 it continues from
+ * sample y3, which must be less than y2. Only the first sample of each
+ * pair is copied */
+extern void vid_rotate_line(int16_t *dst, const int16_t *src, int x, int x2, int y, int y2, int y3);
+
 extern vid_line_t *vid_next_line(vid_t *s);
 
 #endif
@@ -64,6 +64,7 @@ typedef struct {
     uint64_t answer;
     int has_hash;             /* Only used for Sky10 */
     int has_answer;           /* Only used for Sky10 */
+    struct card10_t *card10;  /* Only used for Sky10 */
 } message_data_t;
 
 typedef struct {
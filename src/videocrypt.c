@@ -45,6 +45,7 @@
 #include "video.h"
 #include "vbidata.h"
 #include "videocrypt-ca.h"
+#include "videocrypt10-ca.h"
 #include "videocrypt-data.h"
 
 /*
@@ -496,6 +497,7 @@ void vc_free(vc_t *s)
 			{
 				if(s->blocks[i].message_data)
 				{
+					vc_free_sky_p10(s->blocks[i].message_data);
 					free(s->blocks[i].message_data);
 					s->blocks[i].message_data = NULL;
 				}
@@ -509,6 +511,7 @@ void vc_free(vc_t *s)
 			{
 				if(s->blocks2[i].message_data)
 				{
+					vc_free_sky_p10(s->blocks2[i].message_data);
 					free(s->blocks2[i].message_data);
 					s->blocks2[i].message_data = NULL;
 				}
@@ -808,22 +811,21 @@ int vc_render_line(vid_t *s, void *arg, int nlines, vid_line_t **lines)
 		int cut;
 		int lshift;
 		int y;
-		int16_t *delay = lines[1]->output;
 		
 		cut = 105 + (0xFF - x) * 2;
 		lshift = 710 - cut;
 		
+		/* The segment after the cut point is moved to the start of
+		 * the line, followed by the segment before it */
 		y = v->video_scale[VC_LEFT + lshift];
-		for(x = v->video_scale[VC_LEFT]; x < v->video_scale[VC_LEFT + cut]; x++, y++)
-		{
-			l->output[x * 2] = delay[y * 2];
-		}
 		
-		y = v->video_scale[VC_LEFT];
-		for(; x < v->video_scale[VC_RIGHT + VC_OVERLAP]; x++, y++)
-		{
-			l->output[x * 2] = delay[y * 2];
-		}
+		vid_rotate_line(
+			l->output, lines[1]->output,
+			v->video_scale[VC_LEFT],
+			v->video_scale[VC_RIGHT + VC_OVERLAP],
+			y, y + v->video_scale[VC_LEFT + cut] - v->video_scale[VC_LEFT],
+			v->video_scale[VC_LEFT]
+		);
 	}
 	
 	return(1);
@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include "videocrypt10-asic.h"
 
 /* Tap selectors for bits 64-79 */
@@ -81,164 +82,216 @@ static const int linear_taps[8][2] =
     {5, 2}, {9, 8}, {17, 10}, {29, 18}, {38, 33}, {46, 44}, {53, 49}, {62, 57}
 };
 
-static void byte_to_bools(uint8_t byte, bool *bools) 
+/* The selected and permuted bits are handled as 64-bit words, with
+ * sel[b][i] and s[b][i] at bit b * 4 + i. Each selection is a fixed
+ * gather of bits, done a byte at a time with these tables */
+static uint64_t _sel_gather[2][8][256];
+static uint64_t _s_gather[2][8][256];
+static uint64_t _nibble_mask[256];
+static uint64_t _linear_mask[256];
+static pthread_once_t _tables_once = PTHREAD_ONCE_INIT;
+
+static void _init_tables(void) 
 {
-    for (int i = 0; i < 8; i++) 
+    for (int v = 0; v < 256; v++) 
     {
-        bools[i] = (byte >> i) & 1;
+        for (int k = 0; k < 2; k++) 
+        {
+            for (int b = 0; b < 16; b++) 
+            {
+                for (int i = 0; i < 4; i++) 
+                {
+                    int t = tap_selectors[b][k][i];
+                    int n = (p_boxes[b][k][i].bit - 64) * 4 + p_boxes[b][k][i].idx;
+                    
+                    if ((v >> (t & 7)) & 1) _sel_gather[k][t >> 3][v] |= 1ULL << (b * 4 + i);
+                    if ((v >> (n & 7)) & 1) _s_gather[k][n >> 3][v] |= 1ULL << (b * 4 + i);
+                }
+            }
+        }
+        
+        for (int b = 0; b < 8; b++) 
+        {
+            /* Expand each bit of v into a nibble */
+            if ((v >> b) & 1) _nibble_mask[v] |= 0xFULL << (b * 4);
+            
+            /* Linear taps selected by bits 96-103 */
+            _linear_mask[v] |= 1ULL << linear_taps[b][(v >> b) & 1];
+        }
     }
 }
 
-static uint8_t bools_to_byte(const bool *bools) 
+static inline uint64_t _gather(const uint64_t table[8][256], uint64_t x) 
 {
-    uint8_t value = 0;
-    for (int i = 0; i < 8; i++) 
+    uint64_t r = 0;
+    for (int j = 0; j < 8; j++) 
     {
-        if (bools[i]) value |= (1 << i);
+        r |= table[j][(x >> (j * 8)) & 0xFF];
     }
-    return value;
+    return r;
 }
 
-static bool feedback_function(const bool *input) 
+/* Expand the 16 bits of x into a mask of 16 nibbles */
+static inline uint64_t _expand16(uint64_t x) 
 {
-    /* Get bits from 0-63 based on mask in 64-79 */
-    bool sel[16][4];
-    for (int b = 0; b < 16; b++) 
-    {
-        int bit_idx = b + 64;
-        int selector = input[bit_idx] ? 1 : 0;
-        for (int i = 0; i < 4; i++) 
-        {
-            sel[b][i] = input[tap_selectors[b][selector][i]];
-        }
-    }
-
-    /* Permute selected bits based on mask in 80-95 */
-    bool s[16][4];
-    for (int bit = 0; bit < 16; bit++) 
-    {
-        int bit_idx = bit + 80;
-        int selector = input[bit_idx] ? 0 : 1;  /* Inverted! */
-        for (int i = 0; i < 4; i++) 
-        {
-            pbox_t entry = p_boxes[bit][selector][i];
-            s[bit][i] = !sel[entry.bit - 64][entry.idx];
-        }
-    }
-
-    /* Special cases */
-    s[2][2]   = (input[82]   || !sel[1][0])  && (input[90]   || !sel[1][3]);
-    s[10][1]  = (!input[82]  || !sel[8][1])  && (!input[90]  || !sel[5][1]);
-
-    s[0][3]   = (input[84]   && !sel[5][2])  || (!input[80]  && !sel[5][0]);
-    s[4][0]   = (input[80]   && !sel[11][1]) || (!input[84]  && !sel[15][1]);
-
-    s[1][0]   = (!input[81]  || !sel[15][3]) && (input[94]   || !sel[7][2]);
-    s[14][3]  = (input[81]   || !sel[7][0])  && (!input[94]  || !sel[10][3]);
-
-    s[3][2]   = (!input[83]  || !sel[14][2]) && (!input[85]  || !sel[0][2]);
-    s[5][0]   = (input[83]   || !sel[2][2])  && (input[85]   || !sel[11][0]);
-
-    s[8][0]   = (!input[88]  || !sel[13][3]) && (input[85]   || !sel[9][1]);
-    s[5][2]   = (!input[85]  || !sel[11][0]) && (input[88]   || !sel[15][2]);
-
-    s[8][1]   = (!input[88]  || !sel[14][0]) && (input[92]   || !sel[1][1]);
-    s[12][0]  = (!input[92]  || !sel[5][3])  && (input[88]   || !sel[13][3]);
-
-    s[11][3]  = (input[91]   && !sel[9][3])  || (input[94]   && !sel[15][0]);
-    s[14][2]  = (!input[91]  && !sel[7][1])  || (!input[94]  && !sel[6][0]);
-
-    s[11][0]  = (input[94]   || !sel[10][3]) && (input[91]   || !sel[3][0]);
-    s[14][0]  = (!input[91]  || !sel[8][0])  && (!input[94]  || !sel[6][0]);
-
-    s[15][0]  = !s[15][0];
-
-    /* Complex logic */
-    bool a     = ((s[13][1] || s[9][3])  == (s[3][0]  && s[10][2]));
-    bool b     = (s[5][3]   || s[7][3])  && (s[4][2]  == s[13][0]);
-    bool i1    = a || b;
-
-    bool r1    = (s[15][0]  != s[11][1]) || (s[10][1] && s[2][2]);
-    bool r2_1  = (s[0][3]   || s[4][0])  != (s[1][0]  && s[14][3]);
-    bool r2    = r2_1 || !r1;
-
-    bool r5    = (s[1][3]   == s[6][2])  || (s[3][2]  && s[5][0]);
-    bool r5_1  = (s[2][1]   || s[9][0])  == (s[6][3]  && s[12][3]);
-    bool r6    = r5 && r5_1;
+    return _nibble_mask[x & 0xFF] | (_nibble_mask[(x >> 8) & 0xFF] << 32);
+}
 
-    bool r9    = (s[7][0]   == s[10][0]) || (s[8][1]  && s[12][0]);
-    bool r12_1 = (s[11][3]  || s[14][2]) != (s[12][2] && s[13][2]);
-    bool r12   = r12_1 || !r9;
+/* Read bit n (64-104) of the upper shift register word */
+#define HI(n) ((bool)((hi >> ((n) - 64)) & 1))
 
-    bool r10   = (s[1][2]   == s[9][2])  && (s[14][1] || s[15][2]);
-    bool r11   = (s[0][1]   || s[10][3]) == (s[3][1]  && s[15][1]);
-    bool c     = !r10 && !r11;
+/* Read sel[b][i] and s[b][i] from their words */
+#define SEL(b, i) ((bool)((selw >> ((b) * 4 + (i))) & 1))
+#define S(b, i) ((bool)((sw >> ((b) * 4 + (i))) & 1))
 
-    bool r7    = ((s[7][2]  == s[9][1])  || (s[8][0]  && s[5][2]))  ^ (s[8][2]  != s[12][1] || !(s[2][0]  || s[1][1]));
-    bool r8    = ((s[7][1]  == s[13][3]) || (s[11][2] && s[8][3]))  ^ (s[3][3]  != s[6][0]  || !(s[5][1]  || s[4][1]));
-    bool r13   = ((s[2][3]  == s[0][0])  || (s[14][0] && s[11][0])) ^ (s[4][3]  != s[0][2]  || !(s[6][1]  || s[15][3]));
+/* Replace s[b][i] */
+#define SET_S(b, i, v) (sw = (sw & ~(1ULL << ((b) * 4 + (i)))) | ((uint64_t)(v) << ((b) * 4 + (i))))
 
-    bool i2    = (r2 != i1) && (r6 || r7);
-    a          = (c || !r13) == (r8 || !r12);
+static bool feedback_function(uint64_t lo, uint64_t hi) 
+{
+    uint64_t m;
+    
+    /* Get bits from 0-63 based on mask in 64-79 */
+    m = _expand16(hi);
+    uint64_t selw = (_gather(_sel_gather[0], lo) & ~m) | (_gather(_sel_gather[1], lo) & m);
 
-    bool p     = a && !i2;
+    /* Permute selected bits based on mask in 80-95. The mask is inverted! */
+    m = _expand16(~hi >> 16);
+    uint64_t sw = ~((_gather(_s_gather[0], selw) & ~m) | (_gather(_s_gather[1], selw) & m));
 
-    /* Handle bits 96-103 */
-    int xor_count = 0;
-    for (int bit = 96; bit < 104; bit++) 
-    {
-        int tap_idx = input[bit] ? 1 : 0;
-        if (input[linear_taps[bit - 96][tap_idx]]) 
-        {
-            xor_count++;
-        }
-    }
-    bool xors = (xor_count & 1) == 1;
-    xors ^= input[104];
+    /* Special cases */
+    bool s2_2   = (HI(82)   | !SEL(1, 0))  & (HI(90)   | !SEL(1, 3));
+    bool s10_1  = (!HI(82)  | !SEL(8, 1))  & (!HI(90)  | !SEL(5, 1));
+
+    bool s0_3   = (HI(84)   & !SEL(5, 2))  | (!HI(80)  & !SEL(5, 0));
+    bool s4_0   = (HI(80)   & !SEL(11, 1)) | (!HI(84)  & !SEL(15, 1));
+
+    bool s1_0   = (!HI(81)  | !SEL(15, 3)) & (HI(94)   | !SEL(7, 2));
+    bool s14_3  = (HI(81)   | !SEL(7, 0))  & (!HI(94)  | !SEL(10, 3));
+
+    bool s3_2   = (!HI(83)  | !SEL(14, 2)) & (!HI(85)  | !SEL(0, 2));
+    bool s5_0   = (HI(83)   | !SEL(2, 2))  & (HI(85)   | !SEL(11, 0));
+
+    bool s8_0   = (!HI(88)  | !SEL(13, 3)) & (HI(85)   | !SEL(9, 1));
+    bool s5_2   = (!HI(85)  | !SEL(11, 0)) & (HI(88)   | !SEL(15, 2));
+
+    bool s8_1   = (!HI(88)  | !SEL(14, 0)) & (HI(92)   | !SEL(1, 1));
+    bool s12_0  = (!HI(92)  | !SEL(5, 3))  & (HI(88)   | !SEL(13, 3));
+
+    bool s11_3  = (HI(91)   & !SEL(9, 3))  | (HI(94)   & !SEL(15, 0));
+    bool s14_2  = (!HI(91)  & !SEL(7, 1))  | (!HI(94)  & !SEL(6, 0));
+
+    bool s11_0  = (HI(94)   | !SEL(10, 3)) & (HI(91)   | !SEL(3, 0));
+    bool s14_0  = (!HI(91)  | !SEL(8, 0))  & (!HI(94)  | !SEL(6, 0));
+
+    SET_S(2, 2, s2_2);
+    SET_S(10, 1, s10_1);
+    SET_S(0, 3, s0_3);
+    SET_S(4, 0, s4_0);
+    SET_S(1, 0, s1_0);
+    SET_S(14, 3, s14_3);
+    SET_S(3, 2, s3_2);
+    SET_S(5, 0, s5_0);
+    SET_S(8, 0, s8_0);
+    SET_S(5, 2, s5_2);
+    SET_S(8, 1, s8_1);
+    SET_S(12, 0, s12_0);
+    SET_S(11, 3, s11_3);
+    SET_S(14, 2, s14_2);
+    SET_S(11, 0, s11_0);
+    SET_S(14, 0, s14_0);
+
+    sw ^= 1ULL << (15 * 4 + 0);
+
+    /* Complex logic. Bitwise operators keep this free of branches */
+    bool a     = ((S(13, 1) | S(9, 3))  == (S(3, 0)  & S(10, 2)));
+    bool b     = (S(5, 3)   | S(7, 3))  & (S(4, 2)  == S(13, 0));
+    bool i1    = a | b;
+
+    bool r1    = (S(15, 0)  != S(11, 1)) | (S(10, 1) & S(2, 2));
+    bool r2_1  = (S(0, 3)   | S(4, 0))  != (S(1, 0)  & S(14, 3));
+    bool r2    = r2_1 | !r1;
+
+    bool r5    = (S(1, 3)   == S(6, 2))  | (S(3, 2)  & S(5, 0));
+    bool r5_1  = (S(2, 1)   | S(9, 0))  == (S(6, 3)  & S(12, 3));
+    bool r6    = r5 & r5_1;
+
+    bool r9    = (S(7, 0)   == S(10, 0)) | (S(8, 1)  & S(12, 0));
+    bool r12_1 = (S(11, 3)  | S(14, 2)) != (S(12, 2) & S(13, 2));
+    bool r12   = r12_1 | !r9;
+
+    bool r10   = (S(1, 2)   == S(9, 2))  & (S(14, 1) | S(15, 2));
+    bool r11   = (S(0, 1)   | S(10, 3)) == (S(3, 1)  & S(15, 1));
+    bool c     = !r10 & !r11;
+
+    bool r7    = ((S(7, 2)  == S(9, 1))  | (S(8, 0)  & S(5, 2)))  ^ ((S(8, 2)  != S(12, 1)) | !(S(2, 0)  | S(1, 1)));
+    bool r8    = ((S(7, 1)  == S(13, 3)) | (S(11, 2) & S(8, 3)))  ^ ((S(3, 3)  != S(6, 0)) | !(S(5, 1)  | S(4, 1)));
+    bool r13   = ((S(2, 3)  == S(0, 0))  | (S(14, 0) & S(11, 0))) ^ ((S(4, 3)  != S(0, 2)) | !(S(6, 1)  | S(15, 3)));
+
+    bool i2    = (r2 != i1) & (r6 | r7);
+    a          = (c | !r13) == (r8 | !r12);
+
+    bool p     = a & !i2;
+
+    /* Handle bits 96-103. Take the parity of the taps they select */
+    uint64_t x = lo & _linear_mask[(hi >> 32) & 0xFF];
+    x ^= x >> 32;
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    
+    bool xors = x & 1;
+    xors ^= HI(104);
 
     return p ^ xors;
 }
 
-static void asic_shift(asic10_t *asic) 
-{
-    bool new_bit = feedback_function(asic->shift_register);
-    memmove(&asic->shift_register[1], &asic->shift_register[0], 104 * sizeof(bool));
-    asic->shift_register[0] = new_bit;
-}
-
 void asic_iterate(asic10_t *asic, int rounds) 
 {
     if (rounds == -1) 
     {
         rounds = asic->iterations;
     }
+    
+    /* Keep the register in locals for the run. Each clock shifts
+     * bits 0-103 up by one, dropping bit 104, and feeds back into bit 0 */
+    uint64_t lo = asic->shift_register[0];
+    uint64_t hi = asic->shift_register[1];
+    
     for (int i = 0; i < rounds; i++) 
     {
-        asic_shift(asic);
+        uint64_t new_bit = feedback_function(lo, hi);
+        hi = ((hi << 1) | (lo >> 63)) & ((1ULL << 41) - 1);
+        lo = (lo << 1) | new_bit;
     }
+    
+    asic->shift_register[0] = lo;
+    asic->shift_register[1] = hi;
 }
 
 static uint8_t asic_read_next(asic10_t *asic) 
 {
-    uint8_t value = bools_to_byte(&asic->shift_register[asic->read_pointer * 8]);
+    uint8_t value = asic->shift_register[0] >> (asic->read_pointer * 8);
     asic->read_pointer = (asic->read_pointer + 1) % 8;
     return value;
 }
 
+/* Load a byte into bits n to n + 7 of the upper shift register word */
+static void asic_load_byte(asic10_t *asic, int n, uint8_t byte) 
+{
+    asic->shift_register[1] &= ~(0xFFULL << (n - 64));
+    asic->shift_register[1] |= (uint64_t)byte << (n - 64);
+}
+
 static void asic_push_onto_fifo_queue(asic10_t *asic, uint8_t byte) 
 {
-    bool value[8];
-    byte_to_bools(byte, value);
-    
-    memmove(&asic->fifo_buffer[8], &asic->fifo_buffer[0], 56 * sizeof(bool));
-    memcpy(&asic->fifo_buffer[0], value, 8 * sizeof(bool));
+    asic->fifo_buffer = (asic->fifo_buffer << 8) | byte;
 
     if (asic->crypto_enabled) 
     {
-        for (int i = 0; i < 64; i++) 
-        {
-            asic->shift_register[i] ^= asic->fifo_buffer[i];
-        }
+        asic->shift_register[0] ^= asic->fifo_buffer;
         asic_iterate(asic, -1);
     }
 }
@@ -271,8 +324,8 @@ void asic_send(asic10_t *asic, const uint8_t *data, int len)
                 asic->decoder_capture = (data[pos + 1] & 0b00000100) >> 2;
                 if ((data[pos + 1] & 0b00000001) == 1) 
                 {
-                    asic->shift_register[104] = false;
-                    memset(asic->shift_register, 0, 64 * sizeof(bool));
+                    asic->shift_register[1] &= ~(1ULL << (104 - 64));
+                    asic->shift_register[0] = 0;
                     asic->read_pointer = 0;
                 }
                 break;
@@ -292,7 +345,7 @@ void asic_send(asic10_t *asic, const uint8_t *data, int len)
                     fprintf(stderr, "Missing data for command 0x%02x\n", cmd);
                     return;
                 }
-                byte_to_bools(data[pos + 1], &asic->shift_register[96]);
+                asic_load_byte(asic, 96, data[pos + 1]);
                 break;
             case 0x61:
                 if (pos + 1 >= len) 
@@ -300,7 +353,7 @@ void asic_send(asic10_t *asic, const uint8_t *data, int len)
                     fprintf(stderr, "Missing data for command 0x%02x\n", cmd);
                     return;
                 }
-                byte_to_bools(data[pos + 1], &asic->shift_register[64]);
+                asic_load_byte(asic, 64, data[pos + 1]);
                 break;
             case 0x71:
                 if (pos + 1 >= len) 
@@ -308,7 +361,7 @@ void asic_send(asic10_t *asic, const uint8_t *data, int len)
                     fprintf(stderr, "Missing data for command 0x%02x\n", cmd);
                     return;
                 }
-                byte_to_bools(data[pos + 1], &asic->shift_register[72]);
+                asic_load_byte(asic, 72, data[pos + 1]);
                 break;
             case 0x81:
                 if (pos + 1 >= len) 
@@ -316,7 +369,7 @@ void asic_send(asic10_t *asic, const uint8_t *data, int len)
                     fprintf(stderr, "Missing data for command 0x%02x\n", cmd);
                     return;
                 }
-                byte_to_bools(data[pos + 1], &asic->shift_register[80]);
+                asic_load_byte(asic, 80, data[pos + 1]);
                 break;
             case 0x91:
                 if (pos + 1 >= len) 
@@ -324,7 +377,7 @@ void asic_send(asic10_t *asic, const uint8_t *data, int len)
                     fprintf(stderr, "Missing data for command 0x%02x\n", cmd);
                     return;
                 }
-                byte_to_bools(data[pos + 1], &asic->shift_register[88]);
+                asic_load_byte(asic, 88, data[pos + 1]);
                 break;
                 
             case 0x13:
@@ -371,11 +424,10 @@ uint8_t asic_receive_one(asic10_t *asic)
 
 void asic_reset(asic10_t *asic) 
 {
+    pthread_once(&_tables_once, _init_tables);
+    
     memset(asic->shift_register, 0, sizeof(asic->shift_register));
-    for (int i = 0; i < 64; i++) 
-    {
-        asic->fifo_buffer[i] = true;
-    }
+    asic->fifo_buffer = ~0ULL;
     asic->iterations = 1025;
     asic->crypto_enabled = false;
     asic->decoder_capture = false;
@@ -29,58 +29,171 @@
 #include <string.h>
 #include <stdio.h>
 #include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+static inline uint32_t _rd32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void _unmap_rainbow_table(const uint8_t *table, size_t size)
+{
+#ifndef _WIN32
+    munmap((void *)table, size);
+#else
+    free((void *)table);
+#endif
+}
 
 static int card_load_rainbow_table(card10_t *card, const char *filename)
 {
     if (!card) return 0;
     
-    printf("Loading 64MB rainbow table from %s...\n", filename);
+    /* Don't try again if the table is missing or invalid */
+    card->rainbow_table_loaded = -1;
+    
+    /* The table is read() in on Windows, so open it in binary mode */
+    int fd = open(filename, O_RDONLY | O_BINARY);
+    struct stat fs;
     
-    FILE *f = fopen(filename, "rb");
-    if (!f)
+    if (fd < 0 || fstat(fd, &fs) != 0)
     {
         fprintf(stderr, "Warning: Could not open rainbow table file %s\n", filename);
+        if (fd >= 0) close(fd);
         return 0;
     }
     
-    /* Allocate table */
-    card->rainbow_table = (uint8_t**)calloc(0x1000000, sizeof(uint8_t*));
-    if (!card->rainbow_table)
+    size_t size = fs.st_size;
+    const uint8_t *table = NULL;
+    
+    if (size >= 4)
     {
-        fclose(f);
-        fprintf(stderr, "Failed to allocate rainbow table memory\n");
+#ifndef _WIN32
+        /* Map the table read-only, the pages are shared with any
+         * other process using the same file */
+        void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        
+        if (map != MAP_FAILED)
+        {
+            madvise(map, size, MADV_RANDOM);
+            table = map;
+        }
+#else
+        uint8_t *data = malloc(size);
+        
+        if (data && read(fd, data, size) != (ssize_t)size)
+        {
+            free(data);
+            data = NULL;
+        }
+        
+        table = data;
+#endif
+    }
+    
+    close(fd);
+    
+    if (!table)
+    {
+        fprintf(stderr, "Failed to map rainbow table %s\n", filename);
         return 0;
     }
     
-    /* Load signatures */
-    uint8_t signature[4];
-    int loaded = 0;
-    for (int i = 0; i < 0x1000000; i++)
+    if (size >= VC10_RAINBOW_HEADER_SIZE && memcmp(table, VC10_RAINBOW_MAGIC, 8) == 0)
     {
-        if (fread(signature, 1, 4, f) != 4) break;
+        /* Compact table, check the index agrees with the length */
+        uint32_t entries = _rd32(table + 8);
         
-        /* Skip empty entries */
-        if (signature[0] == 0 && signature[1] == 0 && 
-            signature[2] == 0 && signature[3] == 0)
+        if (_rd32(table + VC10_RAINBOW_INDEX + 256 * 4) != entries ||
+            (size - VC10_RAINBOW_HEADER_SIZE) / 8 < entries)
         {
-            continue;
+            fprintf(stderr, "Invalid compact rainbow table %s\n", filename);
+            _unmap_rainbow_table(table, size);
+            return 0;
         }
         
-        card->rainbow_table[i] = (uint8_t*)malloc(4);
-        if (card->rainbow_table[i])
+        card->rainbow_entries = entries;
+        card->rainbow_compact = 1;
+    }
+    else
+    {
+        /* Flat table, a short file is treated as missing the later entries */
+        card->rainbow_entries = size / 4;
+        if (card->rainbow_entries > VC10_RAINBOW_ENTRIES)
         {
-            memcpy(card->rainbow_table[i], signature, 4);
-            loaded++;
+            card->rainbow_entries = VC10_RAINBOW_ENTRIES;
         }
+        
+        card->rainbow_compact = 0;
     }
     
-    fclose(f);
+    card->rainbow_table = table;
+    card->rainbow_table_size = size;
     card->rainbow_table_loaded = 1;
-    printf("Loaded %d signatures from 64MB rainbow table\n", loaded);
+    
+    printf("Mapped %s rainbow table from %s (%" PRIu32 " entries)\n",
+           card->rainbow_compact ? "compact" : "flat", filename, card->rainbow_entries);
     
     return 1;
 }
 
+/* Find the signature for a message hash in the loaded rainbow table */
+static const uint8_t *_rainbow_lookup(const card10_t *card, uint32_t message_hash)
+{
+    const uint8_t *sig;
+    
+    if (card->rainbow_table_loaded != 1) return NULL;
+    
+    if (!card->rainbow_compact)
+    {
+        if (message_hash >= card->rainbow_entries) return NULL;
+        
+        sig = card->rainbow_table + (size_t)message_hash * 4;
+        
+        /* Empty entries are all zero */
+        return _rd32(sig) != 0 ? sig : NULL;
+    }
+    
+    if (message_hash >= VC10_RAINBOW_ENTRIES) return NULL;
+    
+    /* Narrow the search with the index, then binary search the entries */
+    const uint8_t *index = card->rainbow_table + VC10_RAINBOW_INDEX + (message_hash >> 16) * 4;
+    const uint8_t *entries = card->rainbow_table + VC10_RAINBOW_HEADER_SIZE;
+    uint32_t lo = _rd32(index);
+    uint32_t hi = _rd32(index + 4);
+    
+    if (hi > card->rainbow_entries) hi = card->rainbow_entries;
+    
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t key = _rd32(entries + (size_t)mid * 8);
+        
+        if (key == message_hash)
+        {
+            return entries + (size_t)mid * 8 + 4;
+        }
+        else if (key < message_hash)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    
+    return NULL;
+}
+
 static void _kernel_init(kernel10_t *kernel)
 {
     kernel->bptr5 = 0x00;
@@ -157,30 +270,42 @@ static void _kernel_prepare_for_message_hash(kernel10_t *kernel, uint8_t *output
 }
 
 
-/* Get signature for message hash */
-static inline const uint8_t* _get_signature_for_hash(uint32_t message_hash)
+/* Get signature for message hash from the embedded table. The
+ * signature is written to sig, returns 1 if found or 0 if not */
+static int _get_signature_for_hash(uint32_t message_hash, uint8_t sig[4])
 {
-    static uint8_t sig_bytes[4];
+    int lo = 0;
+    int hi = sizeof(SIGNATURE_TABLE) / sizeof(SIGNATURE_TABLE[0]);
     
-    for (int i = 0; i < sizeof(SIGNATURE_TABLE); i++)
+    while (lo < hi)
     {
-        if (SIGNATURE_TABLE[i].message_hash == message_hash)
+        int mid = lo + (hi - lo) / 2;
+        
+        if (SIGNATURE_TABLE[mid].message_hash == message_hash)
         {
-            uint32_t sig = SIGNATURE_TABLE[i].signature;
+            uint32_t v = SIGNATURE_TABLE[mid].signature;
             
             /* Check if signature exists */
-            if (sig != 0)
-            {
-                /* Convert uint32 to bytes */
-                sig_bytes[0] = (sig >> 24) & 0xFF;
-                sig_bytes[1] = (sig >> 16) & 0xFF;
-                sig_bytes[2] = (sig >> 8) & 0xFF;
-                sig_bytes[3] = sig & 0xFF;
-                return sig_bytes;
-            }
-            return 0;
+            if (v == 0) return 0;
+            
+            /* Convert uint32 to bytes */
+            sig[0] = (v >> 24) & 0xFF;
+            sig[1] = (v >> 16) & 0xFF;
+            sig[2] = (v >> 8) & 0xFF;
+            sig[3] = v & 0xFF;
+            
+            return 1;
+        }
+        else if (SIGNATURE_TABLE[mid].message_hash < message_hash)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
         }
     }
+    
     return 0;
 }
 
@@ -276,29 +401,25 @@ static int _vc10_encrypt_74(card10_t *card, const uint8_t *input_message, int in
                             ((uint32_t)output->hash[1] << 8) | 
                             output->hash[0];
     
-    /* Check embedded 256-entry table  */
-    const uint8_t *sig = _get_signature_for_hash(message_hash);
+    /* Check embedded table */
+    uint8_t sig_bytes[4];
+    const uint8_t *sig = NULL;
     
-    /* Load external rainbow table if signature is not found */
+    if (_get_signature_for_hash(message_hash, sig_bytes))
+    {
+        sig = sig_bytes;
+    }
+    
+    /* Map the external rainbow table the first time a signature is not found */
     if (!sig && !card->rainbow_table_loaded)
     {
-        fprintf(stderr, "Signature not in embedded table, loading 64MB rainbow table...\n");
-        if (card_load_rainbow_table(card, "videocrypt10-data.bin"))
-        {
-            /* Try again with loaded table */
-            if (message_hash < 0x1000000 && card->rainbow_table[message_hash])
-            {
-                sig = card->rainbow_table[message_hash];
-            }
-        }
+        fprintf(stderr, "Signature not in embedded table, loading rainbow table...\n");
+        card_load_rainbow_table(card, "videocrypt10-data.bin");
     }
-    /* Tier 2: If already loaded, check it */
-    else if (!sig && card->rainbow_table_loaded && message_hash < 0x1000000)
+    
+    if (!sig)
     {
-        if (card->rainbow_table[message_hash])
-        {
-            sig = card->rainbow_table[message_hash];
-        }
+        sig = _rainbow_lookup(card, message_hash);
     }
     
     if (!sig)
@@ -336,7 +457,7 @@ static int _vc10_encrypt_74(card10_t *card, const uint8_t *input_message, int in
     return ENCRYPT_OK;
 }
 
-card10_t *card_create()
+static card10_t *card_create(void)
 {
     card10_t *card = (card10_t*)malloc(sizeof(card10_t));
     if (!card) return NULL;
@@ -345,39 +466,41 @@ card10_t *card_create()
     asic_reset(card->asic);
     _kernel_init(&card->kernel);
     card->rainbow_table = NULL;
+    card->rainbow_table_size = 0;
+    card->rainbow_entries = 0;
+    card->rainbow_compact = 0;
     card->rainbow_table_loaded = 0;
     
     return card;
 }
 
-void card_destroy(card10_t *card)
+static void card_destroy(card10_t *card)
 {
     if (card)
     {
-        /* Free rainbow table if loaded */
+        /* Release rainbow table if loaded */
         if (card->rainbow_table)
         {
-            for (int i = 0; i < 0x1000000; i++)
-            {
-                if (card->rainbow_table[i])
-                {
-                    free(card->rainbow_table[i]);
-                }
-            }
-            free(card->rainbow_table);
+            _unmap_rainbow_table(card->rainbow_table, card->rainbow_table_size);
         }
         free(card);
     }
 }
 
+void vc_free_sky_p10(message_data_t *m)
+{
+    card_destroy(m->card10);
+    m->card10 = NULL;
+}
+
 void vc_seed_sky_p10(_vc_block_t *s, int mode)
 {
-    /* Static card instance - persists across calls to cache rainbow table */
-    static card10_t *card = NULL;
-    static int initialized = 0;
+    /* Each encoder has its own card instance, which
+     * persists across calls to cache the rainbow table */
+    card10_t *card = s->message_data->card10;
     int i;
     
-    if (!initialized)
+    if (!card)
     {
         card = card_create();
         if (!card) 
@@ -385,7 +508,7 @@ void vc_seed_sky_p10(_vc_block_t *s, int mode)
             fprintf(stderr, "Failed to create card\n");
             return;
         }
-        initialized = 1;
+        s->message_data->card10 = card;
     }
 
     uint8_t plaintext[32] = {
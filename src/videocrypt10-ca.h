@@ -30,12 +30,15 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "videocrypt-ca.h"
 
-/* ASIC structure */
+/* ASIC structure. The 105-bit shift register is packed into two
+ * words, bits 0-63 in [0] and bits 64-104 in [1]. The FIFO holds the
+ * last eight bytes received, the newest in the low byte */
 typedef struct {
-    bool shift_register[105];
-    bool fifo_buffer[64];
+    uint64_t shift_register[2];
+    uint64_t fifo_buffer;
     int iterations;
     bool crypto_enabled;
     bool decoder_capture;
@@ -52,15 +55,36 @@ typedef struct {
     uint8_t b;
 } kernel10_t;
 
+/* Rainbow tables. The flat table is 0x1000000 four byte signatures
+ * indexed by message hash, with zeros for missing entries. The compact
+ * table is converted from it by hacktv-vc10table and holds only the
+ * entries that exist. All values are big-endian:
+ *
+ *    0: Magic "VC10RTC1"
+ *    8: Number of entries, uint32
+ *   12: Index, 257 x uint32. Entry n is the position of the first key
+ *       with n in its top byte, entry 256 is the number of entries
+ * 1040: Entries sorted by key, 8 bytes each. A uint32 message hash
+ *       followed by the four signature bytes
+*/
+#define VC10_RAINBOW_ENTRIES     0x1000000
+#define VC10_RAINBOW_MAGIC       "VC10RTC1"
+#define VC10_RAINBOW_INDEX       12
+#define VC10_RAINBOW_HEADER_SIZE (VC10_RAINBOW_INDEX + 257 * 4)
+
 /* Card structure */
 typedef struct card10_t {
     asic10_t asic_instance;
     asic10_t *asic;
     kernel10_t kernel;
-    uint8_t **rainbow_table;      /* 64MB rainbow table (optional) */
-    int rainbow_table_loaded;     /* Flag for 64MB table */
+    const uint8_t *rainbow_table; /* Mapped rainbow table (optional) */
+    size_t rainbow_table_size;    /* Length of the mapping */
+    uint32_t rainbow_entries;     /* Number of entries in the table */
+    int rainbow_compact;          /* Set for the compact format */
+    int rainbow_table_loaded;     /* 1 = mapped, -1 = load failed */
 } card10_t;
 
 extern void vc_seed_sky_p10(_vc_block_t *s, int mode);
+extern void vc_free_sky_p10(message_data_t *m);
 
 #endif /* VIDEOCRYPT10_H */
\ No newline at end of file
@@ -32,136 +32,136 @@ typedef struct {
     uint32_t signature;     /* 4-byte signature */
 } asic10_sig_table_t;
 
+/* Sorted by message hash for binary search */
 static const asic10_sig_table_t SIGNATURE_TABLE[256*2] = {
-    {0x2B8555, 0x04CA01D2}, {0x634B7D, 0x051593F8}, {0x358D17, 0x04188006}, {0x2073EC, 0x02D43A25},
-    {0x77D71E, 0x02700B18}, {0x349652, 0x04CD3093}, {0x32BDCB, 0x031DB033}, {0x48C803, 0x049A3ED7},
-    {0x435FE6, 0x049F909E}, {0xEA2129, 0x04D500E7}, {0xE47ED9, 0x04A552EC}, {0x2A88A3, 0x049CFE23},
-    {0x1C026F, 0x053D7D6F}, {0x35BC8F, 0x04BE9DFE}, {0x4C6A04, 0x043F0EAB}, {0x12558A, 0x05297562},
-    {0x940481, 0x04F8752C}, {0xC06F61, 0x04CED084}, {0xD77C6F, 0x03EF71BB}, {0xEBE910, 0x05422D53},
-    {0x0D5C39, 0x03ABDBC5}, {0x1AB90C, 0x04248157}, {0xE2C60B, 0x05420FB5}, {0xBBBFE8, 0x04FF7C91},
-    {0x8D9947, 0x04CB136D}, {0x03C7E7, 0x047C4B8B}, {0x542F5C, 0x04B8569D}, {0xCD90C2, 0x04BDAA50},
-    {0x4415E4, 0x04A8DD64}, {0x9D4EF3, 0x0493E4D3}, {0x4A6C58, 0x04E81351}, {0xCE420F, 0x05083827},
-    {0x97DB8B, 0x04DC9158}, {0x363F29, 0x04949599}, {0x6E3CC7, 0x0435B3DB}, {0xA92713, 0x037EC5D8},
-    {0x763694, 0x045FD3ED}, {0x423FC0, 0x04D82345}, {0x52F8D8, 0x047F5702}, {0x45CE3D, 0x004DA84D},
-    {0xD4CD90, 0x02BE899A}, {0x6E253F, 0x053D8B07}, {0x8AC5C0, 0x039692FB}, {0xFE5386, 0x05090BC5},
-    {0xA684ED, 0x050E844B}, {0x9E270F, 0x03DE1948}, {0x0E2177, 0x04968869}, {0x2A8501, 0x04F9D41A},
-    {0xF6EFD9, 0x04E32987}, {0xD88134, 0x04E8F6AF}, {0xA1D5EA, 0x04DF79B1}, {0xFD351F, 0x04C0DF9A},
-    {0xEA0ED0, 0x04FFEECE}, {0xBE0F6D, 0x03C37FDF}, {0x9F4659, 0x03B0EBBE}, {0xC4E8CC, 0x03DF3BFF},
-    {0xFA09B3, 0x04765459}, {0x16C534, 0x03BC16AD}, {0x65BF89, 0x04C2DE0F}, {0xF0FACA, 0x053274A6},
-    {0xCE23A8, 0x0549B4FF}, {0xC30774, 0x054D1ABF}, {0x1E11D0, 0x0480C85F}, {0xB73A8F, 0x0375A266},
-    {0x95A83B, 0x0514A91B}, {0xBCEC30, 0x052C7818}, {0xCBA1A3, 0x04E60946}, {0xBB475C, 0x04504D79},
-    {0x4B800F, 0x048B264D}, {0x45726B, 0x051C167F}, {0xB2971C, 0x04F8CE4C}, {0x55783F, 0x051D5A4B},
-    {0x626127, 0x03D78077}, {0x229326, 0x02E9522E}, {0x4EA6B3, 0x0458677B}, {0x9A2DDF, 0x0446111D},
-    {0xED6091, 0x05079504}, {0xD813F8, 0x040A7467}, {0x761E0D, 0x04F88871}, {0x296E32, 0x04DD47E2},
-    {0xB28C64, 0x05033F32}, {0xF257E9, 0x04EB18D8}, {0xC86C4F, 0x04D39235}, {0x57936E, 0x04A8229A},
-    {0xD60ED5, 0x050952A9}, {0x2CF913, 0x0444C1E0}, {0x8FB57F, 0x03EE291D}, {0xA3AAEA, 0x0384B173},
-    {0x25D3F9, 0x04EBD44E}, {0xCA9060, 0x034B3DAD}, {0x48190B, 0x04AFB560}, {0xFEC745, 0x039438F1},
-    {0x788545, 0x05476608}, {0x117F65, 0x05206FFC}, {0x1034A9, 0x0545F4B0}, {0x593D3A, 0x03936BB8},
-    {0x63A1F5, 0x0502EE14}, {0x85D0C9, 0x02FE4740}, {0xA5FD1A, 0x05393651}, {0x5C28AD, 0x0284F40D},
-    {0xC7CD46, 0x053F8B99}, {0xB17E07, 0x04EBF583}, {0xBD675E, 0x03798062}, {0x7FF774, 0x03610340},
-    {0x19B491, 0x04F33C0D}, {0x2ACD2A, 0x0523182D}, {0xB2822B, 0x053A00E4}, {0x0F504F, 0x052790DD},
-    {0xC87CEF, 0x052E5954}, {0xD3452C, 0x054B7B87}, {0x2A5D2A, 0x054DC26C}, {0x8C873D, 0x04EB9365},
-    {0x01435C, 0x04D5E2EC}, {0xAE12D9, 0x03B87771}, {0x89C467, 0x05259A6E}, {0xD8AE96, 0x043B90C2},
-    {0xCDBCA5, 0x050743B2}, {0xD651FA, 0x0453841B}, {0x31520E, 0x04F98126}, {0x2472DB, 0x02AF4772},
-    {0xE8FF47, 0x03E0DB7A}, {0x66555F, 0x05007392}, {0x864C4C, 0x04ECA83E}, {0xFE3CC3, 0x04937F57},
-    {0xDAC4E4, 0x04BD859A}, {0x73DA6F, 0x0358D3C2}, {0x69F1BD, 0x03A198FA}, {0xAC2D6C, 0x04710426},
-    {0xD16439, 0x0396A858}, {0xEB32C0, 0x04DB3496}, {0x67CEE0, 0x05429131}, {0x92EBD6, 0x042BBB5B},
-    {0x6821D8, 0x050AF758}, {0x72CCBE, 0x0458E704}, {0x7C89F9, 0x04A2FED0}, {0xC1F64B, 0x054E510C},
-    {0x59BE06, 0x054F563C}, {0x285BB2, 0x045A638D}, {0xAA42F5, 0x046A3145}, {0xD40DD0, 0x047C2C6A},
-    {0x9B2711, 0x048E4EB6}, {0xE65D3D, 0x053124B4}, {0xF2CD7E, 0x053B8956}, {0x538018, 0x04D2F659},
-    {0xC00050, 0x04D67C05}, {0x96464B, 0x035CE10D}, {0xAC5C95, 0x04B57AAE}, {0xC1747A, 0x05205135},
-    {0x083700, 0x052B4021}, {0xFDC073, 0x03536E67}, {0x9F25FD, 0x03E55E52}, {0x272691, 0x04069FD9},
-    {0xA5B316, 0x050A6F3F}, {0x07F40D, 0x05186B9E}, {0x13E818, 0x053B2825}, {0x7831B0, 0x051A6DCA},
-    {0xD2D2EA, 0x030CB5E7}, {0x15B8C6, 0x04F4BD66}, {0x9964DA, 0x054D708E}, {0x199ADB, 0x04BBC26C},
-    {0xB9D1C5, 0x052D2934}, {0x768E4C, 0x03C011C7}, {0xB78E68, 0x03CE4AC2}, {0x993926, 0x05501D1A},
-    {0xCA8C25, 0x01CADE42}, {0x17AE10, 0x047304F6}, {0xC72276, 0x048EC36F}, {0x83A274, 0x04213396},
-    {0xE6A896, 0x0529D8E3}, {0x1A8561, 0x051784FF}, {0xEA8867, 0x051EA079}, {0x8CEC37, 0x0411A2C9},
-    {0x43E88A, 0x0352BF35}, {0xE673B9, 0x048053C2}, {0x395CB0, 0x04C78582}, {0xF1084B, 0x051431E1},
-    {0x2C3C3E, 0x04460A9C}, {0xAD1B93, 0x05182851}, {0x9E6D86, 0x051B7626}, {0xADC0C4, 0x04C8E149},
-    {0x5E0568, 0x05410CCE}, {0x3BDAF8, 0x03856999}, {0xCDBBE5, 0x0121F3B7}, {0xBD6317, 0x051DF48D},
-    {0x07585D, 0x0198E692}, {0x9E3025, 0x04377EED}, {0x736F17, 0x01EA827D}, {0x3FAFFF, 0x03728768},
-    {0x574572, 0x0456AD55}, {0xD699DE, 0x03B5986F}, {0x6BB285, 0x03A85FDB}, {0x12E259, 0x04F09890},
-    {0x07A8FE, 0x03CA7975}, {0x22C621, 0x0464DE66}, {0xC55940, 0x03970505}, {0xB6CFC9, 0x040F06CC},
-    {0xE648FE, 0x051D3623}, {0xEF260F, 0x04470F7F}, {0x70B6CC, 0x0515CD4F}, {0x54D8E3, 0x0516EC30},
-    {0x0E4918, 0x054B1A62}, {0x3F71D0, 0x03B62C12}, {0x27842D, 0x02CC05E0}, {0x837BFA, 0x04991F55},
-    {0x6FCE8E, 0x02F0670D}, {0xDA75C6, 0x03E7F076}, {0x1B3D3F, 0x03B1A324}, {0xA43908, 0x04F0B37A},
-    {0xF4021B, 0x031E9E65}, {0xB62D01, 0x04E38A64}, {0x69B20B, 0x044B77E2}, {0x260AF7, 0x0498C75B},
-    {0x75902E, 0x0287415E}, {0x3391C3, 0x0426A22F}, {0xDDD519, 0x04B285C7}, {0xBE8A22, 0x03AA5B3B},
-    {0x74EE5D, 0x032997A5}, {0xCA96A6, 0x046713E1}, {0xE3F993, 0x01A12DA9}, {0x13ADCA, 0x0431D6A3},
-    {0x6230CC, 0x04EAC554}, {0x409CCB, 0x04CBDABA}, {0x02A6FC, 0x04CFB4F4}, {0xA85920, 0x047B0801},
-    {0x9A7ED1, 0x026B85B8}, {0x5161AA, 0x025CD998}, {0xEE1733, 0x041E0F1A}, {0xAD5527, 0x04B0F946},
-    {0x03947D, 0x04C5652F}, {0xBACE39, 0x041D1BEE}, {0x839516, 0x0492C27C}, {0xBB1535, 0x0445367F},
-    {0x4267A3, 0x05143945}, {0x9D1975, 0x04D81ECA}, {0x6DCE08, 0x0446F009}, {0x91C36C, 0x0497C233},
-    {0x5078ED, 0x04CDD41A}, {0x75AAB2, 0x0465CDFB}, {0xC995E6, 0x03B0D502}, {0xF2E6FA, 0x02F5E983},
-    {0x11C6E1, 0x04C88B35}, {0x5CE37E, 0x049CB8E1}, {0xA7E699, 0x04733609}, {0xB582A1, 0x04B0A73E},
-    {0x6B5FF1, 0x0538A2AE}, {0xFBAD6F, 0x044BB16F}, {0xD12C52, 0x038BA355}, {0xBEB424, 0x0299D384},
-    {0xC59227, 0x03F7B701}, {0xE24C6F, 0x054B1BFA}, {0xE88955, 0x03CC82BF}, {0x616846, 0x04A964FB},
-    {0x947A84, 0x04E0C1C4}, {0x480E77, 0x054FABF8}, {0xF40943, 0x04AAF149}, {0xCE5C5A, 0x0462E1F6},
-    /* PPV */
-    {0x6C0FC4, 0x030314C9}, {0xCFBB86, 0x034E99F0}, {0xAF4E22, 0x0544A190}, {0xBA4680, 0x044B5410},
-    {0xEFD1F2, 0x030FB97B}, {0x303348, 0x017F25FD}, {0x1C779C, 0x0489065D}, {0x8E38CE, 0x051C07B5},
-    {0xF4DEAF, 0x04D43DEB}, {0xCAD005, 0x03262788}, {0x7C11C9, 0x04BB957A}, {0xE4F8CF, 0x047A5F01},
-    {0x7DD099, 0x033F8B67}, {0xF7D6F0, 0x03BA4349}, {0x703990, 0x0504EF9F}, {0x17ACEF, 0x04818E8A},
-    {0xC3DF94, 0x04D52CED}, {0x4A216D, 0x053A4283}, {0xD374A6, 0x0522F9F4}, {0xC0A4D4, 0x0541FFE9},
-    {0x96B716, 0x0480E89F}, {0x9C42C6, 0x03F4F232}, {0x364A74, 0x04ECED30}, {0x2E5B8E, 0x026A1CBF},
-    {0x032AA7, 0x053469C5}, {0x07B96D, 0x04B715AE}, {0xCB24BC, 0x053AA64D}, {0xC8487F, 0x035293F3},
-    {0x9B5916, 0x01F0EAED}, {0xE3EF38, 0x05031F7C}, {0x2EA653, 0x03F2049D}, {0x9DFA63, 0x0422FBBA},
-    {0xC226F0, 0x04A4A13C}, {0x3BF5B4, 0x04C4D77A}, {0xB05CF1, 0x04142C28}, {0x777E6E, 0x0550DC15},
-    {0x54629F, 0x04CA8536}, {0x24AC61, 0x054E9555}, {0xEE2AE0, 0x054B79EA}, {0x433B7F, 0x042581A6},
-    {0xFA6137, 0x04DA2E2D}, {0x5E92BF, 0x02A74E10}, {0x3FA4D7, 0x019A744E}, {0xFC1994, 0x042D2C3B},
-    {0xB7358E, 0x04F46555}, {0x3C8587, 0x0544F2FC}, {0x3C1014, 0x053A9F76}, {0x99F42C, 0x03876C2E},
-    {0xD28070, 0x0532D5F0}, {0x3C2C0D, 0x026289A0}, {0xC9958C, 0x04C29E79}, {0xAB4A04, 0x051384D5},
-    {0x635671, 0x03CCCA91}, {0x66746C, 0x053357BF}, {0x27B264, 0x04754589}, {0x3D4D67, 0x04E89022},
-    {0x92D943, 0x0543578C}, {0xB175C8, 0x04670721}, {0x75BA7C, 0x0504E8AB}, {0xB04EB1, 0x044EEE97},
-    {0x822149, 0x044DF1CD}, {0x1A6CCE, 0x0445A34C}, {0x77ABB8, 0x043701E0}, {0x42D9D3, 0x04806A70},
-    {0x477897, 0x04C79922}, {0x3B073B, 0x04DC29C2}, {0x402E23, 0x04D92715}, {0x1CB7C1, 0x03F0B5A6},
-    {0xDB89EC, 0x04F5A023}, {0x0354C3, 0x040EF78E}, {0xCEE323, 0x046718A1}, {0x6EA7AF, 0x04793F05},
-    {0xF11895, 0x00787C7E}, {0xD65651, 0x034BF44F}, {0x358174, 0x03A88C8C}, {0x760AD3, 0x050A246F},
-    {0xD56ADA, 0x04209E86}, {0xD491B9, 0x0541F615}, {0x0433AC, 0x04EB9333}, {0x2B1FC5, 0x04785F70},
-    {0x182AD7, 0x0488A391}, {0x1E778F, 0x05288153}, {0x376BB2, 0x04F4C7A5}, {0xD639E1, 0x047E5058},
-    {0x64F13E, 0x031C3FC4}, {0x270635, 0x04FB2F82}, {0xA2A7DA, 0x03630D29}, {0x5F6FC1, 0x04D4D9E3},
-    {0x298203, 0x04F9F7EF}, {0x182661, 0x05336CB7}, {0xD9E892, 0x0509D654}, {0x791A57, 0x043AE296},
-    {0x6D64C7, 0x040F4B1B}, {0x40B993, 0x0516CD8B}, {0xC13A01, 0x04C3FAF1}, {0x8590F1, 0x0541CC90},
-    {0x2DAA30, 0x039A8EC9}, {0xD9D995, 0x03E122E9}, {0x52581E, 0x049E1DB5}, {0x44D021, 0x04DEB439},
-    {0xE75C6A, 0x052448DF}, {0xFA4B98, 0x050EE7F6}, {0x944880, 0x04B3D543}, {0x1EAEC5, 0x054A3DD7},
-    {0x2C9784, 0x04D74039}, {0x66F34B, 0x04A22C06}, {0xA59921, 0x04881B33}, {0x854B7D, 0x0535AD59},
-    {0xB0E3A9, 0x04757852}, {0xF55D07, 0x04D91351}, {0xACD128, 0x04BAD57A}, {0x9F9E71, 0x0523738D},
-    {0xEEE733, 0x04F007C8}, {0xED6838, 0x04D38CA2}, {0x5E22F4, 0x04D2B168}, {0x1676B1, 0x046C1A65},
-    {0xB6F3E9, 0x04898D7C}, {0x0612BD, 0x046CE2ED}, {0x1D59D3, 0x04735B6C}, {0xBBB779, 0x041C2182},
-    {0x756581, 0x03EC3F69}, {0xE4148D, 0x04283B7F}, {0xCE84B2, 0x045C3BA6}, {0xE7D03B, 0x040739C4},
-    {0x7AAA82, 0x041E9432}, {0x11B3E9, 0x03F39DFD}, {0xF5F303, 0x03E2D6D6}, {0xAF585C, 0x04F1CD37},
-    {0x3B9807, 0x02536FC0}, {0x23DF66, 0x04BDF3C2}, {0x5A2CD9, 0x04C23AC4}, {0xE5947D, 0x05401C9B},
-    {0x40387E, 0x053B6685}, {0xAA3501, 0x04BA0CBB}, {0x9AD947, 0x04880E03}, {0x9BC703, 0x04B8126C},
-    {0x10091B, 0x05187537}, {0xB49601, 0x04BEB164}, {0x1912EA, 0x0412594D}, {0x458918, 0x0509A5DE},
-    {0x4301EB, 0x049EAA0E}, {0x668FE8, 0x04F56963}, {0x4D0A41, 0x0520C58F}, {0xEFD219, 0x04EA3E7E},
-    {0x779846, 0x03577969}, {0x4D70F1, 0x04522720}, {0x43E6F7, 0x025CB4E2}, {0x10C947, 0x0529591C},
-    {0xF1ABF0, 0x054D0AD8}, {0x55BC89, 0x048E167D}, {0xC3E328, 0x054EAF3A}, {0x74E0E7, 0x04D008C9},
-    {0x9613DA, 0x05362E54}, {0x4C6692, 0x04821521}, {0x7537D9, 0x04C9EFDC}, {0xF495BF, 0x047D3A35},
-    {0x5ACC24, 0x04D5DBBB}, {0x7BD087, 0x03653330}, {0x496FB6, 0x054E5E2B}, {0xFF1FD1, 0x054E7F28},
-    {0xE2EDC2, 0x049E12A0}, {0xF0E274, 0x04135E85}, {0xD3BF29, 0x04AF60C0}, {0xC08F34, 0x051BBA2B},
-    {0xB47057, 0x04DC0B07}, {0xFBF326, 0x054EE0A7}, {0x585AB7, 0x04DB0A55}, {0x73D48F, 0x04988B98},
-    {0x0D2FBA, 0x052A98E1}, {0x99055F, 0x03C1E843}, {0x04096A, 0x048F561E}, {0xF6853C, 0x0515134A},
-    {0x5C601B, 0x05303DF3}, {0x678C97, 0x052E00E7}, {0x1AEFC0, 0x047735F9}, {0x2A5F78, 0x0414C7BF},
-    {0x503568, 0x0550BC8C}, {0x2D1B02, 0x046555AC}, {0x6009CF, 0x04E95B36}, {0xBAC21A, 0x048C76AB},
-    {0xAD345B, 0x042E240C}, {0x143735, 0x03D18912}, {0x7C65AC, 0x041BAC28}, {0xBC3D1E, 0x04D56F4A},
-    {0xF2DFDE, 0x04C294C9}, {0xCA779A, 0x04F11073}, {0xB1DDF0, 0x051A5884}, {0xFA58F9, 0x04A3F411},
-    {0x122801, 0x05514EC9}, {0xC863AE, 0x04B3304F}, {0xDA01A3, 0x05229259}, {0x0BEACB, 0x0440B742},
-    {0xC38881, 0x04FD243F}, {0xC34C08, 0x03E73A72}, {0x51FFC1, 0x04B98EAC}, {0x6AA6A3, 0x045415C2},
-    {0x9B1147, 0x04271D9C}, {0x0798F2, 0x0546B35B}, {0x48471C, 0x0346F66A}, {0xC5195E, 0x053923B3},
-    {0x66A526, 0x00CF0231}, {0x6D9DCE, 0x0396AEA7}, {0xE6A426, 0x04D0DA9C}, {0xFB8F35, 0x04B17F60},
-    {0xF9D503, 0x04C8E4D3}, {0xA9FA08, 0x03E8E499}, {0x80AA04, 0x04E22873}, {0x844070, 0x04838BC7},
-    {0x55AFBB, 0x04C9BDAB}, {0x8464ED, 0x04336876}, {0xC52F7A, 0x0488FE24}, {0x583283, 0x051D72A0},
-    {0xD17545, 0x03B6B4EC}, {0xFCF72A, 0x0492734E}, {0xC4FF72, 0x04BB0776}, {0x4BC9FC, 0x039C2BA7},
-    {0x6177D9, 0x0489ED49}, {0xCE6C2B, 0x0499DC0D}, {0xF7CA60, 0x04CCC8CF}, {0x8F01A5, 0x04CD60B1},
-    {0xB32F5B, 0x04E4478F}, {0xE2BFDA, 0x044BE7F8}, {0xAAEB06, 0x03D4EF0E}, {0x153874, 0x04F7E726},
-    {0x47A921, 0x045DABA8}, {0x869651, 0x04D70647}, {0x29E22A, 0x04268C6D}, {0xD38AD2, 0x04FD4F53},
-    {0xFA44E4, 0x03E5856E}, {0x0C0269, 0x024BFD44}, {0x32A22C, 0x04BAFCB7}, {0xDDE88D, 0x04D2DE24},
-    {0xB8F2B5, 0x0504795A}, {0x1946CD, 0x054D373F}, {0x2D051F, 0x04A8BA12}, {0x9E9E28, 0x044F4F45},
-    {0x9CBB48, 0x02A01D2E}, {0x52375B, 0x0516319B}, {0x3287BA, 0x051ED63C}, {0xC7B5F3, 0x03697C23},
-    {0x4B1E6F, 0x04C4B9EC}, {0xCE4D44, 0x0536746F}, {0x61F479, 0x0509C9C2}, {0x7843FC, 0x04814E56},
-    {0x7BE67B, 0x04C3FEBE}, {0xA70592, 0x053F1B98}, {0x020C0C, 0x04C0E145}, {0x3E290E, 0x03C1B5E7},
-    {0x09D608, 0x04F6D152}, {0x953E69, 0x04FDE928}, {0xD724C2, 0x0491C0D8}, {0x1DC69C, 0x04DBACD4},
-    {0x086D09, 0x05041D0E}, {0x19A03E, 0x0522E1CE}, {0xA92451, 0x0525F57D}, {0x5FAFD0, 0x04747179},
+    {0x01435C, 0x04D5E2EC}, {0x020C0C, 0x04C0E145}, {0x02A6FC, 0x04CFB4F4}, {0x032AA7, 0x053469C5},
+    {0x0354C3, 0x040EF78E}, {0x03947D, 0x04C5652F}, {0x03C7E7, 0x047C4B8B}, {0x04096A, 0x048F561E},
+    {0x0433AC, 0x04EB9333}, {0x0612BD, 0x046CE2ED}, {0x07585D, 0x0198E692}, {0x0798F2, 0x0546B35B},
+    {0x07A8FE, 0x03CA7975}, {0x07B96D, 0x04B715AE}, {0x07F40D, 0x05186B9E}, {0x083700, 0x052B4021},
+    {0x086D09, 0x05041D0E}, {0x09D608, 0x04F6D152}, {0x0BEACB, 0x0440B742}, {0x0C0269, 0x024BFD44},
+    {0x0D2FBA, 0x052A98E1}, {0x0D5C39, 0x03ABDBC5}, {0x0E2177, 0x04968869}, {0x0E4918, 0x054B1A62},
+    {0x0F504F, 0x052790DD}, {0x10091B, 0x05187537}, {0x1034A9, 0x0545F4B0}, {0x10C947, 0x0529591C},
+    {0x117F65, 0x05206FFC}, {0x11B3E9, 0x03F39DFD}, {0x11C6E1, 0x04C88B35}, {0x122801, 0x05514EC9},
+    {0x12558A, 0x05297562}, {0x12E259, 0x04F09890}, {0x13ADCA, 0x0431D6A3}, {0x13E818, 0x053B2825},
+    {0x143735, 0x03D18912}, {0x153874, 0x04F7E726}, {0x15B8C6, 0x04F4BD66}, {0x1676B1, 0x046C1A65},
+    {0x16C534, 0x03BC16AD}, {0x17ACEF, 0x04818E8A}, {0x17AE10, 0x047304F6}, {0x182661, 0x05336CB7},
+    {0x182AD7, 0x0488A391}, {0x1912EA, 0x0412594D}, {0x1946CD, 0x054D373F}, {0x199ADB, 0x04BBC26C},
+    {0x19A03E, 0x0522E1CE}, {0x19B491, 0x04F33C0D}, {0x1A6CCE, 0x0445A34C}, {0x1A8561, 0x051784FF},
+    {0x1AB90C, 0x04248157}, {0x1AEFC0, 0x047735F9}, {0x1B3D3F, 0x03B1A324}, {0x1C026F, 0x053D7D6F},
+    {0x1C779C, 0x0489065D}, {0x1CB7C1, 0x03F0B5A6}, {0x1D59D3, 0x04735B6C}, {0x1DC69C, 0x04DBACD4},
+    {0x1E11D0, 0x0480C85F}, {0x1E778F, 0x05288153}, {0x1EAEC5, 0x054A3DD7}, {0x2073EC, 0x02D43A25},
+    {0x229326, 0x02E9522E}, {0x22C621, 0x0464DE66}, {0x23DF66, 0x04BDF3C2}, {0x2472DB, 0x02AF4772},
+    {0x24AC61, 0x054E9555}, {0x25D3F9, 0x04EBD44E}, {0x260AF7, 0x0498C75B}, {0x270635, 0x04FB2F82},
+    {0x272691, 0x04069FD9}, {0x27842D, 0x02CC05E0}, {0x27B264, 0x04754589}, {0x285BB2, 0x045A638D},
+    {0x296E32, 0x04DD47E2}, {0x298203, 0x04F9F7EF}, {0x29E22A, 0x04268C6D}, {0x2A5D2A, 0x054DC26C},
+    {0x2A5F78, 0x0414C7BF}, {0x2A8501, 0x04F9D41A}, {0x2A88A3, 0x049CFE23}, {0x2ACD2A, 0x0523182D},
+    {0x2B1FC5, 0x04785F70}, {0x2B8555, 0x04CA01D2}, {0x2C3C3E, 0x04460A9C}, {0x2C9784, 0x04D74039},
+    {0x2CF913, 0x0444C1E0}, {0x2D051F, 0x04A8BA12}, {0x2D1B02, 0x046555AC}, {0x2DAA30, 0x039A8EC9},
+    {0x2E5B8E, 0x026A1CBF}, {0x2EA653, 0x03F2049D}, {0x303348, 0x017F25FD}, {0x31520E, 0x04F98126},
+    {0x3287BA, 0x051ED63C}, {0x32A22C, 0x04BAFCB7}, {0x32BDCB, 0x031DB033}, {0x3391C3, 0x0426A22F},
+    {0x349652, 0x04CD3093}, {0x358174, 0x03A88C8C}, {0x358D17, 0x04188006}, {0x35BC8F, 0x04BE9DFE},
+    {0x363F29, 0x04949599}, {0x364A74, 0x04ECED30}, {0x376BB2, 0x04F4C7A5}, {0x395CB0, 0x04C78582},
+    {0x3B073B, 0x04DC29C2}, {0x3B9807, 0x02536FC0}, {0x3BDAF8, 0x03856999}, {0x3BF5B4, 0x04C4D77A},
+    {0x3C1014, 0x053A9F76}, {0x3C2C0D, 0x026289A0}, {0x3C8587, 0x0544F2FC}, {0x3D4D67, 0x04E89022},
+    {0x3E290E, 0x03C1B5E7}, {0x3F71D0, 0x03B62C12}, {0x3FA4D7, 0x019A744E}, {0x3FAFFF, 0x03728768},
+    {0x402E23, 0x04D92715}, {0x40387E, 0x053B6685}, {0x409CCB, 0x04CBDABA}, {0x40B993, 0x0516CD8B},
+    {0x423FC0, 0x04D82345}, {0x4267A3, 0x05143945}, {0x42D9D3, 0x04806A70}, {0x4301EB, 0x049EAA0E},
+    {0x433B7F, 0x042581A6}, {0x435FE6, 0x049F909E}, {0x43E6F7, 0x025CB4E2}, {0x43E88A, 0x0352BF35},
+    {0x4415E4, 0x04A8DD64}, {0x44D021, 0x04DEB439}, {0x45726B, 0x051C167F}, {0x458918, 0x0509A5DE},
+    {0x45CE3D, 0x004DA84D}, {0x477897, 0x04C79922}, {0x47A921, 0x045DABA8}, {0x480E77, 0x054FABF8},
+    {0x48190B, 0x04AFB560}, {0x48471C, 0x0346F66A}, {0x48C803, 0x049A3ED7}, {0x496FB6, 0x054E5E2B},
+    {0x4A216D, 0x053A4283}, {0x4A6C58, 0x04E81351}, {0x4B1E6F, 0x04C4B9EC}, {0x4B800F, 0x048B264D},
+    {0x4BC9FC, 0x039C2BA7}, {0x4C6692, 0x04821521}, {0x4C6A04, 0x043F0EAB}, {0x4D0A41, 0x0520C58F},
+    {0x4D70F1, 0x04522720}, {0x4EA6B3, 0x0458677B}, {0x503568, 0x0550BC8C}, {0x5078ED, 0x04CDD41A},
+    {0x5161AA, 0x025CD998}, {0x51FFC1, 0x04B98EAC}, {0x52375B, 0x0516319B}, {0x52581E, 0x049E1DB5},
+    {0x52F8D8, 0x047F5702}, {0x538018, 0x04D2F659}, {0x542F5C, 0x04B8569D}, {0x54629F, 0x04CA8536},
+    {0x54D8E3, 0x0516EC30}, {0x55783F, 0x051D5A4B}, {0x55AFBB, 0x04C9BDAB}, {0x55BC89, 0x048E167D},
+    {0x574572, 0x0456AD55}, {0x57936E, 0x04A8229A}, {0x583283, 0x051D72A0}, {0x585AB7, 0x04DB0A55},
+    {0x593D3A, 0x03936BB8}, {0x59BE06, 0x054F563C}, {0x5A2CD9, 0x04C23AC4}, {0x5ACC24, 0x04D5DBBB},
+    {0x5C28AD, 0x0284F40D}, {0x5C601B, 0x05303DF3}, {0x5CE37E, 0x049CB8E1}, {0x5E0568, 0x05410CCE},
+    {0x5E22F4, 0x04D2B168}, {0x5E92BF, 0x02A74E10}, {0x5F6FC1, 0x04D4D9E3}, {0x5FAFD0, 0x04747179},
+    {0x6009CF, 0x04E95B36}, {0x616846, 0x04A964FB}, {0x6177D9, 0x0489ED49}, {0x61F479, 0x0509C9C2},
+    {0x6230CC, 0x04EAC554}, {0x626127, 0x03D78077}, {0x634B7D, 0x051593F8}, {0x635671, 0x03CCCA91},
+    {0x63A1F5, 0x0502EE14}, {0x64F13E, 0x031C3FC4}, {0x65BF89, 0x04C2DE0F}, {0x66555F, 0x05007392},
+    {0x66746C, 0x053357BF}, {0x668FE8, 0x04F56963}, {0x66A526, 0x00CF0231}, {0x66F34B, 0x04A22C06},
+    {0x678C97, 0x052E00E7}, {0x67CEE0, 0x05429131}, {0x6821D8, 0x050AF758}, {0x69B20B, 0x044B77E2},
+    {0x69F1BD, 0x03A198FA}, {0x6AA6A3, 0x045415C2}, {0x6B5FF1, 0x0538A2AE}, {0x6BB285, 0x03A85FDB},
+    {0x6C0FC4, 0x030314C9}, {0x6D64C7, 0x040F4B1B}, {0x6D9DCE, 0x0396AEA7}, {0x6DCE08, 0x0446F009},
+    {0x6E253F, 0x053D8B07}, {0x6E3CC7, 0x0435B3DB}, {0x6EA7AF, 0x04793F05}, {0x6FCE8E, 0x02F0670D},
+    {0x703990, 0x0504EF9F}, {0x70B6CC, 0x0515CD4F}, {0x72CCBE, 0x0458E704}, {0x736F17, 0x01EA827D},
+    {0x73D48F, 0x04988B98}, {0x73DA6F, 0x0358D3C2}, {0x74E0E7, 0x04D008C9}, {0x74EE5D, 0x032997A5},
+    {0x7537D9, 0x04C9EFDC}, {0x756581, 0x03EC3F69}, {0x75902E, 0x0287415E}, {0x75AAB2, 0x0465CDFB},
+    {0x75BA7C, 0x0504E8AB}, {0x760AD3, 0x050A246F}, {0x761E0D, 0x04F88871}, {0x763694, 0x045FD3ED},
+    {0x768E4C, 0x03C011C7}, {0x777E6E, 0x0550DC15}, {0x779846, 0x03577969}, {0x77ABB8, 0x043701E0},
+    {0x77D71E, 0x02700B18}, {0x7831B0, 0x051A6DCA}, {0x7843FC, 0x04814E56}, {0x788545, 0x05476608},
+    {0x791A57, 0x043AE296}, {0x7AAA82, 0x041E9432}, {0x7BD087, 0x03653330}, {0x7BE67B, 0x04C3FEBE},
+    {0x7C11C9, 0x04BB957A}, {0x7C65AC, 0x041BAC28}, {0x7C89F9, 0x04A2FED0}, {0x7DD099, 0x033F8B67},
+    {0x7FF774, 0x03610340}, {0x80AA04, 0x04E22873}, {0x822149, 0x044DF1CD}, {0x837BFA, 0x04991F55},
+    {0x839516, 0x0492C27C}, {0x83A274, 0x04213396}, {0x844070, 0x04838BC7}, {0x8464ED, 0x04336876},
+    {0x854B7D, 0x0535AD59}, {0x8590F1, 0x0541CC90}, {0x85D0C9, 0x02FE4740}, {0x864C4C, 0x04ECA83E},
+    {0x869651, 0x04D70647}, {0x89C467, 0x05259A6E}, {0x8AC5C0, 0x039692FB}, {0x8C873D, 0x04EB9365},
+    {0x8CEC37, 0x0411A2C9}, {0x8D9947, 0x04CB136D}, {0x8E38CE, 0x051C07B5}, {0x8F01A5, 0x04CD60B1},
+    {0x8FB57F, 0x03EE291D}, {0x91C36C, 0x0497C233}, {0x92D943, 0x0543578C}, {0x92EBD6, 0x042BBB5B},
+    {0x940481, 0x04F8752C}, {0x944880, 0x04B3D543}, {0x947A84, 0x04E0C1C4}, {0x953E69, 0x04FDE928},
+    {0x95A83B, 0x0514A91B}, {0x9613DA, 0x05362E54}, {0x96464B, 0x035CE10D}, {0x96B716, 0x0480E89F},
+    {0x97DB8B, 0x04DC9158}, {0x99055F, 0x03C1E843}, {0x993926, 0x05501D1A}, {0x9964DA, 0x054D708E},
+    {0x99F42C, 0x03876C2E}, {0x9A2DDF, 0x0446111D}, {0x9A7ED1, 0x026B85B8}, {0x9AD947, 0x04880E03},
+    {0x9B1147, 0x04271D9C}, {0x9B2711, 0x048E4EB6}, {0x9B5916, 0x01F0EAED}, {0x9BC703, 0x04B8126C},
+    {0x9C42C6, 0x03F4F232}, {0x9CBB48, 0x02A01D2E}, {0x9D1975, 0x04D81ECA}, {0x9D4EF3, 0x0493E4D3},
+    {0x9DFA63, 0x0422FBBA}, {0x9E270F, 0x03DE1948}, {0x9E3025, 0x04377EED}, {0x9E6D86, 0x051B7626},
+    {0x9E9E28, 0x044F4F45}, {0x9F25FD, 0x03E55E52}, {0x9F4659, 0x03B0EBBE}, {0x9F9E71, 0x0523738D},
+    {0xA1D5EA, 0x04DF79B1}, {0xA2A7DA, 0x03630D29}, {0xA3AAEA, 0x0384B173}, {0xA43908, 0x04F0B37A},
+    {0xA59921, 0x04881B33}, {0xA5B316, 0x050A6F3F}, {0xA5FD1A, 0x05393651}, {0xA684ED, 0x050E844B},
+    {0xA70592, 0x053F1B98}, {0xA7E699, 0x04733609}, {0xA85920, 0x047B0801}, {0xA92451, 0x0525F57D},
+    {0xA92713, 0x037EC5D8}, {0xA9FA08, 0x03E8E499}, {0xAA3501, 0x04BA0CBB}, {0xAA42F5, 0x046A3145},
+    {0xAAEB06, 0x03D4EF0E}, {0xAB4A04, 0x051384D5}, {0xAC2D6C, 0x04710426}, {0xAC5C95, 0x04B57AAE},
+    {0xACD128, 0x04BAD57A}, {0xAD1B93, 0x05182851}, {0xAD345B, 0x042E240C}, {0xAD5527, 0x04B0F946},
+    {0xADC0C4, 0x04C8E149}, {0xAE12D9, 0x03B87771}, {0xAF4E22, 0x0544A190}, {0xAF585C, 0x04F1CD37},
+    {0xB04EB1, 0x044EEE97}, {0xB05CF1, 0x04142C28}, {0xB0E3A9, 0x04757852}, {0xB175C8, 0x04670721},
+    {0xB17E07, 0x04EBF583}, {0xB1DDF0, 0x051A5884}, {0xB2822B, 0x053A00E4}, {0xB28C64, 0x05033F32},
+    {0xB2971C, 0x04F8CE4C}, {0xB32F5B, 0x04E4478F}, {0xB47057, 0x04DC0B07}, {0xB49601, 0x04BEB164},
+    {0xB582A1, 0x04B0A73E}, {0xB62D01, 0x04E38A64}, {0xB6CFC9, 0x040F06CC}, {0xB6F3E9, 0x04898D7C},
+    {0xB7358E, 0x04F46555}, {0xB73A8F, 0x0375A266}, {0xB78E68, 0x03CE4AC2}, {0xB8F2B5, 0x0504795A},
+    {0xB9D1C5, 0x052D2934}, {0xBA4680, 0x044B5410}, {0xBAC21A, 0x048C76AB}, {0xBACE39, 0x041D1BEE},
+    {0xBB1535, 0x0445367F}, {0xBB475C, 0x04504D79}, {0xBBB779, 0x041C2182}, {0xBBBFE8, 0x04FF7C91},
+    {0xBC3D1E, 0x04D56F4A}, {0xBCEC30, 0x052C7818}, {0xBD6317, 0x051DF48D}, {0xBD675E, 0x03798062},
+    {0xBE0F6D, 0x03C37FDF}, {0xBE8A22, 0x03AA5B3B}, {0xBEB424, 0x0299D384}, {0xC00050, 0x04D67C05},
+    {0xC06F61, 0x04CED084}, {0xC08F34, 0x051BBA2B}, {0xC0A4D4, 0x0541FFE9}, {0xC13A01, 0x04C3FAF1},
+    {0xC1747A, 0x05205135}, {0xC1F64B, 0x054E510C}, {0xC226F0, 0x04A4A13C}, {0xC30774, 0x054D1ABF},
+    {0xC34C08, 0x03E73A72}, {0xC38881, 0x04FD243F}, {0xC3DF94, 0x04D52CED}, {0xC3E328, 0x054EAF3A},
+    {0xC4E8CC, 0x03DF3BFF}, {0xC4FF72, 0x04BB0776}, {0xC5195E, 0x053923B3}, {0xC52F7A, 0x0488FE24},
+    {0xC55940, 0x03970505}, {0xC59227, 0x03F7B701}, {0xC72276, 0x048EC36F}, {0xC7B5F3, 0x03697C23},
+    {0xC7CD46, 0x053F8B99}, {0xC8487F, 0x035293F3}, {0xC863AE, 0x04B3304F}, {0xC86C4F, 0x04D39235},
+    {0xC87CEF, 0x052E5954}, {0xC9958C, 0x04C29E79}, {0xC995E6, 0x03B0D502}, {0xCA779A, 0x04F11073},
+    {0xCA8C25, 0x01CADE42}, {0xCA9060, 0x034B3DAD}, {0xCA96A6, 0x046713E1}, {0xCAD005, 0x03262788},
+    {0xCB24BC, 0x053AA64D}, {0xCBA1A3, 0x04E60946}, {0xCD90C2, 0x04BDAA50}, {0xCDBBE5, 0x0121F3B7},
+    {0xCDBCA5, 0x050743B2}, {0xCE23A8, 0x0549B4FF}, {0xCE420F, 0x05083827}, {0xCE4D44, 0x0536746F},
+    {0xCE5C5A, 0x0462E1F6}, {0xCE6C2B, 0x0499DC0D}, {0xCE84B2, 0x045C3BA6}, {0xCEE323, 0x046718A1},
+    {0xCFBB86, 0x034E99F0}, {0xD12C52, 0x038BA355}, {0xD16439, 0x0396A858}, {0xD17545, 0x03B6B4EC},
+    {0xD28070, 0x0532D5F0}, {0xD2D2EA, 0x030CB5E7}, {0xD3452C, 0x054B7B87}, {0xD374A6, 0x0522F9F4},
+    {0xD38AD2, 0x04FD4F53}, {0xD3BF29, 0x04AF60C0}, {0xD40DD0, 0x047C2C6A}, {0xD491B9, 0x0541F615},
+    {0xD4CD90, 0x02BE899A}, {0xD56ADA, 0x04209E86}, {0xD60ED5, 0x050952A9}, {0xD639E1, 0x047E5058},
+    {0xD651FA, 0x0453841B}, {0xD65651, 0x034BF44F}, {0xD699DE, 0x03B5986F}, {0xD724C2, 0x0491C0D8},
+    {0xD77C6F, 0x03EF71BB}, {0xD813F8, 0x040A7467}, {0xD88134, 0x04E8F6AF}, {0xD8AE96, 0x043B90C2},
+    {0xD9D995, 0x03E122E9}, {0xD9E892, 0x0509D654}, {0xDA01A3, 0x05229259}, {0xDA75C6, 0x03E7F076},
+    {0xDAC4E4, 0x04BD859A}, {0xDB89EC, 0x04F5A023}, {0xDDD519, 0x04B285C7}, {0xDDE88D, 0x04D2DE24},
+    {0xE24C6F, 0x054B1BFA}, {0xE2BFDA, 0x044BE7F8}, {0xE2C60B, 0x05420FB5}, {0xE2EDC2, 0x049E12A0},
+    {0xE3EF38, 0x05031F7C}, {0xE3F993, 0x01A12DA9}, {0xE4148D, 0x04283B7F}, {0xE47ED9, 0x04A552EC},
+    {0xE4F8CF, 0x047A5F01}, {0xE5947D, 0x05401C9B}, {0xE648FE, 0x051D3623}, {0xE65D3D, 0x053124B4},
+    {0xE673B9, 0x048053C2}, {0xE6A426, 0x04D0DA9C}, {0xE6A896, 0x0529D8E3}, {0xE75C6A, 0x052448DF},
+    {0xE7D03B, 0x040739C4}, {0xE88955, 0x03CC82BF}, {0xE8FF47, 0x03E0DB7A}, {0xEA0ED0, 0x04FFEECE},
+    {0xEA2129, 0x04D500E7}, {0xEA8867, 0x051EA079}, {0xEB32C0, 0x04DB3496}, {0xEBE910, 0x05422D53},
+    {0xED6091, 0x05079504}, {0xED6838, 0x04D38CA2}, {0xEE1733, 0x041E0F1A}, {0xEE2AE0, 0x054B79EA},
+    {0xEEE733, 0x04F007C8}, {0xEF260F, 0x04470F7F}, {0xEFD1F2, 0x030FB97B}, {0xEFD219, 0x04EA3E7E},
+    {0xF0E274, 0x04135E85}, {0xF0FACA, 0x053274A6}, {0xF1084B, 0x051431E1}, {0xF11895, 0x00787C7E},
+    {0xF1ABF0, 0x054D0AD8}, {0xF257E9, 0x04EB18D8}, {0xF2CD7E, 0x053B8956}, {0xF2DFDE, 0x04C294C9},
+    {0xF2E6FA, 0x02F5E983}, {0xF4021B, 0x031E9E65}, {0xF40943, 0x04AAF149}, {0xF495BF, 0x047D3A35},
+    {0xF4DEAF, 0x04D43DEB}, {0xF55D07, 0x04D91351}, {0xF5F303, 0x03E2D6D6}, {0xF6853C, 0x0515134A},
+    {0xF6EFD9, 0x04E32987}, {0xF7CA60, 0x04CCC8CF}, {0xF7D6F0, 0x03BA4349}, {0xF9D503, 0x04C8E4D3},
+    {0xFA09B3, 0x04765459}, {0xFA44E4, 0x03E5856E}, {0xFA4B98, 0x050EE7F6}, {0xFA58F9, 0x04A3F411},
+    {0xFA6137, 0x04DA2E2D}, {0xFB8F35, 0x04B17F60}, {0xFBAD6F, 0x044BB16F}, {0xFBF326, 0x054EE0A7},
+    {0xFC1994, 0x042D2C3B}, {0xFCF72A, 0x0492734E}, {0xFD351F, 0x04C0DF9A}, {0xFDC073, 0x03536E67},
+    {0xFE3CC3, 0x04937F57}, {0xFE5386, 0x05090BC5}, {0xFEC745, 0x039438F1}, {0xFF1FD1, 0x054E7F28},
 };
 
 /* Secret key table */
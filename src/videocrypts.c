@@ -274,11 +274,7 @@ int vcs_render_line(vid_t *s, void *arg, int nlines, vid_line_t **lines)
 	
 	if(j > 0)
 	{
-		int16_t *dline = lines[j]->output;
-		for(x = s->active_left * 2; x < s->width * 2; x += 2)
-		{
-			l->output[x] = dline[x];
-		}
+		vid_swap_lines(l, lines[j], s->active_left);
 	}
 	
 	/* On the first line of each frame, generate the VBI data */